@@ -0,0 +1,76 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "batch_runner.h"
+#include "emulator.h"
+#include "programs.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr u32 INSTANCES = 256;
+constexpr u64 FRAMES_PER_ITERATION = 60;
+constexpr u32 INSTRUCTIONS_PER_FRAME = 1000;
+
+/// <summary>
+/// Runs a corpus of machines with different programs and seeds, the argument is the number of worker threads
+/// </summary>
+void BM_BatchRunner(benchmark::State& state)
+{
+    BatchRunner runner(static_cast<u32>(state.range(0)));
+
+    for (u32 i = 0; i < INSTANCES; ++i)
+    {
+        Chip8 chip8;
+        chip8.Reset(i);
+        bench::LoadProgram(chip8, i % 2 == 0 ? bench::ALU_LOOP : bench::SPRITE_LOOP);
+        runner.Add(chip8, INSTRUCTIONS_PER_FRAME);
+    }
+
+    for (auto _ : state)
+    {
+        runner.RunFrames(FRAMES_PER_ITERATION);
+    }
+
+    u64 steals = 0;
+
+    for (const WorkerStats& stats : runner.Stats())
+    {
+        steals += stats.steals;
+    }
+
+    state.SetItemsProcessed(state.iterations() * INSTANCES * FRAMES_PER_ITERATION * INSTRUCTIONS_PER_FRAME);
+    state.counters["steals"] = static_cast<double>(steals) / static_cast<double>(state.iterations());
+}
+}  // namespace
+
+BENCHMARK(BM_BatchRunner)
+    ->RangeMultiplier(2)
+    ->Range(1, std::max(1u, std::thread::hardware_concurrency()))
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,74 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include "emulator.h"
+#include "programs.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr int CYCLES_PER_ITERATION = 1000;
+
+void BM_Dispatch(benchmark::State& state, Dispatch dispatch)
+{
+    Chip8 chip8;
+    chip8.dispatch = dispatch;
+    bench::LoadProgram(chip8, bench::ALU_LOOP);
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < CYCLES_PER_ITERATION; ++i)
+        {
+            chip8.Cycle();
+        }
+
+        benchmark::DoNotOptimize(chip8.registers);
+    }
+
+    state.SetItemsProcessed(state.iterations() * CYCLES_PER_ITERATION);
+}
+
+void BM_RunUntil(benchmark::State& state, stop_mask_t stopOn)
+{
+    Chip8 chip8;
+    bench::LoadProgram(chip8, bench::ALU_LOOP);
+
+    for (auto _ : state)
+    {
+        chip8.RunUntil(stopOn, CYCLES_PER_ITERATION);
+
+        benchmark::DoNotOptimize(chip8.registers);
+    }
+
+    state.SetItemsProcessed(state.iterations() * CYCLES_PER_ITERATION);
+}
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_Dispatch, Table, Dispatch::Table);
+BENCHMARK_CAPTURE(BM_Dispatch, Switch, Dispatch::Switch);
+BENCHMARK_CAPTURE(BM_Dispatch, Cached, Dispatch::Cached);
+BENCHMARK_CAPTURE(BM_Dispatch, Specialized, Dispatch::Specialized);
+BENCHMARK_CAPTURE(BM_RunUntil, Budget, 0);
+BENCHMARK_CAPTURE(BM_RunUntil, Events, static_cast<stop_mask_t>(~StopOn(StopReason::Breakpoint)));
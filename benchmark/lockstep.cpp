@@ -0,0 +1,98 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "emulator.h"
+#include "lockstep.h"
+#include "programs.h"
+#include "scheduler.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr u32 LANES = Lockstep<>::LANES;
+constexpr u32 INSTRUCTIONS_PER_FRAME = 1000;
+
+/// Every lane runs the same program on different data, as when fuzzing or training on one ROM
+Chip8 Lane(u32 lane, const bench::program_t& program)
+{
+    Chip8 chip8;
+    chip8.Reset(lane);
+    chip8.registers[0x3] = static_cast<u8>(lane * 17);
+    chip8.registers[0x4] = static_cast<u8>(lane * 5);
+    bench::LoadProgram(chip8, program);
+    return chip8;
+}
+
+void BM_Lockstep(benchmark::State& state, const bench::program_t& program)
+{
+    Lockstep<> lockstep;
+
+    for (u32 lane = 0; lane < LANES; ++lane)
+    {
+        lockstep.Load(lane, Lane(lane, program));
+    }
+
+    for (auto _ : state)
+    {
+        lockstep.RunFrame(INSTRUCTIONS_PER_FRAME);
+    }
+
+    state.SetItemsProcessed(state.iterations() * LANES * INSTRUCTIONS_PER_FRAME);
+    state.counters["utilization"] = static_cast<double>(lockstep.stats.laneInstructions) /
+                                    static_cast<double>(lockstep.stats.steps * LANES);
+}
+
+/// The same lanes, each run by its own scheduler one after another
+void BM_LockstepScalar(benchmark::State& state, const bench::program_t& program)
+{
+    std::vector<Chip8> machines;
+    std::vector<Scheduler> schedulers;
+    machines.reserve(LANES);
+
+    for (u32 lane = 0; lane < LANES; ++lane)
+    {
+        machines.push_back(Lane(lane, program));
+        schedulers.emplace_back(machines.back(), INSTRUCTIONS_PER_FRAME);
+        schedulers.back().fastForward = false;
+    }
+
+    for (auto _ : state)
+    {
+        for (Scheduler& scheduler : schedulers)
+        {
+            scheduler.RunFrame();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * LANES * INSTRUCTIONS_PER_FRAME);
+}
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_Lockstep, AluLoop, bench::ALU_LOOP);
+BENCHMARK_CAPTURE(BM_LockstepScalar, AluLoop, bench::ALU_LOOP);
+BENCHMARK_CAPTURE(BM_Lockstep, SpriteLoop, bench::SPRITE_LOOP);
+BENCHMARK_CAPTURE(BM_LockstepScalar, SpriteLoop, bench::SPRITE_LOOP);
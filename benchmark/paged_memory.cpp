@@ -0,0 +1,106 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include "emulator.h"
+#include "paged_memory.h"
+#include "programs.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr u32 INSTRUCTIONS = 12;
+
+Chip8 Start()
+{
+    Chip8 chip8;
+    bench::LoadProgram(chip8, bench::SPRITE_LOOP);
+    chip8.Run(100);
+    return chip8;
+}
+
+void BM_ForkSnapshot(benchmark::State& state)
+{
+    const MachineState start = Start().Snapshot();
+
+    for (auto _ : state)
+    {
+        MachineState fork = start;
+        benchmark::DoNotOptimize(fork);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes"] = sizeof(MachineState);
+}
+
+void BM_ForkPaged(benchmark::State& state)
+{
+    const PagedMachine start(Start());
+
+    for (auto _ : state)
+    {
+        PagedMachine fork = start;
+        benchmark::DoNotOptimize(fork);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes"] = sizeof(PagedMachine);
+}
+
+/// Running a parked machine for a frame's worth of instructions, the cost of keeping it paged
+void BM_PagedSlice(benchmark::State& state)
+{
+    PagedMachine machine(Start());
+    Chip8 worker;
+
+    for (auto _ : state)
+    {
+        machine.LoadInto(worker);
+        worker.Run(INSTRUCTIONS);
+        machine.SaveFrom(worker);
+    }
+
+    state.SetItemsProcessed(state.iterations() * INSTRUCTIONS);
+}
+
+void BM_SnapshotSlice(benchmark::State& state)
+{
+    MachineState machine = Start().Snapshot();
+    Chip8 worker;
+
+    for (auto _ : state)
+    {
+        worker.Restore(machine);
+        worker.Run(INSTRUCTIONS);
+        machine = worker.Snapshot();
+    }
+
+    state.SetItemsProcessed(state.iterations() * INSTRUCTIONS);
+}
+}  // namespace
+
+BENCHMARK(BM_ForkSnapshot);
+BENCHMARK(BM_ForkPaged);
+BENCHMARK(BM_PagedSlice);
+BENCHMARK(BM_SnapshotSlice);
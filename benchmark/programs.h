@@ -0,0 +1,72 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "emulator.h"
+#include "program.h"
+
+namespace chip8::bench
+{
+using chip8::LoadProgram;
+using chip8::program_t;
+
+/// Arithmetic heavy loop without any drawing, so the run time is dominated by decode and dispatch. Also available
+/// as alu_loop.rom.
+const program_t ALU_LOOP = {
+    0x6000,  // 200: LD V0, 0
+    0x6105,  // 202: LD V1, 5
+    0x7001,  // 204: ADD V0, 1
+    0x8014,  // 206: ADD V0, V1
+    0x8205,  // 208: SUB V2, V0
+    0x8316,  // 20A: SHR V3
+    0x8402,  // 20C: AND V4, V0
+    0x8531,  // 20E: OR V5, V3
+    0xA300,  // 210: LD I, 300
+    0xF01E,  // 212: ADD I, V0
+    0x3000,  // 214: SE V0, 0
+    0x1204,  // 216: JP 204
+    0x1200,  // 218: JP 200
+};
+
+/// <summary>
+/// Shaped like the main loop of a typical game: a row of sprites drawn in a counted loop, followed by a wait on the
+/// delay timer. Exercises the sequences ir::Fuse turns into superinstructions.
+/// </summary>
+const program_t SPRITE_LOOP = {
+    0x6A00,  // 200: LD VA, 0
+    0x6C00,  // 202: LD VC, 0
+    0xA050,  // 204: LD I, 050
+    0xDAB5,  // 206: DRW VA, VB, 5
+    0x7A05,  // 208: ADD VA, 5
+    0x7C01,  // 20A: ADD VC, 1
+    0x3C0C,  // 20C: SE VC, 0C
+    0x1204,  // 20E: JP 204
+    0x6002,  // 210: LD V0, 2
+    0xF015,  // 212: LD DT, V0
+    0xF007,  // 214: LD V0, DT
+    0x3000,  // 216: SE V0, 0
+    0x1214,  // 218: JP 214
+    0x7B01,  // 21A: ADD VB, 1
+    0x1200,  // 21C: JP 200
+};
+}  // namespace chip8::bench
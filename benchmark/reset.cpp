@@ -0,0 +1,92 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+#include "emulator.h"
+#include "programs.h"
+
+using namespace chip8;
+
+namespace
+{
+void BM_Construct(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        Chip8 chip8;
+        benchmark::DoNotOptimize(chip8.memory);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Reset(benchmark::State& state)
+{
+    Chip8 chip8;
+
+    for (auto _ : state)
+    {
+        chip8.Reset(1);
+        benchmark::DoNotOptimize(chip8.memory);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Snapshot(benchmark::State& state)
+{
+    Chip8 chip8;
+    bench::LoadProgram(chip8, bench::SPRITE_LOOP);
+    chip8.Run(1000);
+
+    for (auto _ : state)
+    {
+        MachineState snapshot = chip8.Snapshot();
+        benchmark::DoNotOptimize(snapshot);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<i64>(sizeof(MachineState)));
+}
+
+void BM_Restore(benchmark::State& state)
+{
+    Chip8 chip8;
+    bench::LoadProgram(chip8, bench::SPRITE_LOOP);
+    chip8.Run(1000);
+    const MachineState snapshot = chip8.Snapshot();
+
+    for (auto _ : state)
+    {
+        chip8.Restore(snapshot);
+        benchmark::DoNotOptimize(chip8.memory);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<i64>(sizeof(MachineState)));
+}
+}  // namespace
+
+BENCHMARK(BM_Construct);
+BENCHMARK(BM_Reset);
+BENCHMARK(BM_Snapshot);
+BENCHMARK(BM_Restore);
@@ -0,0 +1,100 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "emulator.h"
+#include "programs.h"
+#include "rewind.h"
+#include "scheduler.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr u32 FRAMES = 60 * 60;
+
+/// A minute of frames of a program that draws every frame
+std::vector<MachineState> Minute()
+{
+    Chip8 chip8;
+    bench::LoadProgram(chip8, bench::SPRITE_LOOP);
+    Scheduler scheduler(chip8);
+
+    std::vector<MachineState> frames;
+    for (u32 i = 0; i < FRAMES; ++i)
+    {
+        scheduler.RunFrame();
+        frames.push_back(chip8.Snapshot());
+    }
+    return frames;
+}
+
+void BM_RewindRecord(benchmark::State& state)
+{
+    const std::vector<MachineState> frames = Minute();
+    Rewind rewind;
+
+    for (auto _ : state)
+    {
+        rewind.Clear();
+        for (const MachineState& frame : frames)
+        {
+            rewind.Record(frame);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * FRAMES);
+    state.counters["bytes/frame"] = static_cast<double>(rewind.Used()) / static_cast<double>(rewind.Frames());
+    state.counters["frames"] = static_cast<double>(rewind.Frames());
+}
+
+void BM_RewindStepBack(benchmark::State& state)
+{
+    const std::vector<MachineState> frames = Minute();
+    Rewind rewind;
+    MachineState current;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        rewind.Clear();
+        for (const MachineState& frame : frames)
+        {
+            rewind.Record(frame);
+        }
+        state.ResumeTiming();
+
+        while (rewind.StepBack(current))
+        {
+        }
+        benchmark::DoNotOptimize(current);
+    }
+
+    state.SetItemsProcessed(state.iterations() * (FRAMES - 1));
+}
+}  // namespace
+
+BENCHMARK(BM_RewindRecord);
+BENCHMARK(BM_RewindStepBack);
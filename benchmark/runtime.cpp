@@ -0,0 +1,111 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <vector>
+
+#include "emulator.h"
+#include "programs.h"
+#include "runtime.h"
+#include "scheduler.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr u32 INSTANCES = 10000;
+
+/// Some work per frame, then waiting five frames for the delay timer as games pace themselves
+const bench::program_t VSYNC_LOOP = {
+    0x6005,  // LD V0, 0x05
+    0xF015,  // LD DT, V0
+    0x7101,  // ADD V1, 0x01
+    0xF307,  // LD V3, DT
+    0x3300,  // SE V3, 0x00
+    0x1206,  // JP 0x206
+    0x1200,  // JP 0x200
+};
+
+/// Waiting for a key that never comes, as on a title screen
+const bench::program_t KEY_WAIT = {
+    0xF00A,  // LD V0, K
+    0x1200,  // JP 0x200
+};
+
+/// Frames of every instance run as tasks of one runtime
+void BM_Runtime(benchmark::State& state, const bench::program_t& program)
+{
+    Runtime runtime;
+    std::deque<Emulator> emulators;
+
+    for (u32 i = 0; i < INSTANCES; ++i)
+    {
+        Chip8 chip8;
+        bench::LoadProgram(chip8, program);
+        runtime.Spawn(emulators.emplace_back(runtime, chip8).Run());
+    }
+    runtime.RunFrame();
+
+    const u64 resumes = runtime.resumes;
+    for (auto _ : state)
+    {
+        runtime.RunFrame();
+    }
+
+    state.SetItemsProcessed(state.iterations() * INSTANCES);
+    state.counters["resumes/frame"] =
+        static_cast<double>(runtime.resumes - resumes) / static_cast<double>(state.iterations());
+}
+
+/// Frames of every instance run one scheduler after another, the cost the runtime adds to
+void BM_RuntimeBaseline(benchmark::State& state, const bench::program_t& program)
+{
+    std::vector<Chip8> machines(INSTANCES);
+    std::vector<Scheduler> schedulers;
+    schedulers.reserve(INSTANCES);
+
+    for (Chip8& chip8 : machines)
+    {
+        bench::LoadProgram(chip8, program);
+        schedulers.emplace_back(chip8);
+    }
+
+    for (auto _ : state)
+    {
+        for (Scheduler& scheduler : schedulers)
+        {
+            scheduler.RunFrame();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * INSTANCES);
+}
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_Runtime, AluLoop, bench::ALU_LOOP);
+BENCHMARK_CAPTURE(BM_RuntimeBaseline, AluLoop, bench::ALU_LOOP);
+BENCHMARK_CAPTURE(BM_Runtime, VsyncLoop, VSYNC_LOOP);
+BENCHMARK_CAPTURE(BM_RuntimeBaseline, VsyncLoop, VSYNC_LOOP);
+BENCHMARK_CAPTURE(BM_Runtime, KeyWait, KEY_WAIT);
+BENCHMARK_CAPTURE(BM_RuntimeBaseline, KeyWait, KEY_WAIT);
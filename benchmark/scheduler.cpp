@@ -0,0 +1,76 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+#include "emulator.h"
+#include "programs.h"
+#include "scheduler.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr int FRAMES_PER_ITERATION = 60;
+
+void BM_Scheduler(benchmark::State& state)
+{
+    Chip8 chip8;
+    bench::LoadProgram(chip8, bench::ALU_LOOP);
+
+    Scheduler scheduler(chip8, static_cast<u32>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        scheduler.RunFrames(FRAMES_PER_ITERATION);
+
+        benchmark::DoNotOptimize(chip8.registers);
+    }
+
+    state.SetItemsProcessed(state.iterations() * FRAMES_PER_ITERATION * state.range(0));
+}
+
+void BM_SchedulerIdle(benchmark::State& state)
+{
+    // F307: LD V3, DT
+    // 3302: SE V3, 0x02
+    // 1200: JP 0x200
+    Chip8 chip8;
+    bench::LoadProgram(chip8, {0xF307, 0x3302, 0x1200});
+
+    Scheduler scheduler(chip8, 1000);
+    scheduler.fastForward = state.range(0) != 0;
+
+    for (auto _ : state)
+    {
+        chip8.pc = Chip8::START_ADDRESS;
+        chip8.delayTimer = FRAMES_PER_ITERATION + 2;
+        scheduler.RunFrames(FRAMES_PER_ITERATION);
+
+        benchmark::DoNotOptimize(chip8.registers);
+    }
+
+    state.SetItemsProcessed(state.iterations() * FRAMES_PER_ITERATION);
+}
+}  // namespace
+
+BENCHMARK(BM_Scheduler)->Arg(12)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_SchedulerIdle)->Arg(0)->Arg(1);
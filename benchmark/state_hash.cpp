@@ -0,0 +1,68 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include "emulator.h"
+#include "programs.h"
+#include "scheduler.h"
+#include "state_hash.h"
+
+using namespace chip8;
+
+namespace
+{
+enum class Hashing
+{
+    None,
+    Incremental,
+    Full,
+};
+
+/// A frame of a program that draws every frame, followed by hashing the state as a search would
+void BM_StateHash(benchmark::State& state, Hashing hashing)
+{
+    Chip8 chip8;
+    bench::LoadProgram(chip8, bench::SPRITE_LOOP);
+    Scheduler scheduler(chip8);
+
+    for (auto _ : state)
+    {
+        scheduler.RunFrame();
+
+        if (hashing == Hashing::Incremental)
+        {
+            benchmark::DoNotOptimize(chip8.StateHash());
+        }
+        else if (hashing == Hashing::Full)
+        {
+            benchmark::DoNotOptimize(HashState(chip8));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_StateHash, None, Hashing::None);
+BENCHMARK_CAPTURE(BM_StateHash, Incremental, Hashing::Incremental);
+BENCHMARK_CAPTURE(BM_StateHash, Full, Hashing::Full);
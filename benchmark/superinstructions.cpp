@@ -0,0 +1,84 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <string>
+
+#include "block_cache.h"
+#include "emulator.h"
+#include "programs.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr int INSTRUCTIONS_PER_ITERATION = 1000;
+
+/// <summary>
+/// Runs the block cache with superinstructions off (argument 0) and on (argument 1). Besides the instructions per
+/// second it reports how many handlers were dispatched per guest instruction.
+/// </summary>
+void RunSuperinstructions(benchmark::State& state, Chip8 chip8)
+{
+    BlockCache cache(chip8);
+    cache.superinstructions = state.range(0) != 0;
+
+    u64 executed = 0;
+
+    for (auto _ : state)
+    {
+        executed += cache.Run(INSTRUCTIONS_PER_ITERATION);
+
+        benchmark::DoNotOptimize(chip8.registers);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(executed));
+    state.counters["dispatches_per_instruction"] =
+        executed == 0 ? 0.0 : static_cast<double>(cache.dispatches) / static_cast<double>(executed);
+}
+
+void BM_Superinstructions(benchmark::State& state)
+{
+    Chip8 chip8;
+    bench::LoadProgram(chip8, bench::SPRITE_LOOP);
+    RunSuperinstructions(state, chip8);
+}
+
+/// Set CHIP8_BENCH_ROM to the path of a ROM to measure it as well
+const bool romRegistered = [] {
+    const char* rom = std::getenv("CHIP8_BENCH_ROM");
+
+    if (rom != nullptr)
+    {
+        benchmark::RegisterBenchmark("BM_Superinstructions/rom", [path = std::string(rom)](benchmark::State& state) {
+            Chip8 chip8;
+            chip8.LoadRom(path);
+            RunSuperinstructions(state, chip8);
+        })->Arg(0)->Arg(1);
+    }
+
+    return rom != nullptr;
+}();
+}  // namespace
+
+BENCHMARK(BM_Superinstructions)->Arg(0)->Arg(1);
@@ -0,0 +1,123 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <benchmark/benchmark.h>
+#include "emulator.h"
+#include "instructions.h"
+#include "video.h"
+
+using namespace chip8;
+
+namespace
+{
+/// Draw with the bitplanes given by the argument selected
+void BM_DrawSprite(benchmark::State& state)
+{
+    Chip8 chip8;
+    chip8.planes = static_cast<u8>(state.range(0));
+    chip8.index = Chip8::FONTSET_START_ADDRESS;
+    u8 position = 0;
+
+    for (auto _ : state)
+    {
+        chip8.registers[0x0] = position;
+        chip8.registers[0x1] = position / 2;
+        ops::OP_Dxyn(chip8, 0x0, 0x1, 15);
+        position += 3;
+
+        benchmark::DoNotOptimize(chip8.video);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DrawLargeSprite(benchmark::State& state)
+{
+    Chip8 chip8;
+    chip8.hires = true;
+    chip8.index = Chip8::BIG_FONTSET_START_ADDRESS;
+    u8 position = 0;
+
+    for (auto _ : state)
+    {
+        chip8.registers[0x0] = position;
+        chip8.registers[0x1] = position / 2;
+        ops::OP_Dxyn(chip8, 0x0, 0x1, 0);
+        position += 3;
+
+        benchmark::DoNotOptimize(chip8.hiresVideo);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// One scroll in every direction of the SUPER-CHIP, in the resolution given by the argument
+void BM_Scroll(benchmark::State& state)
+{
+    Chip8 chip8;
+    chip8.hires = state.range(0) != 0;
+
+    for (u32 i = 0; i < chip8.hiresVideo.size(); ++i)
+    {
+        chip8.hiresVideo[i] = 0x0123456789ABCDEFu * (i + 1);
+        chip8.video[i % VIDEO_HEIGHT] = chip8.hiresVideo[i];
+    }
+
+    for (auto _ : state)
+    {
+        ops::OP_00FB(chip8);
+        ops::OP_00Cn(chip8, 1);
+        ops::OP_00FC(chip8);
+
+        benchmark::DoNotOptimize(chip8.video);
+        benchmark::DoNotOptimize(chip8.hiresVideo);
+    }
+
+    state.SetItemsProcessed(state.iterations() * 3);
+}
+
+void BM_ExpandToRgba(benchmark::State& state)
+{
+    video_mem_t video{};
+
+    for (u32 y = 0; y < VIDEO_HEIGHT; ++y)
+    {
+        video[y] = 0x0123456789ABCDEFu * (y + 1);
+    }
+
+    rgba_buffer_t rgba{};
+
+    for (auto _ : state)
+    {
+        ExpandToRgba(video, rgba.data());
+
+        benchmark::DoNotOptimize(rgba);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+}  // namespace
+
+BENCHMARK(BM_DrawSprite)->Arg(1)->Arg(3);
+BENCHMARK(BM_DrawLargeSprite);
+BENCHMARK(BM_Scroll)->Arg(0)->Arg(1);
+BENCHMARK(BM_ExpandToRgba);
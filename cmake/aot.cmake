@@ -0,0 +1,13 @@
+# Translate a ROM with chip8_aot and compile the result into the target. The program is available as
+# chip8::aot::<name>.
+function(chip8_translate_rom target name rom)
+  set(output "${CMAKE_CURRENT_BINARY_DIR}/aot/${name}.cpp")
+  add_custom_command(
+    OUTPUT ${output}
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${CMAKE_CURRENT_BINARY_DIR}/aot"
+    COMMAND chip8_aot ${rom} ${name} ${output}
+    DEPENDS chip8_aot ${rom}
+    COMMENT "Translating ${rom}"
+    VERBATIM)
+  target_sources(${target} PRIVATE ${output})
+endfunction()
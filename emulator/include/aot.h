@@ -0,0 +1,109 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "emulator.h"
+
+namespace chip8::aot
+{
+/// <summary>
+/// A ROM translated ahead of time into C++ by chip8_aot
+/// </summary>
+struct Program
+{
+    const char* name;
+
+    /// Executes translated code starting at the program counter until the budget is used up, the program counter
+    /// leaves the translated code or enters a block that is marked in modified, Fx0A waits for a key or memory inside
+    /// the translated code is written. modified is nullptr while no block is modified.
+    u64 (*run)(Chip8& chip8, u64 budget, const u8* modified);
+
+    /// ROM image the translation was made from, loaded at Chip8::START_ADDRESS
+    const u8* image;
+    u32 imageSize;
+
+    /// Range of memory covered by translated instructions, which may contain data between them
+    u16 codeBegin;
+    u16 codeEnd;
+
+    /// Memory ranges of the translated blocks, runs of consecutive instructions that are only entered through their
+    /// first instruction or the dispatcher. Bytes between blocks aren't translated.
+    const u16* blockBegin;
+    const u16* blockEnd;
+    u32 blockCount;
+};
+
+/// <summary>
+/// Runs a Chip8 with a translated program, falling back to the interpreter wherever the translation can't be used.
+/// Blocks whose instructions were overwritten run in the interpreter until their bytes match the image again, writes
+/// to data between the blocks don't affect the translation.
+/// </summary>
+class Runner
+{
+public:
+    Runner(const Program& program, Chip8& chip8);
+
+    /// <summary>
+    /// Execute at least the given number of instructions
+    /// </summary>
+    /// <returns> Number of executed instructions</returns>
+    u64 Run(u64 instructions);
+
+    /// <summary>
+    /// False while the program has modified any of its translated instructions
+    /// </summary>
+    bool Translated() const { return modifiedBlocks == 0; }
+
+    /// <summary>
+    /// Whether the instruction at the address belongs to a translated block that can still be used
+    /// </summary>
+    bool Translated(u16 address) const;
+
+    /// Number of instructions executed by the interpreter so far
+    u64 interpreted{};
+
+private:
+    /// Compare the blocks that overlap the memory range with the image again
+    void Check(u32 address, u32 size);
+
+    const Program& program;
+    Chip8& chip8;
+
+    /// Whether the memory of each block differs from the image, passed to Program::run
+    std::vector<u8> modified;
+    u32 modifiedBlocks{};
+};
+
+/// <summary>
+/// Translate every instruction of a ROM that is reachable from the start address into a C++ translation unit
+/// defining the Program chip8::aot::[name]
+/// </summary>
+/// <param name="memory"> Memory with the ROM loaded by Chip8::LoadRom</param>
+/// <param name="romSize"> Size of the ROM in bytes</param>
+/// <param name="name"> Name of the program, has to be a valid C++ identifier</param>
+std::string Translate(const memory_t& memory, u32 romSize, std::string_view name);
+}  // namespace chip8::aot
@@ -0,0 +1,137 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "emulator.h"
+#include "scheduler.h"
+
+namespace chip8
+{
+/// <summary>
+/// What one worker thread of a BatchRunner did
+/// </summary>
+struct WorkerStats
+{
+    /// Chunks of frames executed
+    u64 tasks{};
+    /// Chunks taken from the queue of another worker
+    u64 steals{};
+    u64 frames{};
+    u64 instructions{};
+    /// Time spent executing chunks
+    std::chrono::nanoseconds busy{};
+};
+
+/// <summary>
+/// Runs many independent machines on a work-stealing thread pool. Each machine is stepped by its own Scheduler in
+/// chunks of frames, and only one worker steps a machine at a time, so the results don't depend on the number of
+/// threads or on which worker ran which chunk.
+/// </summary>
+class BatchRunner
+{
+public:
+    /// One second of emulated time, long enough to make the queue operations negligible
+    constexpr static u64 DEFAULT_FRAMES_PER_TASK = 60;
+
+    /// <param name="threads"> Number of worker threads, zero for one per hardware thread</param>
+    explicit BatchRunner(u32 threads = 0);
+
+    BatchRunner(const BatchRunner&) = delete;
+    BatchRunner& operator=(const BatchRunner&) = delete;
+
+    ~BatchRunner();
+
+    /// <summary>
+    /// Add a copy of a machine, which is switched to Timing::Frame
+    /// </summary>
+    /// <returns> Index of the machine</returns>
+    u32 Add(const Chip8& chip8, u32 instructionsPerFrame = Scheduler::DEFAULT_INSTRUCTIONS_PER_FRAME);
+
+    Chip8& Machine(u32 index) { return instances[index]->chip8; }
+    const Chip8& Machine(u32 index) const { return instances[index]->chip8; }
+
+    u32 Size() const { return static_cast<u32>(instances.size()); }
+
+    u32 Threads() const { return static_cast<u32>(workers.size()); }
+
+    /// <summary>
+    /// Run every machine for the given number of frames and wait until all of them are done
+    /// </summary>
+    void RunFrames(u64 frames);
+
+    /// <summary>
+    /// Statistics of every worker since the runner was created or ResetStats was called
+    /// </summary>
+    std::vector<WorkerStats> Stats() const;
+
+    void ResetStats();
+
+    /// Number of frames a worker runs a machine for before it takes the next task
+    u64 framesPerTask{DEFAULT_FRAMES_PER_TASK};
+
+private:
+    struct Instance
+    {
+        Instance(const Chip8& machine, u32 instructionsPerFrame) :
+            chip8(machine), scheduler(chip8, instructionsPerFrame)
+        {
+        }
+
+        Chip8 chip8;
+        Scheduler scheduler;
+        /// Frames left of the current RunFrames call
+        u64 remaining{};
+    };
+
+    /// Own cache line, so the workers don't slow each other down through their statistics
+    struct alignas(64) Worker
+    {
+        std::thread thread;
+        std::mutex mutex;
+        /// Indices of the instances to run. The owner works at the back, thieves take from the front.
+        std::deque<u32> tasks;
+        WorkerStats stats;
+    };
+
+    void Work(u32 index);
+
+    bool Pop(u32 index, u32& task, bool& stolen);
+
+    std::vector<std::unique_ptr<Instance>> instances;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /// Incremented by every RunFrames call to wake the workers, which wait on it
+    std::atomic<u64> generation{};
+    std::atomic<bool> stop{};
+    /// Instances that still have frames left, RunFrames waits on it
+    std::atomic<u32> pending{};
+};
+}  // namespace chip8
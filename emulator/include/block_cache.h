@@ -0,0 +1,89 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "emulator.h"
+#include "ir.h"
+
+namespace chip8
+{
+#ifdef CHIP8_SUPERINSTRUCTIONS
+constexpr bool DEFAULT_SUPERINSTRUCTIONS = true;
+#else
+constexpr bool DEFAULT_SUPERINSTRUCTIONS = false;
+#endif
+
+/// <summary>
+/// Interpreter that caches optimised IR blocks (see ir.h) by their start address and executes them a whole block at a
+/// time. The portable counterpart of the Jit, with the same interface; the state only matches Chip8::Cycle at block
+/// boundaries.
+/// </summary>
+class BlockCache
+{
+public:
+    explicit BlockCache(Chip8& chip8);
+
+    /// <summary>
+    /// Execute the block starting at the program counter
+    /// </summary>
+    /// <returns> Number of executed instructions</returns>
+    u32 Step();
+
+    /// <summary>
+    /// Execute at least the given number of instructions
+    /// </summary>
+    /// <returns> Number of executed instructions</returns>
+    u64 Run(u64 instructions);
+
+    /// <summary>
+    /// Drop every block that decoded code from the given memory range. Has to be called after writing to memory from
+    /// outside of the instruction handlers.
+    /// </summary>
+    /// <param name="address"> First address that was written</param>
+    /// <param name="size"> Number of bytes that were written</param>
+    void Invalidate(u32 address, u32 size);
+
+    /// <summary>
+    /// Drop every block, for example after loading a new ROM
+    /// </summary>
+    void InvalidateAll();
+
+    /// Upper bound for the number of instructions in one block
+    constexpr static u32 MAX_BLOCK_INSTRUCTIONS = 64;
+
+    /// Fuse common instruction sequences into superinstructions (see ir::Fuse). Only affects blocks built afterwards.
+    bool superinstructions{DEFAULT_SUPERINSTRUCTIONS};
+
+    /// Number of handlers executed so far, where a superinstruction counts once
+    u64 dispatches{};
+
+private:
+    Chip8& chip8;
+
+    /// Optimised block for every start address, nullptr if there is none yet
+    std::vector<std::unique_ptr<ir::Block>> blocks;
+};
+}  // namespace chip8
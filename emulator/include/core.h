@@ -0,0 +1,355 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "decode.h"
+#include "emulator.h"
+#include "instructions.h"
+#include "quirks.h"
+
+namespace chip8
+{
+/// <summary>
+/// Instructions that change what the display shows
+/// </summary>
+constexpr bool ChangesDisplay(Op op)
+{
+    switch (op)
+    {
+        case Op::OP_00E0:
+        case Op::OP_Dxyn:
+        case Op::OP_00Cn:
+        case Op::OP_00FB:
+        case Op::OP_00FC:
+        case Op::OP_00FE:
+        case Op::OP_00FF:
+        case Op::OP_00Dn:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// <summary>
+/// Switch engine specialised for a quirk policy (see quirks.h). Chip8 selects the instantiation from its variant, so
+/// none of the quirks cost a runtime check.
+/// </summary>
+template <typename Quirks>
+struct Core
+{
+    /// <summary>
+    /// Execute a single decoded instruction. The flag-free and fused instructions only come out of the IR, which
+    /// assumes quirks::Legacy, so they aren't specialised.
+    /// </summary>
+    /// <param name="c"> Machine to execute on, with the program counter already behind the instruction</param>
+    /// <param name="instruction"> Instruction taken from DECODE_TABLE</param>
+    static void Execute(Chip8& c, Instruction instruction);
+
+    /// <summary>
+    /// Fetch, decode and execute one instruction and tick the timers, unless they are ticked per frame
+    /// </summary>
+    static void Cycle(Chip8& c)
+    {
+        const u16 opcode = (c.memory[c.pc] << 8u) | c.memory[c.pc + 1];
+
+        // Increment the PC before we execute anything
+        c.pc += 2;
+
+        Execute(c, DECODE_TABLE[opcode]);
+
+        if (c.timing == Timing::PerInstruction)
+        {
+            c.TickTimers();
+        }
+    }
+
+    /// <summary>
+    /// Execute the given number of cycles
+    /// </summary>
+    static void Run(Chip8& c, u64 cycles) { RunUntil(c, 0, cycles); }
+
+    /// <summary>
+    /// Execute until one of the selected events happens or the budget is used up, see Chip8::RunUntil
+    /// </summary>
+    static RunResult RunUntil(Chip8& c, stop_mask_t stopOn, u64 budget)
+    {
+        // Plain runs get a loop without any of the stop checks
+        if (c.timing == Timing::PerInstruction)
+        {
+            return stopOn != 0 ? RunUntil<true, true>(c, stopOn, budget) : RunUntil<true, false>(c, stopOn, budget);
+        }
+
+        return stopOn != 0 ? RunUntil<false, true>(c, stopOn, budget) : RunUntil<false, false>(c, stopOn, budget);
+    }
+
+private:
+    template <bool TICK_TIMERS, bool STOPS>
+    static RunResult RunUntil(Chip8& c, stop_mask_t stopOn, u64 budget)
+    {
+        const bool soundOn = c.soundTimer > 0;
+
+        for (u64 executed = 0; executed < budget; ++executed)
+        {
+            const u16 pc = c.pc;
+
+            if (STOPS && (stopOn & StopOn(StopReason::Breakpoint)) && executed > 0 && c.breakpoints[pc])
+            {
+                return {StopReason::Breakpoint, executed};
+            }
+
+            const Instruction instruction = DECODE_TABLE[(c.memory[pc] << 8u) | c.memory[pc + 1]];
+
+            // Increment the PC before we execute anything
+            c.pc = pc + 2;
+
+            Execute(c, instruction);
+
+            if constexpr (TICK_TIMERS)
+            {
+                c.TickTimers();
+            }
+
+            if constexpr (!STOPS)
+            {
+                continue;
+            }
+
+            if ((stopOn & StopOn(StopReason::Draw)) && ChangesDisplay(instruction.op))
+            {
+                return {StopReason::Draw, executed + 1};
+            }
+
+            if ((stopOn & StopOn(StopReason::Sound)) && (c.soundTimer > 0) != soundOn)
+            {
+                return {StopReason::Sound, executed + 1};
+            }
+
+            if ((stopOn & StopOn(StopReason::KeyWait)) && instruction.op == Op::OP_Fx0A && c.pc == pc)
+            {
+                return {StopReason::KeyWait, executed + 1};
+            }
+        }
+
+        return {StopReason::Budget, budget};
+    }
+};
+
+template <typename Quirks>
+void Core<Quirks>::Execute(Chip8& c, Instruction instruction)
+{
+    const auto [op, x, y, n, kk, nnn] = instruction;
+
+    switch (op)
+    {
+        case Op::OP_NOP:
+        case Op::OP_UNDECODED:
+            break;
+        case Op::OP_00E0:
+            ops::OP_00E0(c);
+            break;
+        case Op::OP_00EE:
+            ops::OP_00EE(c);
+            break;
+        case Op::OP_1nnn:
+            ops::OP_1nnn(c, nnn);
+            break;
+        case Op::OP_2nnn:
+            ops::OP_2nnn(c, nnn);
+            break;
+        case Op::OP_3xkk:
+            ops::OP_3xkk<Quirks>(c, x, kk);
+            break;
+        case Op::OP_4xkk:
+            ops::OP_4xkk<Quirks>(c, x, kk);
+            break;
+        case Op::OP_5xy0:
+            ops::OP_5xy0<Quirks>(c, x, y);
+            break;
+        case Op::OP_6xkk:
+            ops::OP_6xkk(c, x, kk);
+            break;
+        case Op::OP_7xkk:
+            ops::OP_7xkk(c, x, kk);
+            break;
+        case Op::OP_8xy0:
+            ops::OP_8xy0(c, x, y);
+            break;
+        case Op::OP_8xy1:
+            ops::OP_8xy1<Quirks>(c, x, y);
+            break;
+        case Op::OP_8xy2:
+            ops::OP_8xy2<Quirks>(c, x, y);
+            break;
+        case Op::OP_8xy3:
+            ops::OP_8xy3<Quirks>(c, x, y);
+            break;
+        case Op::OP_8xy4:
+            ops::OP_8xy4(c, x, y);
+            break;
+        case Op::OP_8xy5:
+            ops::OP_8xy5(c, x, y);
+            break;
+        case Op::OP_8xy6:
+            ops::OP_8xy6<Quirks>(c, x, y);
+            break;
+        case Op::OP_8xy7:
+            ops::OP_8xy7(c, x, y);
+            break;
+        case Op::OP_8xyE:
+            ops::OP_8xyE<Quirks>(c, x, y);
+            break;
+        case Op::OP_9xy0:
+            ops::OP_9xy0<Quirks>(c, x, y);
+            break;
+        case Op::OP_Annn:
+            ops::OP_Annn(c, nnn);
+            break;
+        case Op::OP_Bnnn:
+            ops::OP_Bnnn<Quirks>(c, nnn);
+            break;
+        case Op::OP_Cxkk:
+            ops::OP_Cxkk(c, x, kk);
+            break;
+        case Op::OP_Dxyn:
+            ops::OP_Dxyn<Quirks>(c, x, y, n);
+            break;
+        case Op::OP_Ex9E:
+            ops::OP_Ex9E<Quirks>(c, x);
+            break;
+        case Op::OP_ExA1:
+            ops::OP_ExA1<Quirks>(c, x);
+            break;
+        case Op::OP_Fx07:
+            ops::OP_Fx07(c, x);
+            break;
+        case Op::OP_Fx0A:
+            ops::OP_Fx0A(c, x);
+            break;
+        case Op::OP_Fx15:
+            ops::OP_Fx15(c, x);
+            break;
+        case Op::OP_Fx18:
+            ops::OP_Fx18(c, x);
+            break;
+        case Op::OP_Fx1E:
+            ops::OP_Fx1E(c, x);
+            break;
+        case Op::OP_Fx29:
+            ops::OP_Fx29(c, x);
+            break;
+        case Op::OP_Fx33:
+            ops::OP_Fx33(c, x);
+            break;
+        case Op::OP_Fx55:
+            ops::OP_Fx55<Quirks>(c, x);
+            break;
+        case Op::OP_Fx65:
+            ops::OP_Fx65<Quirks>(c, x);
+            break;
+        case Op::OP_00Cn:
+            ops::OP_00Cn(c, n);
+            break;
+        case Op::OP_00FB:
+            ops::OP_00FB(c);
+            break;
+        case Op::OP_00FC:
+            ops::OP_00FC(c);
+            break;
+        case Op::OP_00FD:
+            ops::OP_00FD(c);
+            break;
+        case Op::OP_00FE:
+            ops::OP_00FE(c);
+            break;
+        case Op::OP_00FF:
+            ops::OP_00FF(c);
+            break;
+        case Op::OP_Fx30:
+            ops::OP_Fx30(c, x);
+            break;
+        case Op::OP_Fx75:
+            ops::OP_Fx75(c, x);
+            break;
+        case Op::OP_Fx85:
+            ops::OP_Fx85(c, x);
+            break;
+        case Op::OP_00Dn:
+            ops::OP_00Dn(c, n);
+            break;
+        case Op::OP_5xy2:
+            ops::OP_5xy2(c, x, y);
+            break;
+        case Op::OP_5xy3:
+            ops::OP_5xy3(c, x, y);
+            break;
+        case Op::OP_F000:
+            ops::OP_F000(c);
+            break;
+        case Op::OP_Fn01:
+            ops::OP_Fn01(c, x);
+            break;
+        case Op::OP_F002:
+            ops::OP_F002(c);
+            break;
+        case Op::OP_Fx3A:
+            ops::OP_Fx3A(c, x);
+            break;
+        case Op::OP_8xy4_NF:
+            ops::OP_8xy4_NF(c, x, y);
+            break;
+        case Op::OP_8xy5_NF:
+            ops::OP_8xy5_NF(c, x, y);
+            break;
+        case Op::OP_8xy6_NF:
+            ops::OP_8xy6_NF(c, x);
+            break;
+        case Op::OP_8xy7_NF:
+            ops::OP_8xy7_NF(c, x, y);
+            break;
+        case Op::OP_8xyE_NF:
+            ops::OP_8xyE_NF(c, x);
+            break;
+        case Op::OP_Dxyn_NF:
+            ops::OP_Dxyn_NF(c, x, y, n);
+            break;
+        case Op::OP_AnnnDxyn:
+            ops::OP_AnnnDxyn(c, nnn, x, y, n);
+            break;
+        case Op::OP_AnnnDxyn_NF:
+            ops::OP_AnnnDxyn_NF(c, nnn, x, y, n);
+            break;
+        case Op::OP_7xkk3xkk1nnn:
+            ops::OP_7xkk3xkk1nnn(c, x, kk, y, nnn);
+            break;
+        case Op::OP_Fx073xkk1nnn:
+            ops::OP_Fx073xkk1nnn(c, x, kk, nnn);
+            break;
+    }
+}
+
+// Instantiated once in core.cpp
+extern template struct Core<quirks::Legacy>;
+extern template struct Core<quirks::Chip8>;
+extern template struct Core<quirks::SuperChip>;
+extern template struct Core<quirks::XoChip>;
+}  // namespace chip8
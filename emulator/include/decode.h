@@ -0,0 +1,313 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "types.h"
+
+namespace chip8
+{
+/// <summary>
+/// Handler id of a decoded instruction
+/// </summary>
+enum class Op : u8
+{
+    OP_NOP,
+    OP_00E0,
+    OP_00EE,
+    OP_1nnn,
+    OP_2nnn,
+    OP_3xkk,
+    OP_4xkk,
+    OP_5xy0,
+    OP_6xkk,
+    OP_7xkk,
+    OP_8xy0,
+    OP_8xy1,
+    OP_8xy2,
+    OP_8xy3,
+    OP_8xy4,
+    OP_8xy5,
+    OP_8xy6,
+    OP_8xy7,
+    OP_8xyE,
+    OP_9xy0,
+    OP_Annn,
+    OP_Bnnn,
+    OP_Cxkk,
+    OP_Dxyn,
+    OP_Ex9E,
+    OP_ExA1,
+    OP_Fx07,
+    OP_Fx0A,
+    OP_Fx15,
+    OP_Fx18,
+    OP_Fx1E,
+    OP_Fx29,
+    OP_Fx33,
+    OP_Fx55,
+    OP_Fx65,
+    /// SUPER-CHIP extensions
+    OP_00Cn,
+    OP_00FB,
+    OP_00FC,
+    OP_00FD,
+    OP_00FE,
+    OP_00FF,
+    OP_Fx30,
+    OP_Fx75,
+    OP_Fx85,
+    /// XO-CHIP extensions
+    OP_00Dn,
+    OP_5xy2,
+    OP_5xy3,
+    OP_F000,
+    OP_Fn01,
+    OP_F002,
+    OP_Fx3A,
+    /// Variants that leave VF alone, produced by ir::EliminateDeadFlags when VF is overwritten before it is read
+    OP_8xy4_NF,
+    OP_8xy5_NF,
+    OP_8xy6_NF,
+    OP_8xy7_NF,
+    OP_8xyE_NF,
+    OP_Dxyn_NF,
+    /// Superinstructions produced by ir::Fuse. nnn, x, y and n are the operands of Annn and Dxyn, respectively. The
+    /// fused loops keep the operands of their first instruction in x and kk, the target of the jump in nnn, and the loop
+    /// counter additionally keeps the immediate of its skip in y.
+    OP_AnnnDxyn,
+    OP_AnnnDxyn_NF,
+    OP_7xkk3xkk1nnn,
+    OP_Fx073xkk1nnn,
+    /// Marks an empty entry of the predecode cache, never produced by Decode
+    OP_UNDECODED,
+};
+
+/// <summary>
+/// An instruction with all of its operand fields extracted
+/// </summary>
+struct Instruction
+{
+    Op op{Op::OP_NOP};
+    u8 x{};
+    u8 y{};
+    u8 n{};
+    u8 kk{};
+    u16 nnn{};
+};
+
+static_assert(sizeof(Instruction) == 8, "A decoded instruction must fit into a single register");
+
+/// <summary>
+/// Decode a raw instruction the same way the dispatch tables of Chip8 do
+/// </summary>
+/// <param name="opcode"> Raw 16 bit instruction</param>
+constexpr Instruction Decode(u16 opcode)
+{
+    Instruction instruction;
+    instruction.x = (opcode & 0x0F00u) >> 8u;
+    instruction.y = (opcode & 0x00F0u) >> 4u;
+    instruction.n = opcode & 0x000Fu;
+    instruction.kk = opcode & 0x00FFu;
+    instruction.nnn = opcode & 0x0FFFu;
+
+    switch (opcode >> 12u)
+    {
+        case 0x0:
+            // The SUPER-CHIP and XO-CHIP instructions are matched on the whole low byte, everything else only on the last
+            // nibble
+            if ((instruction.kk & 0xF0u) == 0xC0u)
+            {
+                instruction.op = Op::OP_00Cn;
+            }
+            else if ((instruction.kk & 0xF0u) == 0xD0u)
+            {
+                instruction.op = Op::OP_00Dn;
+            }
+            else if (instruction.kk >= 0xFBu)
+            {
+                constexpr Op SUPER_CHIP[] = {Op::OP_00FB, Op::OP_00FC, Op::OP_00FD, Op::OP_00FE, Op::OP_00FF};
+                instruction.op = SUPER_CHIP[instruction.kk - 0xFBu];
+            }
+            else if (instruction.n == 0x0)
+            {
+                instruction.op = Op::OP_00E0;
+            }
+            else if (instruction.n == 0xE)
+            {
+                instruction.op = Op::OP_00EE;
+            }
+            break;
+        case 0x1:
+            instruction.op = Op::OP_1nnn;
+            break;
+        case 0x2:
+            instruction.op = Op::OP_2nnn;
+            break;
+        case 0x3:
+            instruction.op = Op::OP_3xkk;
+            break;
+        case 0x4:
+            instruction.op = Op::OP_4xkk;
+            break;
+        case 0x5:
+            if (instruction.n == 0x2)
+            {
+                instruction.op = Op::OP_5xy2;
+            }
+            else if (instruction.n == 0x3)
+            {
+                instruction.op = Op::OP_5xy3;
+            }
+            else
+            {
+                instruction.op = Op::OP_5xy0;
+            }
+            break;
+        case 0x6:
+            instruction.op = Op::OP_6xkk;
+            break;
+        case 0x7:
+            instruction.op = Op::OP_7xkk;
+            break;
+        case 0x8:
+            switch (instruction.n)
+            {
+                case 0x0:
+                    instruction.op = Op::OP_8xy0;
+                    break;
+                case 0x1:
+                    instruction.op = Op::OP_8xy1;
+                    break;
+                case 0x2:
+                    instruction.op = Op::OP_8xy2;
+                    break;
+                case 0x3:
+                    instruction.op = Op::OP_8xy3;
+                    break;
+                case 0x4:
+                    instruction.op = Op::OP_8xy4;
+                    break;
+                case 0x5:
+                    instruction.op = Op::OP_8xy5;
+                    break;
+                case 0x6:
+                    instruction.op = Op::OP_8xy6;
+                    break;
+                case 0x7:
+                    instruction.op = Op::OP_8xy7;
+                    break;
+                case 0xE:
+                    instruction.op = Op::OP_8xyE;
+                    break;
+            }
+            break;
+        case 0x9:
+            instruction.op = Op::OP_9xy0;
+            break;
+        case 0xA:
+            instruction.op = Op::OP_Annn;
+            break;
+        case 0xB:
+            instruction.op = Op::OP_Bnnn;
+            break;
+        case 0xC:
+            instruction.op = Op::OP_Cxkk;
+            break;
+        case 0xD:
+            instruction.op = Op::OP_Dxyn;
+            break;
+        case 0xE:
+            if (instruction.n == 0x1)
+            {
+                instruction.op = Op::OP_ExA1;
+            }
+            else if (instruction.n == 0xE)
+            {
+                instruction.op = Op::OP_Ex9E;
+            }
+            break;
+        case 0xF:
+            switch (instruction.kk)
+            {
+                case 0x00:
+                    instruction.op = Op::OP_F000;
+                    break;
+                case 0x01:
+                    instruction.op = Op::OP_Fn01;
+                    break;
+                case 0x02:
+                    instruction.op = Op::OP_F002;
+                    break;
+                case 0x07:
+                    instruction.op = Op::OP_Fx07;
+                    break;
+                case 0x0A:
+                    instruction.op = Op::OP_Fx0A;
+                    break;
+                case 0x15:
+                    instruction.op = Op::OP_Fx15;
+                    break;
+                case 0x18:
+                    instruction.op = Op::OP_Fx18;
+                    break;
+                case 0x1E:
+                    instruction.op = Op::OP_Fx1E;
+                    break;
+                case 0x29:
+                    instruction.op = Op::OP_Fx29;
+                    break;
+                case 0x30:
+                    instruction.op = Op::OP_Fx30;
+                    break;
+                case 0x33:
+                    instruction.op = Op::OP_Fx33;
+                    break;
+                case 0x3A:
+                    instruction.op = Op::OP_Fx3A;
+                    break;
+                case 0x55:
+                    instruction.op = Op::OP_Fx55;
+                    break;
+                case 0x65:
+                    instruction.op = Op::OP_Fx65;
+                    break;
+                case 0x75:
+                    instruction.op = Op::OP_Fx75;
+                    break;
+                case 0x85:
+                    instruction.op = Op::OP_Fx85;
+                    break;
+            }
+            break;
+    }
+
+    return instruction;
+}
+
+using decode_table_t = std::array<Instruction, 0x10000>;
+
+/// <summary>
+/// Every possible instruction, decoded at compile time and shared by all Chip8 instances
+/// </summary>
+extern const decode_table_t DECODE_TABLE;
+}  // namespace chip8
@@ -22,18 +22,160 @@
 
 #pragma once
 
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
 #include <fstream>
 #include <random>
+#include <type_traits>
+#include <vector>
 
+#include "decode.h"
 #include "font.h"
+#include "quirks.h"
 #include "types.h"
 
 namespace chip8
 {
-struct Chip8
+/// <summary>
+/// Engines that can decode and execute an instruction
+/// </summary>
+enum class Dispatch : u8
+{
+    /// Two level pointer-to-member tables (table, table0, table5, table8, tableE, tableF)
+    Table,
+    /// Flat switch over the handler ids of DECODE_TABLE, the operands are passed in registers
+    Switch,
+    /// Switch engine fed from a cache of decoded instructions indexed by the program counter
+    Cached,
+    /// Handlers instantiated for every register operand, see specialized.h
+    Specialized,
+};
+
+#ifdef CHIP8_SWITCH_DISPATCH
+constexpr Dispatch DEFAULT_DISPATCH = Dispatch::Switch;
+#else
+constexpr Dispatch DEFAULT_DISPATCH = Dispatch::Table;
+#endif
+
+/// <summary>
+/// When the delay and sound timers count down
+/// </summary>
+enum class Timing : u8
+{
+    /// After every instruction, so their speed depends on how fast instructions are executed
+    PerInstruction,
+    /// Only through TickTimers, which Scheduler calls once per 60 Hz frame of emulated time
+    Frame,
+};
+
+/// <summary>
+/// Why RunUntil returned
+/// </summary>
+enum class StopReason : u8
+{
+    /// The instruction budget is used up
+    Budget,
+    /// The frame ended, only returned by Scheduler::RunUntil
+    FrameEnd,
+    /// An instruction changed the display: 00E0, Dxyn, a scroll, 00Dn or a resolution switch
+    Draw,
+    /// The sound timer started or stopped
+    Sound,
+    /// Fx0A found no pressed key, pc is still at the Fx0A
+    KeyWait,
+    /// pc reached a breakpoint, the instruction there is not executed yet
+    Breakpoint,
+};
+
+/// Set of StopReasons, see StopOn
+using stop_mask_t = u8;
+
+constexpr stop_mask_t StopOn(StopReason reason)
+{
+    return static_cast<stop_mask_t>(1u << static_cast<u8>(reason));
+}
+
+/// <summary>
+/// Result of RunFor and RunUntil
+/// </summary>
+struct RunResult
+{
+    StopReason reason;
+    /// Number of executed instructions, including the one that caused the stop
+    u64 executed;
+};
+
+/// <summary>
+/// Architectural state of the machine. Trivially copyable, so it can be reset, snapshot or restored with a single
+/// memcpy. The fields that nearly every instruction touches share the first cache line, the rarely used small ones
+/// the second, followed by the video planes and memory.
+/// </summary>
+struct alignas(64) MachineState
+{
+    constexpr static u32 START_ADDRESS = 0x200;
+    constexpr static u32 FONTSET_START_ADDRESS = 0x50;
+    constexpr static u32 BIG_FONTSET_START_ADDRESS = FONTSET_START_ADDRESS + FONTSET_SIZE;
+
+    register_set registers{};
+    u16 index{};
+    u16 pc{START_ADDRESS};
+    u8 sp{};
+    u8 delayTimer{};
+    u8 soundTimer{};
+    /// SUPER-CHIP state. While hires is set, sprites are drawn to hiresVideo instead of video.
+    bool hires{};
+    /// XO-CHIP state. video and hiresVideo are the first bitplane, video2 and hiresVideo2 the second one. planes has a
+    /// bit for every bitplane that drawing, clearing and scrolling work on.
+    u8 planes{1};
+    /// The pattern is played at 4000 * 2 ^ ((pitch - 64) / 48) samples per second while the sound timer runs
+    u8 pitch{64};
+    stack_t stack{};
+
+    alignas(64) keypad_t keypad{};
+    flag_registers_t flagRegisters{};
+    audio_pattern_t audioPattern{};
+
+    alignas(64) video_mem_t video{};
+    hires_video_t hiresVideo{};
+    video_mem_t video2{};
+    hires_video_t hiresVideo2{};
+
+    /// Last and right after the framebuffers, so that PagedMachine finds them between video and memory
+    alignas(64) memory_t memory{};
+};
+
+static_assert(std::is_trivially_copyable_v<MachineState>, "The machine state must be copyable with memcpy");
+static_assert(offsetof(MachineState, stack) + sizeof(stack_t) <= 64, "The hot fields must share a cache line");
+static_assert(offsetof(MachineState, memory) + sizeof(memory_t) == sizeof(MachineState), "Memory must come last");
+
+struct Chip8 : MachineState
 {
     Chip8();
 
+    /// <summary>
+    /// Restore the power-on state: the font is in memory, everything else is zero and the program counter is at
+    /// START_ADDRESS. The loaded ROM is gone as well. The dispatch engine and the random generator are kept.
+    /// </summary>
+    void Reset();
+
+    /// <summary>
+    /// Same as Reset(), but additionally reseed the random generator, so that Cxkk produces a reproducible sequence
+    /// </summary>
+    /// <param name="seed"> Seed of the random generator</param>
+    void Reset(u32 seed);
+
+    /// <summary>
+    /// Copy of the architectural state. The dispatch engine, the variant and the random generator are not part of it.
+    /// </summary>
+    MachineState Snapshot() const { return *this; }
+
+    /// <summary>
+    /// Replace the architectural state with a snapshot, keeping the dispatch engine, the variant and the random
+    /// generator. The predecode cache is dropped, as the memory may differ.
+    /// </summary>
+    void Restore(const MachineState& state);
+
     /// <summary>
     /// Load a ROM into the memory
     /// </summary>
@@ -41,10 +183,127 @@ struct Chip8
     void LoadRom(std::string_view filename);
 
     /// <summary>
-    /// Fetch instruction, decode, execute
+    /// Load a ROM and select the platform it was written for
+    /// </summary>
+    /// <param name="filename"> Path to the ROM</param>
+    /// <param name="romVariant"> Platform whose quirks the ROM expects</param>
+    void LoadRom(std::string_view filename, Variant romVariant);
+
+    /// <summary>
+    /// Execute the given number of cycles. The core specialised for the variant is picked once per call.
+    /// </summary>
+    /// <returns> Number of executed cycles</returns>
+    u64 Run(u64 cycles);
+
+    /// <summary>
+    /// Execute the given number of instructions, unless a breakpoint is reached first
+    /// </summary>
+    RunResult RunFor(u64 instructions);
+
+    /// <summary>
+    /// Execute until one of the selected events happens or the budget is used up. Always runs on the switch engine
+    /// specialised for the variant, with the timing checked once per call instead of per instruction. The breakpoint
+    /// at pc, if any, is ignored for the first instruction, so a call after a breakpoint stop continues from it.
+    /// </summary>
+    /// <param name="stopOn"> StopOn() of every reason to stop for, StopReason::Budget always applies</param>
+    /// <param name="budget"> Maximum number of instructions</param>
+    RunResult RunUntil(stop_mask_t stopOn, u64 budget);
+
+    /// <summary>
+    /// Fetch instruction, decode, execute. Ticks the timers as well with Timing::PerInstruction.
     /// </summary>
     void Cycle();
 
+    /// <summary>
+    /// Decrement the delay and the sound timer if they have been set
+    /// </summary>
+    void TickTimers()
+    {
+        if (delayTimer > 0)
+        {
+            --delayTimer;
+        }
+
+        if (soundTimer > 0)
+        {
+            --soundTimer;
+        }
+    }
+
+    /// <summary>
+    /// Same as calling TickTimers() the given number of times
+    /// </summary>
+    void TickTimers(u32 ticks)
+    {
+        delayTimer = delayTimer > ticks ? delayTimer - ticks : 0;
+        soundTimer = soundTimer > ticks ? soundTimer - ticks : 0;
+    }
+
+    /// <summary>
+    /// Execute a single decoded instruction with the switch engine
+    /// </summary>
+    /// <param name="instruction"> Instruction taken from DECODE_TABLE</param>
+    void Execute(Instruction instruction);
+
+    /// <summary>
+    /// Drop the cached decoding of every instruction that overlaps the given memory range and mark its pages as
+    /// written. Has to be called after writing to memory from outside of the instruction handlers while the cached
+    /// engine or a PagedMachine is in use.
+    /// </summary>
+    /// <param name="address"> First address that was written</param>
+    /// <param name="size"> Number of bytes that were written</param>
+    void InvalidateDecodeCache(u32 address, u32 size)
+    {
+        if (size > 0)
+        {
+            for (u32 page = address / MEMORY_PAGE_SIZE; page <= (address + size - 1) / MEMORY_PAGE_SIZE; ++page)
+            {
+                writtenPages.set(page % MEMORY_PAGES);
+#ifdef CHIP8_STATE_HASH
+                hashedPages.reset(page % MEMORY_PAGES);
+#endif
+            }
+        }
+
+        if (decodeCache.empty())
+        {
+            return;
+        }
+
+        // The instruction starting one byte before the range reads the first byte of it
+        u32 begin = address > 0 ? address - 1 : 0;
+        u32 end = std::min<u32>(address + size, decodeCache.size());
+
+        for (u32 i = begin; i < end; ++i)
+        {
+            decodeCache[i].op = Op::OP_UNDECODED;
+        }
+    }
+
+    /// <summary>
+    /// Drop the whole predecode cache and mark every page and the framebuffers as written. Has to be called after
+    /// replacing the state from outside of the instruction handlers.
+    /// </summary>
+    void InvalidateDecodeCache();
+
+    /// <summary>
+    /// Mark the framebuffers of the current display mode as written for StateHash() and PagedMachine. Called by the
+    /// handlers that draw, clear or scroll.
+    /// </summary>
+    void InvalidateVideo()
+    {
+        (hires ? hiresWritten : loresWritten) = true;
+#ifdef CHIP8_STATE_HASH
+        (hires ? hiresHashed : loresHashed) = false;
+#endif
+    }
+
+    /// <summary>
+    /// Hash of the whole MachineState, equal to HashState(*this), see state_hash.h. With CHIP8_STATE_HASH only the
+    /// memory pages and framebuffers written since the last call are hashed again; without it, everything is.
+    /// </summary>
+    u64 StateHash();
+
     /// <summary>
     ///  Clear the display
     /// </summary>
@@ -237,6 +496,9 @@ struct Chip8
     /// pixels to be erased, VF is set to 1, otherwise it is set to 0. If the sprite is positioned so part of it is
     /// outside the coordinates of the display, it wraps around to the opposite side of the screen. See instruction 8xy3
     /// for more information on XOR, and section 2.4, Display, for more information on the Chip-8 screen and sprites.
+    ///
+    /// Dxy0 draws a 16x16 sprite made of 32 bytes, two per row, with the SUPER-CHIP and XO-CHIP quirks and nothing
+    /// otherwise.
     /// </summary>
     void OP_Dxyn();
 
@@ -332,34 +594,156 @@ struct Chip8
     /// </summary>
     void OP_Fx65();
 
-    register_set registers{};
+    /// <summary>
+    /// 00Cn - SCD n
+    /// Scroll the display down by n pixels. SUPER-CHIP.
+    /// </summary>
+    void OP_00Cn();
 
-    constexpr static u32 START_ADDRESS = 0x200;
-    constexpr static u32 FONTSET_START_ADDRESS = 0x50;
-    memory_t memory{};
+    /// <summary>
+    /// 00FB - SCR
+    /// Scroll the display right by 4 pixels. SUPER-CHIP.
+    /// </summary>
+    void OP_00FB();
+
+    /// <summary>
+    /// 00FC - SCL
+    /// Scroll the display left by 4 pixels. SUPER-CHIP.
+    /// </summary>
+    void OP_00FC();
+
+    /// <summary>
+    /// 00FD - EXIT
+    /// Stop the interpreter. SUPER-CHIP. The program counter stays on the instruction.
+    /// </summary>
+    void OP_00FD();
+
+    /// <summary>
+    /// 00FE - LOW
+    /// Switch to the 64x32 display and clear it. SUPER-CHIP.
+    /// </summary>
+    void OP_00FE();
+
+    /// <summary>
+    /// 00FF - HIGH
+    /// Switch to the 128x64 display and clear it. SUPER-CHIP.
+    /// </summary>
+    void OP_00FF();
+
+    /// <summary>
+    /// Fx30 - LD HF, Vx
+    /// Set I = location of the 8x10 sprite for digit Vx. SUPER-CHIP.
+    /// </summary>
+    void OP_Fx30();
+
+    /// <summary>
+    /// Fx75 - LD R, Vx
+    /// Store registers V0 through Vx in the flag registers. SUPER-CHIP.
+    /// </summary>
+    void OP_Fx75();
+
+    /// <summary>
+    /// Fx85 - LD Vx, R
+    /// Read registers V0 through Vx from the flag registers. SUPER-CHIP.
+    /// </summary>
+    void OP_Fx85();
+
+    /// <summary>
+    /// 00Dn - SCU n
+    /// Scroll the selected bitplanes up by n pixels. XO-CHIP.
+    /// </summary>
+    void OP_00Dn();
+
+    /// <summary>
+    /// 5xy2 - LD [I], Vx - Vy
+    /// Store registers Vx through Vy in memory starting at location I, in reverse order if x > y. I is not changed.
+    /// XO-CHIP.
+    /// </summary>
+    void OP_5xy2();
+
+    /// <summary>
+    /// 5xy3 - LD Vx - Vy, [I]
+    /// Read registers Vx through Vy from memory starting at location I, in reverse order if x > y. I is not changed.
+    /// XO-CHIP.
+    /// </summary>
+    void OP_5xy3();
+
+    /// <summary>
+    /// F000 nnnn - LD I, nnnn
+    /// Set I = the 16 bit address in the word following the instruction, which is skipped. XO-CHIP.
+    /// </summary>
+    void OP_F000();
+
+    /// <summary>
+    /// Fn01 - PLANE n
+    /// Select the bitplanes that drawing, clearing and scrolling work on. Bit 0 is the first plane, bit 1 the second
+    /// one. Dxyn reads the sprite of every selected plane, one after the other. XO-CHIP.
+    /// </summary>
+    void OP_Fn01();
+
+    /// <summary>
+    /// F002 - AUDIO
+    /// Load the 16 byte audio pattern from memory starting at location I. XO-CHIP.
+    /// </summary>
+    void OP_F002();
+
+    /// <summary>
+    /// Fx3A - PITCH Vx
+    /// Set the playback rate of the audio pattern to 4000 * 2 ^ ((Vx - 64) / 48) Hz. XO-CHIP.
+    /// </summary>
+    void OP_Fx3A();
 
-    u16 index{};
-    u16 pc{START_ADDRESS};
-    stack_t stack{};
-    u8 sp{};
-    u8 delayTimer{};
-    u8 soundTimer{};
-    keypad_t keypad{};
-    video_mem_t video{};
     u16 opcode{};
 
+    Dispatch dispatch{DEFAULT_DISPATCH};
+
+    /// Platform quirks to emulate. Anything but Variant::Legacy runs on Core<Quirks> and ignores dispatch.
+    Variant variant{Variant::Legacy};
+
+    /// Cycle and Run only tick the timers with Timing::PerInstruction. BlockCache, Jit and the ahead of time
+    /// translated programs always tick them per instruction.
+    Timing timing{Timing::PerInstruction};
+
+    /// Addresses where RunFor and RunUntil stop with StopReason::Breakpoint
+    std::bitset<MEMORY_SIZE> breakpoints;
+
+    /// Decoded instruction for every address, allocated the first time the cached engine runs
+    std::vector<Instruction> decodeCache;
+
+    /// Pages written by the instruction handlers or marked by InvalidateDecodeCache, see PagedMachine
+    std::bitset<MEMORY_PAGES> writtenPages;
+
+    /// Framebuffers of each display mode written by the instruction handlers or marked by InvalidateDecodeCache, see
+    /// PagedMachine
+    bool loresWritten{};
+    bool hiresWritten{};
+
+#ifdef CHIP8_STATE_HASH
+    /// Hashes of every memory page and of the framebuffers of both display modes as of the last StateHash().
+    /// memoryHash is the XOR of pageHashes, which is updated page by page.
+    std::array<u64, MEMORY_PAGES> pageHashes{};
+    std::bitset<MEMORY_PAGES> hashedPages;
+    u64 memoryHash{};
+    u64 loresHash{};
+    u64 hiresHash{};
+    bool loresHashed{};
+    bool hiresHashed{};
+#endif
+
     std::default_random_engine randomGenerator;
     std::uniform_int_distribution<unsigned int> randomByte;
 
+    /// Dispatch tables of the table engine, shared by all instances
     using Chip8Func = void (Chip8::*)();
-    Chip8Func table[0xF + 1];
-    Chip8Func table0[0xE + 1];
-    Chip8Func table8[0xE + 1];
-    Chip8Func tableE[0xE + 1];
-    Chip8Func tableF[0x65 + 1];
+    static const std::array<Chip8Func, 0xF + 1> table;
+    static const std::array<Chip8Func, 0xFF + 1> table0;
+    static const std::array<Chip8Func, 0xF + 1> table5;
+    static const std::array<Chip8Func, 0xF + 1> table8;
+    static const std::array<Chip8Func, 0xF + 1> tableE;
+    static const std::array<Chip8Func, 0xFF + 1> tableF;
 
-    void InitInstructionTable();
     void Table0();
+    void Table5();
     void Table8();
     void TableE();
     void TableF();
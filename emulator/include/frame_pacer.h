@@ -0,0 +1,118 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+
+#include "types.h"
+
+namespace chip8
+{
+/// <summary>
+/// How FramePacer places the work of a frame within the frame
+/// </summary>
+enum class Pacing : u8
+{
+    /// Work starts at the frame deadline
+    Fixed,
+    /// For a vsynced present: work starts as late as the display allows. The pacer measures how long the present call
+    /// blocks waiting for the display and moves the deadlines later until it barely blocks, so input is polled shortly
+    /// before the frame is shown.
+    LowLatency
+};
+
+/// <summary>
+/// Frame time statistics over the intervals between the starts of consecutive frames
+/// </summary>
+struct FrameStats
+{
+    u64 frames{};
+    /// Frames that started more than a whole frame late, after which the pacer resynchronised
+    u64 missed{};
+    std::chrono::nanoseconds mean{};
+    /// Standard deviation of the frame time
+    std::chrono::nanoseconds jitter{};
+    /// Largest difference between a frame time and the period
+    std::chrono::nanoseconds maxDeviation{};
+};
+
+/// <summary>
+/// Paces a host loop to a fixed frame rate. Deadlines are absolute, so sleeping late in one frame doesn't shift the
+/// following ones. It sleeps until shortly before the deadline and spins for the rest, because sleeps overshoot.
+/// </summary>
+class FramePacer
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// Part of the wait that is spun instead of slept
+    constexpr static std::chrono::nanoseconds SPIN_TAIL = std::chrono::microseconds(500);
+
+    explicit FramePacer(u32 framesPerSecond, Pacing pacing = Pacing::Fixed);
+
+    /// <summary>
+    /// Wait until the work of the next frame should start. If the loop fell more than a frame behind, the missed frames
+    /// are dropped and the deadlines restart from now.
+    /// </summary>
+    void Wait();
+
+    /// <summary>
+    /// Mark that the frame is handed to the display, right before the present call
+    /// </summary>
+    void Presenting();
+
+    /// <summary>
+    /// Mark the end of the frame that the last Wait started, right after the present call returned. LowLatency moves
+    /// the following deadlines by the part of the present wait above PresentMargin.
+    /// </summary>
+    void FrameDone();
+
+    /// <summary>
+    /// Statistics of all frames so far
+    /// </summary>
+    FrameStats Stats() const;
+
+    /// Present wait that LowLatency keeps as a reserve against frames that take longer than the previous ones
+    std::chrono::nanoseconds PresentMargin() const { return Period() / 8; }
+
+    std::chrono::nanoseconds Period() const { return Deadline(1) - Deadline(0); }
+
+private:
+    clock::time_point Deadline(u64 index) const;
+
+    u32 framesPerSecond;
+    Pacing pacing;
+
+    clock::time_point epoch;
+    u64 frame{};
+
+    clock::time_point frameStart;
+    clock::time_point presentStart;
+
+    u64 intervals{};
+    u64 missed{};
+    double sum{};
+    double sumOfSquares{};
+    std::chrono::nanoseconds maxDeviation{};
+};
+}  // namespace chip8
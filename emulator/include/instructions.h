@@ -0,0 +1,686 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <bit>
+
+#include "emulator.h"
+#include "quirks.h"
+#include "video.h"
+
+namespace chip8::ops
+{
+/// Instruction semantics with their operands already decoded. Every dispatch engine ends up here, so an instruction
+/// behaves the same no matter how it was fetched and decoded. See the OP_ members of Chip8 for the documentation of
+/// each instruction.
+///
+/// Kernels whose behaviour differs between platforms take a quirk policy (see quirks.h) as template parameter. The
+/// default is the behaviour of quirks::Legacy.
+
+/// <summary>
+/// Apply an operation to the framebuffer of every selected bitplane in the current display mode
+/// </summary>
+template <typename Operation>
+inline void ForEachPlane(Chip8& c, Operation operation)
+{
+    c.InvalidateVideo();
+
+    if (c.hires)
+    {
+        if (c.planes & 0x1u)
+        {
+            operation(c.hiresVideo);
+        }
+
+        if (c.planes & 0x2u)
+        {
+            operation(c.hiresVideo2);
+        }
+    }
+    else
+    {
+        if (c.planes & 0x1u)
+        {
+            operation(c.video);
+        }
+
+        if (c.planes & 0x2u)
+        {
+            operation(c.video2);
+        }
+    }
+}
+
+/// <summary>
+/// Skip the next instruction, which is two words long if it is F000 nnnn and the platform knows about that
+/// </summary>
+template <typename Quirks>
+inline void Skip(Chip8& c)
+{
+    if constexpr (Quirks::SKIPS_LONG_LOAD)
+    {
+        if (c.memory[c.pc % MEMORY_SIZE] == 0xF0 && c.memory[(c.pc + 1) % MEMORY_SIZE] == 0x00)
+        {
+            c.pc += 2;
+        }
+    }
+
+    c.pc += 2;
+}
+
+inline void OP_00E0(Chip8& c)
+{
+    ForEachPlane(c, [](auto& video) { video.fill(0); });
+}
+
+inline void OP_00EE(Chip8& c)
+{
+    c.pc = c.stack[--c.sp];
+}
+
+inline void OP_1nnn(Chip8& c, u16 nnn)
+{
+    c.pc = nnn;
+}
+
+inline void OP_2nnn(Chip8& c, u16 nnn)
+{
+    c.stack[c.sp++] = c.pc;
+    c.pc = nnn;
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_3xkk(Chip8& c, u8 x, u8 kk)
+{
+    if (c.registers[x] == kk)
+    {
+        Skip<Quirks>(c);
+    }
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_4xkk(Chip8& c, u8 x, u8 kk)
+{
+    if (c.registers[x] != kk)
+    {
+        Skip<Quirks>(c);
+    }
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_5xy0(Chip8& c, u8 x, u8 y)
+{
+    if (c.registers[x] == c.registers[y])
+    {
+        Skip<Quirks>(c);
+    }
+}
+
+inline void OP_6xkk(Chip8& c, u8 x, u8 kk)
+{
+    c.registers[x] = kk;
+}
+
+inline void OP_7xkk(Chip8& c, u8 x, u8 kk)
+{
+    c.registers[x] += kk;
+}
+
+inline void OP_8xy0(Chip8& c, u8 x, u8 y)
+{
+    c.registers[x] = c.registers[y];
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_8xy1(Chip8& c, u8 x, u8 y)
+{
+    c.registers[x] |= c.registers[y];
+
+    if constexpr (Quirks::LOGIC_RESETS_VF)
+    {
+        c.registers[0xF] = 0;
+    }
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_8xy2(Chip8& c, u8 x, u8 y)
+{
+    c.registers[x] &= c.registers[y];
+
+    if constexpr (Quirks::LOGIC_RESETS_VF)
+    {
+        c.registers[0xF] = 0;
+    }
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_8xy3(Chip8& c, u8 x, u8 y)
+{
+    c.registers[x] ^= c.registers[y];
+
+    if constexpr (Quirks::LOGIC_RESETS_VF)
+    {
+        c.registers[0xF] = 0;
+    }
+}
+
+inline void OP_8xy4(Chip8& c, u8 x, u8 y)
+{
+    u16 sum = c.registers[x] + c.registers[y];
+
+    c.registers[0xF] = sum >= 256u ? 1 : 0;
+    c.registers[x] = sum & 0xFFu;
+}
+
+inline void OP_8xy5(Chip8& c, u8 x, u8 y)
+{
+    c.registers[0xF] = c.registers[x] > c.registers[y] ? 1 : 0;
+    c.registers[x] -= c.registers[y];
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_8xy6(Chip8& c, u8 x, [[maybe_unused]] u8 y)
+{
+    if constexpr (Quirks::SHIFT_USES_VY)
+    {
+        const u8 value = c.registers[y];
+        c.registers[x] = value >> 1;
+        c.registers[0xF] = value & 0x01u;
+    }
+    else
+    {
+        c.registers[0xF] = c.registers[x] & 0x01u;
+        c.registers[x] >>= 1;
+    }
+}
+
+inline void OP_8xy7(Chip8& c, u8 x, u8 y)
+{
+    c.registers[0xF] = c.registers[y] > c.registers[x] ? 1 : 0;
+    c.registers[x] = c.registers[y] - c.registers[x];
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_8xyE(Chip8& c, u8 x, [[maybe_unused]] u8 y)
+{
+    if constexpr (Quirks::SHIFT_USES_VY)
+    {
+        const u8 value = c.registers[y];
+        c.registers[x] = value << 1;
+        c.registers[0xF] = (value & 0x80u) >> 7u;
+    }
+    else
+    {
+        c.registers[0xF] = (c.registers[x] & 0x80u) >> 7u;
+        c.registers[x] <<= 1;
+    }
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_9xy0(Chip8& c, u8 x, u8 y)
+{
+    if (c.registers[x] != c.registers[y])
+    {
+        Skip<Quirks>(c);
+    }
+}
+
+inline void OP_Annn(Chip8& c, u16 nnn)
+{
+    c.index = nnn;
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_Bnnn(Chip8& c, u16 nnn)
+{
+    const u8 x = Quirks::JUMP_USES_VX ? nnn >> 8u : 0;
+    c.pc = c.registers[x] + nnn;
+}
+
+inline void OP_Cxkk(Chip8& c, u8 x, u8 kk)
+{
+    c.registers[x] = c.randomByte(c.randomGenerator) & kk;
+}
+
+/// <summary>
+/// XOR one sprite row onto a row of a framebuffer made of rows of WIDTH / 64 words. The sprite row covers at most two
+/// words, so whatever does not fit into the first word goes to the next word of the row, or past the right edge,
+/// where the quirk policy decides what happens to it.
+/// </summary>
+/// <param name="line"> First word of the row</param>
+/// <param name="next"> First word of the row below</param>
+/// <param name="sprite"> Sprite row aligned to the left edge of a word</param>
+/// <param name="overflows"> True if the sprite row reaches into the word after xPos / 64</param>
+/// <returns> The erased pixels</returns>
+template <typename Quirks, u32 WIDTH>
+inline u64 XorSpriteRow(u64* line, u64* next, u32 xPos, u64 sprite, bool overflows)
+{
+    constexpr u32 WORDS = WIDTH / 64;
+
+    const u32 word = xPos / 64;
+    const u32 shift = xPos % 64;
+
+    const u64 pixels = sprite >> shift;
+    u64 collision = line[word] & pixels;
+    line[word] ^= pixels;
+
+    if (!overflows)
+    {
+        return collision;
+    }
+
+    u64* target = nullptr;
+
+    if (word + 1 < WORDS)
+    {
+        target = &line[word + 1];
+    }
+    else if constexpr (Quirks::SPRITE_EDGE == SpriteEdge::Wrap)
+    {
+        target = &line[0];
+    }
+    else if constexpr (Quirks::SPRITE_EDGE == SpriteEdge::Linear)
+    {
+        // With a linear screen, pixels past the right edge continue at the start of the next row
+        target = next;
+    }
+    else
+    {
+        return collision;
+    }
+
+    const u64 overflow = sprite << (64 - shift);
+    collision |= *target & overflow;
+    *target ^= overflow;
+
+    return collision;
+}
+
+/// <summary>
+/// XOR a sprite onto the bitplanes in PLANES of a framebuffer of the given size. All planes are updated in the same
+/// pass over the rows, the sprite of the second plane follows the one of the first plane in memory.
+/// </summary>
+/// <returns> True if a pixel was erased</returns>
+template <typename Quirks, u32 WIDTH, u32 HEIGHT, u8 PLANES>
+inline bool DrawSprite(Chip8& c, u64* first, u64* second, u8 x, u8 y, u8 n)
+{
+    constexpr u32 WORDS = WIDTH / 64;
+
+    const u32 xPos = c.registers[x] % WIDTH;
+    const u32 yPos = c.registers[y] % HEIGHT;
+
+    // Dxy0 draws a 16x16 sprite with two bytes per row where the platform has them, and nothing otherwise
+    const bool large = Quirks::LARGE_SPRITES && n == 0;
+    const u32 rows = large ? 16 : n;
+    const u32 spriteWidth = large ? 16 : 8;
+    const u32 rowBytes = large ? 2 : 1;
+    const bool overflows = xPos % 64 > 64 - spriteWidth;
+
+    auto spriteRow = [&c, large, spriteWidth](u32 address) {
+        const u64 bits = large ? (c.memory[address] << 8u) | c.memory[address + 1] : c.memory[address];
+        return bits << (64 - spriteWidth);
+    };
+
+    u64 collision = 0;
+
+    for (u32 row = 0; row < rows; row++)
+    {
+        if (Quirks::SPRITE_EDGE == SpriteEdge::Clip && yPos + row >= HEIGHT)
+        {
+            break;
+        }
+
+        const u32 line = (yPos + row) % HEIGHT * WORDS;
+        const u32 next = (yPos + row + 1) % HEIGHT * WORDS;
+        const u32 address = c.index + row * rowBytes;
+
+        if constexpr ((PLANES & 0x1u) != 0)
+        {
+            collision |= XorSpriteRow<Quirks, WIDTH>(first + line, first + next, xPos, spriteRow(address), overflows);
+        }
+
+        if constexpr ((PLANES & 0x2u) != 0)
+        {
+            const u32 offset = (PLANES & 0x1u) != 0 ? rows * rowBytes : 0;
+            collision |= XorSpriteRow<Quirks, WIDTH>(
+                second + line, second + next, xPos, spriteRow(address + offset), overflows);
+        }
+    }
+
+    return collision != 0;
+}
+
+/// <summary>
+/// XOR a sprite onto the selected bitplanes of a framebuffer of the given size
+/// </summary>
+/// <returns> True if a pixel was erased</returns>
+template <typename Quirks, u32 WIDTH, u32 HEIGHT>
+inline bool DrawSprite(Chip8& c, u64* first, u64* second, u8 x, u8 y, u8 n)
+{
+    switch (c.planes)
+    {
+        case 0x1:
+            return DrawSprite<Quirks, WIDTH, HEIGHT, 0x1>(c, first, second, x, y, n);
+        case 0x2:
+            return DrawSprite<Quirks, WIDTH, HEIGHT, 0x2>(c, first, second, x, y, n);
+        case 0x3:
+            return DrawSprite<Quirks, WIDTH, HEIGHT, 0x3>(c, first, second, x, y, n);
+        default:
+            return false;
+    }
+}
+
+/// <summary>
+/// XOR a sprite onto the selected bitplanes of the current display mode
+/// </summary>
+/// <returns> True if a pixel was erased</returns>
+template <typename Quirks = quirks::Legacy>
+inline bool DrawSprite(Chip8& c, u8 x, u8 y, u8 n)
+{
+    c.InvalidateVideo();
+
+    if (c.hires)
+    {
+        return DrawSprite<Quirks, HIRES_WIDTH, HIRES_HEIGHT>(c, c.hiresVideo.data(), c.hiresVideo2.data(), x, y, n);
+    }
+
+    return DrawSprite<Quirks, VIDEO_WIDTH, VIDEO_HEIGHT>(c, c.video.data(), c.video2.data(), x, y, n);
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_Dxyn(Chip8& c, u8 x, u8 y, u8 n)
+{
+    c.registers[0xF] = DrawSprite<Quirks>(c, x, y, n) ? 1 : 0;
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_Ex9E(Chip8& c, u8 x)
+{
+    // Only the low nibble names a key, the keypad has 16
+    if (c.keypad[c.registers[x] & 0xFu])
+    {
+        Skip<Quirks>(c);
+    }
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_ExA1(Chip8& c, u8 x)
+{
+    if (!c.keypad[c.registers[x] & 0xFu])
+    {
+        Skip<Quirks>(c);
+    }
+}
+
+inline void OP_Fx07(Chip8& c, u8 x)
+{
+    c.registers[x] = c.delayTimer;
+}
+
+inline void OP_Fx0A(Chip8& c, u8 x)
+{
+    for (u8 i = 0; i < c.keypad.size(); ++i)
+    {
+        if (c.keypad[i])
+        {
+            c.registers[x] = i;
+            return;
+        }
+    }
+
+    c.pc -= 2;
+}
+
+inline void OP_Fx15(Chip8& c, u8 x)
+{
+    c.delayTimer = c.registers[x];
+}
+
+inline void OP_Fx18(Chip8& c, u8 x)
+{
+    c.soundTimer = c.registers[x];
+}
+
+inline void OP_Fx1E(Chip8& c, u8 x)
+{
+    c.index += c.registers[x];
+}
+
+inline void OP_Fx29(Chip8& c, u8 x)
+{
+    c.index = Chip8::FONTSET_START_ADDRESS + (5 * c.registers[x]);
+}
+
+inline void OP_Fx33(Chip8& c, u8 x)
+{
+    u8 value = c.registers[x];
+
+    c.memory[c.index + 2] = value % 10;
+    value /= 10;
+
+    c.memory[c.index + 1] = value % 10;
+    value /= 10;
+
+    c.memory[c.index] = value % 10;
+
+    c.InvalidateDecodeCache(c.index, 3);
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_Fx55(Chip8& c, u8 x)
+{
+    for (u8 i = 0; i <= x; ++i)
+    {
+        c.memory[c.index + i] = c.registers[i];
+    }
+
+    c.InvalidateDecodeCache(c.index, x + 1);
+
+    if constexpr (Quirks::LOAD_STORE_INCREMENTS_INDEX)
+    {
+        c.index += x + 1;
+    }
+}
+
+template <typename Quirks = quirks::Legacy>
+inline void OP_Fx65(Chip8& c, u8 x)
+{
+    for (u8 i = 0; i <= x; ++i)
+    {
+        c.registers[i] = c.memory[c.index + i];
+    }
+
+    if constexpr (Quirks::LOAD_STORE_INCREMENTS_INDEX)
+    {
+        c.index += x + 1;
+    }
+}
+
+inline void OP_00Cn(Chip8& c, u8 n)
+{
+    ForEachPlane(c, [n](auto& video) { ScrollDown(video, n); });
+}
+
+inline void OP_00FB(Chip8& c)
+{
+    ForEachPlane(c, [](auto& video) { ScrollRight(video, 4); });
+}
+
+inline void OP_00FC(Chip8& c)
+{
+    ForEachPlane(c, [](auto& video) { ScrollLeft(video, 4); });
+}
+
+inline void OP_00FD(Chip8& c)
+{
+    c.pc -= 2;
+}
+
+inline void OP_00FE(Chip8& c)
+{
+    c.hires = false;
+    c.InvalidateVideo();
+    c.video.fill(0);
+    c.video2.fill(0);
+}
+
+inline void OP_00FF(Chip8& c)
+{
+    c.hires = true;
+    c.InvalidateVideo();
+    c.hiresVideo.fill(0);
+    c.hiresVideo2.fill(0);
+}
+
+inline void OP_Fx30(Chip8& c, u8 x)
+{
+    c.index = Chip8::BIG_FONTSET_START_ADDRESS + (10 * c.registers[x]);
+}
+
+inline void OP_Fx75(Chip8& c, u8 x)
+{
+    std::copy_n(c.registers.begin(), x + 1, c.flagRegisters.begin());
+}
+
+inline void OP_Fx85(Chip8& c, u8 x)
+{
+    std::copy_n(c.flagRegisters.begin(), x + 1, c.registers.begin());
+}
+
+inline void OP_00Dn(Chip8& c, u8 n)
+{
+    ForEachPlane(c, [n](auto& video) { ScrollUp(video, n); });
+}
+
+inline void OP_5xy2(Chip8& c, u8 x, u8 y)
+{
+    const u32 count = std::max(x, y) - std::min(x, y) + 1;
+    auto destination = c.memory.begin() + c.index;
+
+    if (x <= y)
+    {
+        std::copy_n(c.registers.begin() + x, count, destination);
+    }
+    else
+    {
+        std::reverse_copy(c.registers.begin() + y, c.registers.begin() + x + 1, destination);
+    }
+
+    c.InvalidateDecodeCache(c.index, count);
+}
+
+inline void OP_5xy3(Chip8& c, u8 x, u8 y)
+{
+    const u32 count = std::max(x, y) - std::min(x, y) + 1;
+    auto source = c.memory.begin() + c.index;
+
+    if (x <= y)
+    {
+        std::copy_n(source, count, c.registers.begin() + x);
+    }
+    else
+    {
+        std::reverse_copy(source, source + count, c.registers.begin() + y);
+    }
+}
+
+inline void OP_F000(Chip8& c)
+{
+    c.index = ((c.memory[c.pc % MEMORY_SIZE] << 8u) | c.memory[(c.pc + 1) % MEMORY_SIZE]) % MEMORY_SIZE;
+    c.pc += 2;
+}
+
+inline void OP_Fn01(Chip8& c, u8 n)
+{
+    c.planes = n & 0x3u;
+}
+
+inline void OP_F002(Chip8& c)
+{
+    std::copy_n(c.memory.begin() + c.index, c.audioPattern.size(), c.audioPattern.begin());
+}
+
+inline void OP_Fx3A(Chip8& c, u8 x)
+{
+    c.pitch = c.registers[x];
+}
+
+inline void OP_8xy4_NF(Chip8& c, u8 x, u8 y)
+{
+    c.registers[x] += c.registers[y];
+}
+
+inline void OP_8xy5_NF(Chip8& c, u8 x, u8 y)
+{
+    c.registers[x] -= c.registers[y];
+}
+
+inline void OP_8xy6_NF(Chip8& c, u8 x)
+{
+    c.registers[x] >>= 1;
+}
+
+inline void OP_8xy7_NF(Chip8& c, u8 x, u8 y)
+{
+    c.registers[x] = c.registers[y] - c.registers[x];
+}
+
+inline void OP_8xyE_NF(Chip8& c, u8 x)
+{
+    c.registers[x] <<= 1;
+}
+
+inline void OP_Dxyn_NF(Chip8& c, u8 x, u8 y, u8 n)
+{
+    DrawSprite(c, x, y, n);
+}
+
+// Superinstructions. They run with the program counter behind their first instruction and leave it where the last
+// instruction of the sequence would have.
+
+inline void OP_AnnnDxyn(Chip8& c, u16 nnn, u8 x, u8 y, u8 n)
+{
+    c.index = nnn;
+    OP_Dxyn(c, x, y, n);
+    c.pc += 2;
+}
+
+inline void OP_AnnnDxyn_NF(Chip8& c, u16 nnn, u8 x, u8 y, u8 n)
+{
+    c.index = nnn;
+    DrawSprite(c, x, y, n);
+    c.pc += 2;
+}
+
+inline void OP_7xkk3xkk1nnn(Chip8& c, u8 x, u8 kk, u8 compare, u16 nnn)
+{
+    c.registers[x] += kk;
+    c.pc = c.registers[x] == compare ? c.pc + 4 : nnn;
+}
+
+inline void OP_Fx073xkk1nnn(Chip8& c, u8 x, u8 kk, u16 nnn)
+{
+    c.registers[x] = c.delayTimer;
+    c.pc = c.registers[x] == kk ? c.pc + 4 : nnn;
+}
+}  // namespace chip8::ops
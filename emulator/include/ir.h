@@ -0,0 +1,109 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "decode.h"
+#include "types.h"
+
+namespace chip8::ir
+{
+/// <summary>
+/// A decoded instruction inside a block
+/// </summary>
+struct Node
+{
+    Instruction instruction;
+
+    /// Address the instruction was decoded from
+    u16 address{};
+
+    /// Number of guest instructions this node retires, which is also the number of timer ticks after it. Instructions
+    /// removed by the optimiser are folded into the node in front of them.
+    u8 ticks{1};
+};
+
+/// <summary>
+/// Straight-line sequence of instructions. Only the last instruction may change the program counter, and only the
+/// state after the whole block is guaranteed to match the interpreter.
+/// </summary>
+struct Block
+{
+    std::vector<Node> nodes;
+
+    /// First address
+    u16 begin{};
+
+    /// Address behind the last instruction, where execution continues if the last instruction doesn't branch
+    u16 end{};
+
+    /// Number of guest instructions the block retires, assuming a fused loop at its end jumps back
+    u32 Instructions() const;
+};
+
+/// <summary>
+/// Number of guest instructions a node retired. A fused loop (see Fuse) skips its own jump when it leaves the loop, so
+/// it retires one instruction less if it left the program counter behind the sequence.
+/// </summary>
+/// <param name="node"> The executed node</param>
+/// <param name="pc"> Program counter after executing the node</param>
+inline u32 Retired(const Node& node, u16 pc)
+{
+    const bool loop = node.instruction.op == Op::OP_7xkk3xkk1nnn || node.instruction.op == Op::OP_Fx073xkk1nnn;
+    return loop && pc == node.address + 6 ? node.ticks - 1u : node.ticks;
+}
+
+/// <summary>
+/// Decode the block starting at the given address. It ends after a jump, call, return, skip, key wait or memory
+/// write, or when it holds the given number of instructions.
+/// </summary>
+Block Build(const memory_t& memory, u16 address, u32 maxInstructions);
+
+/// <summary>
+/// Replace instructions that compute VF by variants that don't, if VF is overwritten before it is read
+/// </summary>
+void EliminateDeadFlags(Block& block);
+
+/// <summary>
+/// Fold registers and I loaded with constants (6xkk, Annn) into the instructions that use them
+/// </summary>
+void PropagateConstants(Block& block);
+
+/// <summary>
+/// Drop loads of I (Annn, Fx29) that are overwritten before they are used
+/// </summary>
+void RemoveRedundantIndexLoads(Block& block);
+
+/// <summary>
+/// Replace common sequences by superinstructions: Annn; Dxyn, the counted loop 7xkk; 3xkk; 1nnn and the delay timer
+/// wait Fx07; 3xkk; 1nnn. The other passes don't know the fused instructions, so this runs after Optimize. A loop
+/// absorbs the jump behind the block, which is read from memory.
+/// </summary>
+void Fuse(Block& block, const memory_t& memory);
+
+/// <summary>
+/// Run all passes and fold the removed instructions into the ticks of their neighbours
+/// </summary>
+void Optimize(Block& block);
+}  // namespace chip8::ir
@@ -0,0 +1,104 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "emulator.h"
+
+namespace chip8
+{
+/// <summary>
+/// Translates basic blocks of CHIP-8 code into native x86-64 code. Available on Linux x86-64 when building with
+/// CHIP8_JIT.
+///
+/// A block ends at a jump, call, return or skip instruction. Instructions without a native translation (for example
+/// Dxyn and Fx0A) end the block as well and are executed by the interpreter of the attached Chip8. The timers end up
+/// exactly where Chip8::Cycle would have left them after each instruction.
+///
+/// Blocks are built and optimised by the IR (see ir.h) before they are translated, so the native code only matches the
+/// interpreter at block boundaries.
+/// </summary>
+class Jit
+{
+public:
+    explicit Jit(Chip8& chip8);
+
+    ~Jit();
+
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    /// <summary>
+    /// Execute the block starting at the program counter, or a single instruction through the interpreter
+    /// </summary>
+    /// <returns> Number of executed instructions</returns>
+    u32 Step();
+
+    /// <summary>
+    /// Execute at least the given number of instructions
+    /// </summary>
+    /// <returns> Number of executed instructions</returns>
+    u64 Run(u64 instructions);
+
+    /// <summary>
+    /// Drop every block that translated code from the given memory range. Has to be called after writing to memory
+    /// from outside of the instruction handlers.
+    /// </summary>
+    /// <param name="address"> First address that was written</param>
+    /// <param name="size"> Number of bytes that were written</param>
+    void Invalidate(u32 address, u32 size);
+
+    /// <summary>
+    /// Drop every block, for example after loading a new ROM
+    /// </summary>
+    void InvalidateAll();
+
+    /// Upper bound for the number of instructions in one block
+    constexpr static u32 MAX_BLOCK_INSTRUCTIONS = 64;
+
+    /// Number of blocks built for translation so far, including the ones that turned out to have no translation
+    u64 compilations{};
+
+private:
+    using Block = u32 (*)(Chip8*);
+
+    Block Compile(u16 address);
+
+    Chip8& chip8;
+
+    /// Translated block for every start address, nullptr if there is none yet
+    std::vector<Block> blocks;
+
+    /// First address behind the code translated into each block
+    std::vector<u32> blockEnds;
+
+    /// Start addresses whose first instruction has no translation, so they go straight to the interpreter until the
+    /// instruction is overwritten
+    std::vector<bool> untranslated;
+
+    u8* code{};
+    size_t codeSize{};
+    size_t codeUsed{};
+};
+}  // namespace chip8
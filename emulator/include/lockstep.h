@@ -0,0 +1,124 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "emulator.h"
+#include "quirks.h"
+
+namespace chip8
+{
+/// <summary>
+/// How well the lanes of a Lockstep engine stayed together
+/// </summary>
+struct LockstepStats
+{
+    /// Instructions executed for a group of lanes at once
+    u64 steps{};
+    /// Instructions executed per lane, summed over the lanes
+    u64 laneInstructions{};
+    /// Lane instructions that went through the scalar switch engine
+    u64 scalarInstructions{};
+};
+
+/// <summary>
+/// Runs up to LANES machines in lockstep. Registers, pc, I, sp, the stack and the timers are stored lane by lane, so
+/// the lanes that are at the same pc execute the instruction together with SSE2. Memory, framebuffer, keypad and
+/// random generator stay in a Chip8 per lane, which also executes the instructions without a vector version.
+///
+/// Every step executes the lanes with the lowest pc, so lanes that fell behind catch up and rejoin the others at the
+/// next common address. Lanes whose code differs at that address, because one of them wrote to it, are split further.
+/// The result of every lane is the same as running it alone with a Scheduler.
+/// </summary>
+template <typename Quirks = quirks::Legacy>
+class Lockstep
+{
+public:
+    constexpr static u32 LANES = 16;
+
+    Lockstep();
+
+    /// <summary>
+    /// Copy a machine into a lane and enable it. Its variant is ignored, all lanes run with the quirks of the engine.
+    /// </summary>
+    void Load(u32 lane, const Chip8& chip8);
+
+    /// <summary>
+    /// Copy of the machine in a lane
+    /// </summary>
+    Chip8 Lane(u32 lane) const;
+
+    /// <summary>
+    /// Keys of a lane, which can be changed between frames
+    /// </summary>
+    keypad_t& Keypad(u32 lane) { return machines[lane].keypad; }
+
+    /// <summary>
+    /// Execute the given number of instructions in every enabled lane, then tick the timers
+    /// </summary>
+    void RunFrame(u32 instructionsPerFrame);
+
+    void RunFrames(u64 frames, u32 instructionsPerFrame);
+
+    LockstepStats stats;
+
+private:
+    /// Executes the budget in every lane without ticking the timers
+    void Run(u16 budget);
+
+    void Execute(u32 group, Instruction instruction);
+
+    /// Execute an instruction on one lane with the switch engine
+    void ExecuteScalar(u32 lane, Instruction instruction);
+
+    u16 Fetch(u32 lane, u16 address) const;
+
+    /// Mark the code at these addresses as possibly different between the lanes
+    void MarkWritten(u32 address, u32 size);
+
+    alignas(16) std::array<std::array<u8, LANES>, 16> registers{};
+    alignas(16) std::array<std::array<u16, LANES>, 16> stack{};
+    alignas(16) std::array<u16, LANES> pc{};
+    alignas(16) std::array<u16, LANES> index{};
+    alignas(16) std::array<u16, LANES> remaining{};
+    alignas(16) std::array<u8, LANES> sp{};
+    alignas(16) std::array<u8, LANES> delayTimer{};
+    alignas(16) std::array<u8, LANES> soundTimer{};
+
+    std::vector<Chip8> machines;
+
+    /// Bit per enabled lane
+    u32 enabled{};
+
+    /// Blocks of memory that hold the same bytes in every enabled lane, so an instruction is fetched only once
+    std::vector<bool> shared;
+};
+
+// Instantiated once in lockstep.cpp
+extern template class Lockstep<quirks::Legacy>;
+extern template class Lockstep<quirks::Chip8>;
+extern template class Lockstep<quirks::SuperChip>;
+extern template class Lockstep<quirks::XoChip>;
+}  // namespace chip8
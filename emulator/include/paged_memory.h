@@ -0,0 +1,130 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+#include "emulator.h"
+
+namespace chip8
+{
+/// <summary>
+/// Bytes kept as reference counted pages of MEMORY_PAGE_SIZE bytes. Copies share the table of pages, so copying is a
+/// single pointer copy. The first write to a copy gives it its own table. A page that is shared is copied before it's
+/// written, a page that isn't is written in place. Not thread safe for copies of one instance that are written
+/// concurrently.
+/// </summary>
+template <u32 PAGES>
+class PagedBytes
+{
+public:
+    using page_t = std::array<u8, MEMORY_PAGE_SIZE>;
+    using bytes_t = std::span<const u8, PAGES * MEMORY_PAGE_SIZE>;
+
+    explicit PagedBytes(bytes_t bytes);
+
+    /// <summary>
+    /// Share the pages that are equal to the ones of base, such as the font and the ROM of machines that loaded the
+    /// same ROM
+    /// </summary>
+    PagedBytes(bytes_t bytes, const PagedBytes& base);
+
+    void CopyTo(std::span<u8, PAGES * MEMORY_PAGE_SIZE> bytes) const;
+
+    /// <summary>
+    /// Take over the marked pages of bytes. Pages whose contents didn't change stay shared.
+    /// </summary>
+    void Update(bytes_t bytes, const std::bitset<PAGES>& written);
+
+    u8 Read(u32 address) const { return (*(*table)[address / MEMORY_PAGE_SIZE])[address % MEMORY_PAGE_SIZE]; }
+
+    void Write(u32 address, u8 value);
+
+    /// Whether both use the same copy of the page
+    bool Shares(const PagedBytes& other, u32 page) const { return (*table)[page] == (*other.table)[page]; }
+
+private:
+    using table_t = std::array<std::shared_ptr<page_t>, PAGES>;
+
+    /// Page to be written, copied first if it or the table is shared
+    page_t& Writable(u32 page);
+
+    std::shared_ptr<table_t> table;
+};
+
+using PagedMemory = PagedBytes<MEMORY_PAGES>;
+
+/// <summary>
+/// Machine parked outside of a Chip8, with its memory and its four framebuffers paged. To run it, it is loaded into a
+/// Chip8 and saved back afterwards, which only looks at the memory pages that Fx33, Fx55 and 5xy2 wrote and at the
+/// framebuffers of the display modes that were drawn to in between.
+///
+/// Only the registers and the other small fields in front of the framebuffers are held by value, so copying a
+/// PagedMachine to fork it copies those two cache lines and the pointers to two page tables. The engines only run on
+/// the flat memory of a Chip8, so this is a storage form for parked machines, not an execution backend.
+/// </summary>
+class PagedMachine
+{
+public:
+    /// The framebuffers lie between the small fields and memory in MachineState
+    constexpr static u32 VIDEO_OFFSET = offsetof(MachineState, video);
+    constexpr static u32 VIDEO_SIZE = offsetof(MachineState, memory) - VIDEO_OFFSET;
+    constexpr static u32 VIDEO_PAGES = VIDEO_SIZE / MEMORY_PAGE_SIZE;
+
+    static_assert(VIDEO_SIZE % MEMORY_PAGE_SIZE == 0, "The framebuffers must fill whole pages");
+
+    using PagedVideo = PagedBytes<VIDEO_PAGES>;
+
+    explicit PagedMachine(const MachineState& state);
+
+    /// <summary>
+    /// Share the pages that are equal to the ones of base, see PagedBytes
+    /// </summary>
+    PagedMachine(const MachineState& state, const PagedMachine& base);
+
+    /// <summary>
+    /// Replace the state of the machine, like Chip8::Restore, and start tracking the pages it writes
+    /// </summary>
+    void LoadInto(Chip8& chip8) const;
+
+    /// <summary>
+    /// Take the state of a machine this was loaded into, keeping the pages it didn't write
+    /// </summary>
+    void SaveFrom(const Chip8& chip8);
+
+    const PagedMemory& Memory() const { return memory; }
+
+    /// Pages of the framebuffers, starting with video at VIDEO_OFFSET
+    const PagedVideo& Video() const { return video; }
+
+private:
+    /// Everything in front of the framebuffers. Copied with every fork.
+    alignas(MachineState) std::array<u8, VIDEO_OFFSET> head;
+    PagedVideo video;
+    PagedMemory memory;
+};
+}  // namespace chip8
@@ -31,7 +31,14 @@ namespace chip8
 class Platform
 {
 public:
-    Platform(char const* title, int windowWidth, int windowHeight, int textureWidth, int textureHeight, int cycleTime);
+    /// With vsync, Update blocks until the display shows the frame
+    Platform(char const* title,
+             int windowWidth,
+             int windowHeight,
+             int textureWidth,
+             int textureHeight,
+             int cycleTime,
+             bool vsync = false);
 
     ~Platform();
 
@@ -39,6 +46,9 @@ public:
 
     bool ProcessInput(uint8_t* keys);
 
+    /// Whether the rewind hotkey (Backspace) is held down
+    bool RewindHeld() const { return rewindHeld; }
+
     void SoundOutput(bool on);
 
 private:
@@ -49,6 +59,7 @@ private:
     std::thread beepThread;
     std::atomic<bool> beeping{false};
     std::atomic<bool> close{false};
+    bool rewindHeld{false};
 };
 
 }  // namespace chip8
\ No newline at end of file
@@ -0,0 +1,47 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <vector>
+
+#include "emulator.h"
+
+namespace chip8
+{
+/// Instruction words of a program, as hand-written fixtures for tests and benchmarks
+using program_t = std::vector<u16>;
+
+/// <summary>
+/// Copy a program into memory at the start address, the same place LoadRom puts a ROM
+/// </summary>
+inline void LoadProgram(Chip8& chip8, const program_t& program)
+{
+    u32 address = Chip8::START_ADDRESS;
+
+    for (u16 instruction : program)
+    {
+        chip8.memory[address++] = instruction >> 8u;
+        chip8.memory[address++] = instruction & 0xFFu;
+    }
+}
+}  // namespace chip8
@@ -0,0 +1,119 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "types.h"
+
+namespace chip8
+{
+/// <summary>
+/// Platforms whose behaviour differs in the details listed by the policies in chip8::quirks
+/// </summary>
+enum class Variant : u8
+{
+    /// The behaviour this emulator always had, which is the default
+    Legacy,
+    /// The original COSMAC VIP interpreter
+    Chip8,
+    /// SUPER-CHIP 1.1 on the HP 48
+    SuperChip,
+    /// XO-CHIP
+    XoChip,
+};
+
+/// <summary>
+/// What happens to sprite pixels drawn past the edge of the screen
+/// </summary>
+enum class SpriteEdge : u8
+{
+    /// Continue on the next row, and past the last row on the first one, as if the screen were one long line
+    Linear,
+    /// Drop them
+    Clip,
+    /// Wrap around to the opposite edge of the same row or column
+    Wrap,
+};
+
+namespace quirks
+{
+/// <summary>
+/// Quirk policies. They are passed as template parameter to the instruction kernels and to chip8::Core, so every
+/// variant compiles to its own code without runtime checks.
+///
+/// SHIFT_USES_VY: 8xy6 and 8xyE shift Vy into Vx instead of shifting Vx in place.
+/// LOAD_STORE_INCREMENTS_INDEX: Fx55 and Fx65 leave I behind the last register they transferred.
+/// JUMP_USES_VX: Bnnn jumps to nnn + Vx, where x is the top nibble of nnn, instead of nnn + V0.
+/// LOGIC_RESETS_VF: 8xy1, 8xy2 and 8xy3 set VF to 0.
+/// SPRITE_EDGE: see SpriteEdge.
+/// SKIPS_LONG_LOAD: the skip instructions skip both words of F000 nnnn.
+/// LARGE_SPRITES: Dxy0 draws a 16x16 sprite instead of nothing.
+/// </summary>
+struct Legacy
+{
+    constexpr static Variant VARIANT = Variant::Legacy;
+    constexpr static bool SHIFT_USES_VY = false;
+    constexpr static bool LOAD_STORE_INCREMENTS_INDEX = false;
+    constexpr static bool JUMP_USES_VX = false;
+    constexpr static bool LOGIC_RESETS_VF = false;
+    constexpr static SpriteEdge SPRITE_EDGE = SpriteEdge::Linear;
+    constexpr static bool SKIPS_LONG_LOAD = false;
+    constexpr static bool LARGE_SPRITES = false;
+};
+
+struct Chip8
+{
+    constexpr static Variant VARIANT = Variant::Chip8;
+    constexpr static bool SHIFT_USES_VY = true;
+    constexpr static bool LOAD_STORE_INCREMENTS_INDEX = true;
+    constexpr static bool JUMP_USES_VX = false;
+    constexpr static bool LOGIC_RESETS_VF = true;
+    constexpr static SpriteEdge SPRITE_EDGE = SpriteEdge::Clip;
+    constexpr static bool SKIPS_LONG_LOAD = false;
+    constexpr static bool LARGE_SPRITES = false;
+};
+
+struct SuperChip
+{
+    constexpr static Variant VARIANT = Variant::SuperChip;
+    constexpr static bool SHIFT_USES_VY = false;
+    constexpr static bool LOAD_STORE_INCREMENTS_INDEX = false;
+    constexpr static bool JUMP_USES_VX = true;
+    constexpr static bool LOGIC_RESETS_VF = false;
+    constexpr static SpriteEdge SPRITE_EDGE = SpriteEdge::Clip;
+    constexpr static bool SKIPS_LONG_LOAD = false;
+    constexpr static bool LARGE_SPRITES = true;
+};
+
+struct XoChip
+{
+    constexpr static Variant VARIANT = Variant::XoChip;
+    constexpr static bool SHIFT_USES_VY = true;
+    constexpr static bool LOAD_STORE_INCREMENTS_INDEX = true;
+    constexpr static bool JUMP_USES_VX = false;
+    constexpr static bool LOGIC_RESETS_VF = false;
+    constexpr static SpriteEdge SPRITE_EDGE = SpriteEdge::Wrap;
+    constexpr static bool SKIPS_LONG_LOAD = true;
+    constexpr static bool LARGE_SPRITES = true;
+};
+}  // namespace quirks
+}  // namespace chip8
@@ -0,0 +1,91 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "emulator.h"
+
+namespace chip8
+{
+/// <summary>
+/// Frame history for rewinding, kept in a ring buffer of fixed size. Only the newest state is stored in full, every
+/// older frame as the XOR of its state with the next one, run-length encoded by 64 bit words. Memory and video barely
+/// change between frames, so a delta is usually a few dozen bytes. XOR undoes itself, so stepping back applies a single
+/// delta to the newest state and costs the same however long the history is. The oldest frames are dropped once the
+/// buffer is full.
+/// </summary>
+class Rewind
+{
+public:
+    /// Enough for a minute of most programs at 60 frames per second
+    constexpr static std::size_t DEFAULT_CAPACITY = std::size_t{1} << 20;
+
+    explicit Rewind(std::size_t capacity = DEFAULT_CAPACITY);
+
+    /// <summary>
+    /// Add the state of the next frame. After StepBack it replaces the frames that were stepped over.
+    /// </summary>
+    void Record(const MachineState& state);
+
+    /// <summary>
+    /// Go back to the frame recorded before the newest one, which is dropped
+    /// </summary>
+    /// <param name="state"> Receives the state of that frame</param>
+    /// <returns> False, leaving state unchanged, if no older frame is left</returns>
+    bool StepBack(MachineState& state);
+
+    /// <summary>
+    /// Forget every frame
+    /// </summary>
+    void Clear();
+
+    /// Number of frames StepBack can go back
+    u64 Frames() const { return entries; }
+
+    /// Bytes of the ring buffer taken by deltas
+    std::size_t Used() const { return used; }
+
+private:
+    /// Length of the delta, stored before and after it so the ring can be walked from both ends
+    using size_field_t = u32;
+
+    void Write(std::size_t position, const u8* data, std::size_t size);
+    void Read(std::size_t position, u8* data, std::size_t size) const;
+    void DropOldest();
+
+    std::vector<u8> ring;
+    /// Where the next delta is written
+    std::size_t head{};
+    /// Start of the oldest delta
+    std::size_t tail{};
+    std::size_t used{};
+    u64 entries{};
+
+    std::unique_ptr<MachineState> newest;
+    bool hasNewest{};
+    std::vector<u8> scratch;
+};
+}  // namespace chip8
@@ -0,0 +1,203 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <utility>
+#include <vector>
+
+#include "emulator.h"
+#include "scheduler.h"
+
+namespace chip8
+{
+/// <summary>
+/// Coroutine run by a Runtime. It starts suspended and only runs once spawned.
+/// </summary>
+class Task
+{
+public:
+    struct promise_type
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task& operator=(Task&& other) noexcept;
+    ~Task();
+
+    bool Done() const { return handle.done(); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+
+    friend class Runtime;
+};
+
+/// <summary>
+/// Event a task waits on until the host signals it, such as new input
+/// </summary>
+struct InputEvent
+{
+    std::coroutine_handle<> waiter;
+    /// Signalled while nobody waited, the next wait returns at once
+    bool signalled{};
+};
+
+/// <summary>
+/// Single threaded scheduler for many tasks. Time advances in frames. A task waits for the next frame, for a number
+/// of frames, or for an InputEvent; only tasks that have something to do are resumed. Sleeping tasks are kept in a
+/// timer wheel with a slot per frame, so waking them costs nothing for the tasks that keep sleeping.
+/// </summary>
+class Runtime
+{
+public:
+    /// Slots of the timer wheel. Longer sleeps stay in their slot for more rounds.
+    constexpr static u32 WHEEL_SIZE = 256;
+
+    /// <summary>
+    /// Take ownership of a task and run it in the next frame
+    /// </summary>
+    void Spawn(Task task);
+
+    /// <summary>
+    /// Resume the tasks whose sleep ends in this frame, whose event was signalled, and the new ones, then advance to
+    /// the next frame
+    /// </summary>
+    void RunFrame();
+
+    /// <summary>
+    /// Wake the task that waits for the event in the next frame, or let its next wait return at once
+    /// </summary>
+    void Signal(InputEvent& event);
+
+    /// Current frame, starting at zero
+    u64 Frame() const { return frame; }
+
+    /// Number of times a task was resumed
+    u64 resumes{};
+
+    /// <summary>
+    /// Awaitable that resumes the task the given number of frames later, zero returns at once
+    /// </summary>
+    auto Sleep(u64 frames)
+    {
+        struct Awaiter
+        {
+            Runtime& runtime;
+            u64 frames;
+
+            bool await_ready() const { return frames == 0; }
+            void await_suspend(std::coroutine_handle<> handle) { runtime.Wake(handle, runtime.frame + frames); }
+            void await_resume() const {}
+        };
+
+        return Awaiter{*this, frames};
+    }
+
+    /// <summary>
+    /// Awaitable that resumes the task in the next frame
+    /// </summary>
+    auto NextFrame() { return Sleep(1); }
+
+    /// <summary>
+    /// Awaitable that resumes the task once the event is signalled
+    /// </summary>
+    auto Wait(InputEvent& event)
+    {
+        struct Awaiter
+        {
+            InputEvent& event;
+
+            bool await_ready() const { return event.signalled; }
+            void await_suspend(std::coroutine_handle<> handle) { event.waiter = handle; }
+            void await_resume() const { event.signalled = false; }
+        };
+
+        return Awaiter{event};
+    }
+
+private:
+    struct Timer
+    {
+        u64 frame;
+        std::coroutine_handle<> handle;
+    };
+
+    void Wake(std::coroutine_handle<> handle, u64 at);
+
+    u64 frame{};
+    std::vector<std::coroutine_handle<>> ready;
+    std::vector<std::coroutine_handle<>> running;
+    std::array<std::vector<Timer>, WHEEL_SIZE> wheel;
+    std::vector<Task> tasks;
+};
+
+/// <summary>
+/// Machine run as a task of a Runtime, one scheduler frame per runtime frame. Idle loops let the task sleep: until
+/// the delay timer releases a poll loop, or until the keys change while it waits in Fx0A or jumps to itself. The
+/// skipped frames are caught up in constant time when it wakes, so the machine ends up where running every frame
+/// would have left it.
+/// </summary>
+class Emulator
+{
+public:
+    Emulator(Runtime& runtime, const Chip8& machine,
+             u32 instructionsPerFrame = Scheduler::DEFAULT_INSTRUCTIONS_PER_FRAME);
+
+    Emulator(const Emulator&) = delete;
+    Emulator& operator=(const Emulator&) = delete;
+
+    /// <summary>
+    /// Keys for the frames from the next one on
+    /// </summary>
+    void SetKeys(const keypad_t& pressed);
+
+    /// <summary>
+    /// The task, to be spawned on the runtime once. The emulator has to outlive it.
+    /// </summary>
+    Task Run();
+
+    /// <summary>
+    /// Run the frames the machine skipped while its task sleeps, for hosts that read its state
+    /// </summary>
+    void CatchUp();
+
+    Chip8 chip8;
+    Scheduler scheduler;
+
+private:
+    Runtime& runtime;
+    InputEvent input;
+    keypad_t keys{};
+    /// Runtime frame in which the machine ran its first frame
+    u64 start{};
+};
+}  // namespace chip8
@@ -0,0 +1,97 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <string_view>
+
+#include "emulator.h"
+
+namespace chip8
+{
+/// <summary>
+/// Start of a save state file. The MachineState follows as it is laid out in memory, in native byte order, at an
+/// offset that keeps its alignment, so a mapped file can be used in place. A different version or state size means a
+/// different layout and the file is rejected.
+/// </summary>
+struct alignas(alignof(MachineState)) SaveStateHeader
+{
+    constexpr static std::array<char, 8> MAGIC{'C', 'H', 'I', 'P', '8', 'S', 'A', 'V'};
+    /// Has to be increased whenever MachineState changes
+    constexpr static u32 VERSION = 2;
+
+    std::array<char, 8> magic{MAGIC};
+    u32 version{VERSION};
+    u32 stateSize{sizeof(MachineState)};
+    Variant variant{};
+
+    /// <summary>
+    /// Whether the state that follows can be read by this build
+    /// </summary>
+    bool Valid() const { return magic == MAGIC && version == VERSION && stateSize == sizeof(MachineState); }
+};
+
+static_assert(std::is_trivially_copyable_v<SaveStateHeader>, "The header is written as it is in memory");
+
+/// <summary>
+/// Write the state and the variant of the machine to a file
+/// </summary>
+/// <returns> Whether the file was written completely</returns>
+bool SaveState(const Chip8& chip8, std::string_view filename);
+
+/// <summary>
+/// Restore the state and the variant of the machine from a file written by SaveState. The machine is left unchanged
+/// if the file can't be read or was written by an incompatible version.
+/// </summary>
+/// <returns> Whether the state was restored</returns>
+bool LoadState(Chip8& chip8, std::string_view filename);
+
+/// <summary>
+/// Save state file mapped read-only into memory, so the state can be inspected or restored without reading the file
+/// first. Falls back to reading the file where mapping isn't available.
+/// </summary>
+class MappedSaveState
+{
+public:
+    explicit MappedSaveState(std::string_view filename);
+    ~MappedSaveState();
+
+    MappedSaveState(const MappedSaveState&) = delete;
+    MappedSaveState& operator=(const MappedSaveState&) = delete;
+
+    /// <summary>
+    /// Whether the file could be mapped and holds a state this build can read
+    /// </summary>
+    bool Valid() const { return header != nullptr; }
+
+    /// Only valid if Valid()
+    Variant GetVariant() const { return header->variant; }
+    /// Only valid if Valid()
+    const MachineState& State() const { return *reinterpret_cast<const MachineState*>(header + 1); }
+
+private:
+    const SaveStateHeader* header{};
+    void* mapping{};
+    std::size_t size{};
+};
+}  // namespace chip8
@@ -0,0 +1,110 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <limits>
+
+#include "emulator.h"
+
+namespace chip8
+{
+/// <summary>
+/// Runs a machine in frames of emulated time. A frame executes a fixed budget of instructions and then ticks the delay
+/// and sound timers once, so the timers run at exactly 60 Hz of emulated time no matter how many instructions a frame
+/// executes. The machine is switched to Timing::Frame for that.
+/// </summary>
+class Scheduler
+{
+public:
+    /// Rate of the delay and sound timers
+    constexpr static u32 FRAMES_PER_SECOND = 60;
+
+    /// Exact duration in frames, so emulated time doesn't drift from rounding 1/60 s to nanoseconds
+    using frames_t = std::chrono::duration<i64, std::ratio<1, FRAMES_PER_SECOND>>;
+
+    /// Emulated time covered by one frame
+    constexpr static frames_t FRAME_TIME{1};
+
+    /// About 700 instructions per second, a common speed for CHIP-8 programs
+    constexpr static u32 DEFAULT_INSTRUCTIONS_PER_FRAME = 12;
+
+    /// Returned by IdleFrames() for an idle loop that only input can end
+    constexpr static u64 IDLE_FOREVER = std::numeric_limits<u64>::max();
+
+    explicit Scheduler(Chip8& chip8, u32 instructionsPerFrame = DEFAULT_INSTRUCTIONS_PER_FRAME);
+
+    /// <summary>
+    /// Execute the instruction budget of one frame, or what RunUntil left of it, then tick the timers
+    /// </summary>
+    void RunFrame();
+
+    /// <summary>
+    /// Execute the rest of the current frame until one of the selected events happens, see Chip8::RunUntil. The next
+    /// call continues the frame where this one stopped.
+    /// </summary>
+    /// <param name="stopOn"> StopOn() of every reason to stop for</param>
+    /// <returns> StopReason::FrameEnd once the frame is complete and the timers were ticked</returns>
+    RunResult RunUntil(stop_mask_t stopOn);
+
+    /// <summary>
+    /// Execute the given number of frames. Frames spent entirely in an idle loop are skipped in constant time.
+    /// </summary>
+    void RunFrames(u64 count);
+
+    /// <summary>
+    /// Number of upcoming frames the machine spends entirely in an idle loop, assuming the keypad doesn't change. The
+    /// loops are a jump to itself, Fx0A without a pressed key, and polling the delay timer with `Fx07; 3xkk; 1nnn`.
+    /// </summary>
+    /// <returns> Number of frames, zero if the machine isn't idle or IDLE_FOREVER</returns>
+    u64 IdleFrames() const;
+
+    /// <summary>
+    /// Execute every frame that fits into the emulated time since the last call, for hosts driven by a real time
+    /// clock. The rest of the time is carried over to the next call.
+    /// </summary>
+    /// <param name="elapsed"> Time that passed since the last call</param>
+    /// <returns> Number of executed frames</returns>
+    u64 Advance(std::chrono::nanoseconds elapsed);
+
+    /// <summary>
+    /// Emulated time of all frames executed so far
+    /// </summary>
+    frames_t EmulatedTime() const { return frames_t(frames); }
+
+    /// Number of instructions executed by a frame, can be changed between frames
+    u32 instructionsPerFrame;
+
+    /// Number of frames executed so far
+    u64 frames{};
+
+    /// Skip idle frames instead of executing them, the resulting state is the same
+    bool fastForward{true};
+
+private:
+    Chip8& chip8;
+    /// Instructions of the current frame that RunUntil executed
+    u64 frameExecuted{};
+    std::common_type_t<std::chrono::nanoseconds, frames_t> pending{};
+};
+}  // namespace chip8
@@ -0,0 +1,44 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "emulator.h"
+
+namespace chip8::specialized
+{
+/// <summary>
+/// Handler with its register operands fixed at compile time. Only the remaining fields (kk, n, nnn) are taken from
+/// the opcode.
+/// </summary>
+using handler_t = void (*)(Chip8&, u16);
+
+/// <summary>
+/// Execute a raw instruction through the specialised handlers. Every handler that takes a register operand exists
+/// once per register (x-indexed groups) or per pair of registers (5xy0, 8xyN, 9xy0, Dxyn), so the register accesses
+/// compile to fixed offsets into Chip8::registers. The handler is picked by DECODE_TABLE, like in the other
+/// engines.
+/// </summary>
+/// <param name="chip8"> Machine to execute on, with the program counter already behind the instruction</param>
+/// <param name="opcode"> Raw 16 bit instruction</param>
+void Execute(Chip8& chip8, u16 opcode);
+}  // namespace chip8::specialized
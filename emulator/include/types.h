@@ -23,24 +23,53 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 
 namespace chip8
 {
 using u8 = uint8_t;
 using u16 = uint16_t;
 using u32 = uint32_t;
+using u64 = uint64_t;
 
 using i8 = int8_t;
 using i16 = int16_t;
 using i32 = int32_t;
+using i64 = int64_t;
 
 using register_set = std::array<u8, 16>;
-using memory_t = std::array<u8, 4096>;
+#ifdef CHIP8_XO_CHIP_MEMORY
+/// The 64 KB address space of XO-CHIP
+constexpr u32 MEMORY_SIZE = 0x10000;
+#else
+constexpr u32 MEMORY_SIZE = 0x1000;
+#endif
+
+static_assert((MEMORY_SIZE & (MEMORY_SIZE - 1)) == 0, "Addresses are wrapped with a mask");
+
+/// Granularity at which memory is shared between forked machines, see PagedMemory
+constexpr u32 MEMORY_PAGE_SIZE = 0x100;
+constexpr u32 MEMORY_PAGES = MEMORY_SIZE / MEMORY_PAGE_SIZE;
+
+using memory_t = std::array<u8, MEMORY_SIZE>;
 using stack_t = std::array<u16, 16>;
 using keypad_t = std::array<u8, 16>;
 
 constexpr u32 VIDEO_WIDTH = 64;
 constexpr u32 VIDEO_HEIGHT = 32;
 
-using video_mem_t = std::array<u32, VIDEO_WIDTH * VIDEO_HEIGHT>;
+/// One bit per pixel, one 64 bit word per row, see video.h
+using video_mem_t = std::array<u64, VIDEO_HEIGHT>;
+
+constexpr u32 HIRES_WIDTH = 128;
+constexpr u32 HIRES_HEIGHT = 64;
+
+/// Framebuffer of the SUPER-CHIP high resolution mode. Two words per row, the left half of the row comes first.
+using hires_video_t = std::array<u64, HIRES_WIDTH / 64 * HIRES_HEIGHT>;
+
+/// SUPER-CHIP flag registers (RPL user flags) written by Fx75 and read by Fx85
+using flag_registers_t = std::array<u8, 16>;
+
+/// XO-CHIP audio pattern, 128 one bit samples loaded by F002
+using audio_pattern_t = std::array<u8, 16>;
 }  // namespace chip8
\ No newline at end of file
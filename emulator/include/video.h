@@ -0,0 +1,132 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <array>
+
+#include "types.h"
+
+namespace chip8
+{
+/// Colour of a pixel that is on and off after expanding the framebuffer
+constexpr u32 PIXEL_ON = UINT32_MAX;
+constexpr u32 PIXEL_OFF = 0;
+
+/// Colours of the XO-CHIP pixels that are only set in the second bitplane, and in both bitplanes
+constexpr u32 PIXEL_SECOND_PLANE = 0x808080FF;
+constexpr u32 PIXEL_BOTH_PLANES = 0xC0C0C0FF;
+
+using rgba_buffer_t = std::array<u32, VIDEO_WIDTH * VIDEO_HEIGHT>;
+using hires_rgba_buffer_t = std::array<u32, HIRES_WIDTH * HIRES_HEIGHT>;
+
+struct MachineState;
+
+/// <summary>
+/// Bit of a pixel within its row of the packed framebuffer. The leftmost pixel is the most significant bit, the same
+/// order as the bits of a sprite byte.
+/// </summary>
+constexpr u64 PixelMask(u32 x)
+{
+    return u64{1} << (VIDEO_WIDTH - 1 - x);
+}
+
+constexpr bool Pixel(const video_mem_t& video, u32 x, u32 y)
+{
+    return (video[y] & PixelMask(x)) != 0;
+}
+
+constexpr bool Pixel(const hires_video_t& video, u32 x, u32 y)
+{
+    return (video[y * (HIRES_WIDTH / 64) + x / 64] & PixelMask(x % 64)) != 0;
+}
+
+/// <summary>
+/// Scroll the framebuffer by whole rows or by shifting every row, the pixels moved in are off. SUPER-CHIP scrolls by
+/// pixels of the current resolution.
+/// </summary>
+/// <param name="rows"> Number of rows to scroll down</param>
+void ScrollDown(video_mem_t& video, u32 rows);
+void ScrollDown(hires_video_t& video, u32 rows);
+
+/// <param name="rows"> Number of rows to scroll up</param>
+void ScrollUp(video_mem_t& video, u32 rows);
+void ScrollUp(hires_video_t& video, u32 rows);
+
+/// <param name="pixels"> Number of pixels to scroll right, less than 64</param>
+void ScrollRight(video_mem_t& video, u32 pixels);
+void ScrollRight(hires_video_t& video, u32 pixels);
+
+/// <param name="pixels"> Number of pixels to scroll left, less than 64</param>
+void ScrollLeft(video_mem_t& video, u32 pixels);
+void ScrollLeft(hires_video_t& video, u32 pixels);
+
+/// <summary>
+/// Expand the packed framebuffer to one u32 per pixel (PIXEL_ON or PIXEL_OFF), using AVX2 or SSE2 if the build
+/// targets them
+/// </summary>
+/// <param name="video"> Packed framebuffer</param>
+/// <param name="rgba"> Receives VIDEO_WIDTH * VIDEO_HEIGHT pixels</param>
+void ExpandToRgba(const video_mem_t& video, u32* rgba);
+
+/// <param name="video"> Packed high resolution framebuffer</param>
+/// <param name="rgba"> Receives HIRES_WIDTH * HIRES_HEIGHT pixels</param>
+void ExpandToRgba(const hires_video_t& video, u32* rgba);
+
+/// <summary>
+/// FNV-1a hash of what the display shows: the display mode and both bitplanes of its framebuffer. Machines that show
+/// the same picture have the same hash, whatever the framebuffer of the other mode contains.
+/// </summary>
+u64 FrameHash(const MachineState& state);
+
+/// <summary>
+/// RGBA copy of the display for the platform layer, which is only expanded again when the framebuffer changed. It
+/// always has the high resolution size, the low resolution framebuffer is drawn with 2x2 pixels. Pixels of the second
+/// XO-CHIP bitplane get the colours PIXEL_SECOND_PLANE and PIXEL_BOTH_PLANES.
+/// </summary>
+class RgbaFrame
+{
+public:
+    /// <summary>
+    /// Bring the RGBA pixels up to date with the framebuffer of the current display mode
+    /// </summary>
+    /// <returns> True if the display changed since the last call</returns>
+    bool Update(const MachineState& state);
+
+    const u32* Data() const { return pixels.data(); }
+
+    constexpr static int WIDTH = HIRES_WIDTH;
+    constexpr static int HEIGHT = HIRES_HEIGHT;
+
+    /// Bytes per row of Data()
+    constexpr static int PITCH = sizeof(u32) * WIDTH;
+
+private:
+    video_mem_t expanded{};
+    video_mem_t expanded2{};
+    hires_video_t expandedHires{};
+    hires_video_t expandedHires2{};
+    hires_rgba_buffer_t pixels{};
+    bool hires{};
+    bool valid{};
+};
+}  // namespace chip8
@@ -0,0 +1,569 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "aot.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+using namespace chip8;
+
+namespace
+{
+std::string Hex(u32 value, int digits)
+{
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "0x%0*X", digits, value);
+    return buffer;
+}
+
+std::string Label(u32 address)
+{
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "L_%03X", address);
+    return buffer;
+}
+
+/// <summary>
+/// Call of the handler in chip8::ops with the operands of the instruction
+/// </summary>
+std::string Call(Instruction instruction)
+{
+    const auto [op, x, y, n, kk, nnn] = instruction;
+
+    auto call = [](const char* handler, std::initializer_list<std::string> operands) {
+        std::string result = std::string("ops::") + handler + "(c";
+        for (const std::string& operand : operands)
+        {
+            result += ", " + operand;
+        }
+        return result + ");";
+    };
+
+    switch (op)
+    {
+        case Op::OP_00E0:
+            return call("OP_00E0", {});
+        case Op::OP_00EE:
+            return call("OP_00EE", {});
+        case Op::OP_1nnn:
+            return call("OP_1nnn", {Hex(nnn, 3)});
+        case Op::OP_2nnn:
+            return call("OP_2nnn", {Hex(nnn, 3)});
+        case Op::OP_3xkk:
+            return call("OP_3xkk", {Hex(x, 1), Hex(kk, 2)});
+        case Op::OP_4xkk:
+            return call("OP_4xkk", {Hex(x, 1), Hex(kk, 2)});
+        case Op::OP_5xy0:
+            return call("OP_5xy0", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_6xkk:
+            return call("OP_6xkk", {Hex(x, 1), Hex(kk, 2)});
+        case Op::OP_7xkk:
+            return call("OP_7xkk", {Hex(x, 1), Hex(kk, 2)});
+        case Op::OP_8xy0:
+            return call("OP_8xy0", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xy1:
+            return call("OP_8xy1", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xy2:
+            return call("OP_8xy2", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xy3:
+            return call("OP_8xy3", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xy4:
+            return call("OP_8xy4", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xy5:
+            return call("OP_8xy5", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xy6:
+            return call("OP_8xy6", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xy7:
+            return call("OP_8xy7", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xyE:
+            return call("OP_8xyE", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_9xy0:
+            return call("OP_9xy0", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_Annn:
+            return call("OP_Annn", {Hex(nnn, 3)});
+        case Op::OP_Bnnn:
+            return call("OP_Bnnn", {Hex(nnn, 3)});
+        case Op::OP_Cxkk:
+            return call("OP_Cxkk", {Hex(x, 1), Hex(kk, 2)});
+        case Op::OP_Dxyn:
+            return call("OP_Dxyn", {Hex(x, 1), Hex(y, 1), Hex(n, 1)});
+        case Op::OP_Ex9E:
+            return call("OP_Ex9E", {Hex(x, 1)});
+        case Op::OP_ExA1:
+            return call("OP_ExA1", {Hex(x, 1)});
+        case Op::OP_Fx07:
+            return call("OP_Fx07", {Hex(x, 1)});
+        case Op::OP_Fx0A:
+            return call("OP_Fx0A", {Hex(x, 1)});
+        case Op::OP_Fx15:
+            return call("OP_Fx15", {Hex(x, 1)});
+        case Op::OP_Fx18:
+            return call("OP_Fx18", {Hex(x, 1)});
+        case Op::OP_Fx1E:
+            return call("OP_Fx1E", {Hex(x, 1)});
+        case Op::OP_Fx29:
+            return call("OP_Fx29", {Hex(x, 1)});
+        case Op::OP_Fx33:
+            return call("OP_Fx33", {Hex(x, 1)});
+        case Op::OP_Fx55:
+            return call("OP_Fx55", {Hex(x, 1)});
+        case Op::OP_Fx65:
+            return call("OP_Fx65", {Hex(x, 1)});
+        case Op::OP_00Cn:
+            return call("OP_00Cn", {Hex(n, 1)});
+        case Op::OP_00FB:
+            return call("OP_00FB", {});
+        case Op::OP_00FC:
+            return call("OP_00FC", {});
+        case Op::OP_00FD:
+            return call("OP_00FD", {});
+        case Op::OP_00FE:
+            return call("OP_00FE", {});
+        case Op::OP_00FF:
+            return call("OP_00FF", {});
+        case Op::OP_Fx30:
+            return call("OP_Fx30", {Hex(x, 1)});
+        case Op::OP_Fx75:
+            return call("OP_Fx75", {Hex(x, 1)});
+        case Op::OP_Fx85:
+            return call("OP_Fx85", {Hex(x, 1)});
+        case Op::OP_00Dn:
+            return call("OP_00Dn", {Hex(n, 1)});
+        case Op::OP_5xy2:
+            return call("OP_5xy2", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_5xy3:
+            return call("OP_5xy3", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_F000:
+            return call("OP_F000", {});
+        case Op::OP_Fn01:
+            return call("OP_Fn01", {Hex(x, 1)});
+        case Op::OP_F002:
+            return call("OP_F002", {});
+        case Op::OP_Fx3A:
+            return call("OP_Fx3A", {Hex(x, 1)});
+        case Op::OP_8xy4_NF:
+            return call("OP_8xy4_NF", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xy5_NF:
+            return call("OP_8xy5_NF", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xy6_NF:
+            return call("OP_8xy6_NF", {Hex(x, 1)});
+        case Op::OP_8xy7_NF:
+            return call("OP_8xy7_NF", {Hex(x, 1), Hex(y, 1)});
+        case Op::OP_8xyE_NF:
+            return call("OP_8xyE_NF", {Hex(x, 1)});
+        case Op::OP_Dxyn_NF:
+            return call("OP_Dxyn_NF", {Hex(x, 1), Hex(y, 1), Hex(n, 1)});
+        case Op::OP_AnnnDxyn:
+            return call("OP_AnnnDxyn", {Hex(nnn, 3), Hex(x, 1), Hex(y, 1), Hex(n, 1)});
+        case Op::OP_AnnnDxyn_NF:
+            return call("OP_AnnnDxyn_NF", {Hex(nnn, 3), Hex(x, 1), Hex(y, 1), Hex(n, 1)});
+        case Op::OP_7xkk3xkk1nnn:
+            return call("OP_7xkk3xkk1nnn", {Hex(x, 1), Hex(kk, 2), Hex(y, 2), Hex(nnn, 3)});
+        case Op::OP_Fx073xkk1nnn:
+            return call("OP_Fx073xkk1nnn", {Hex(x, 1), Hex(kk, 2), Hex(nnn, 3)});
+        case Op::OP_NOP:
+        case Op::OP_UNDECODED:
+            break;
+    }
+
+    return "";
+}
+
+bool IsSkip(Op op)
+{
+    return op == Op::OP_3xkk || op == Op::OP_4xkk || op == Op::OP_5xy0 || op == Op::OP_9xy0 || op == Op::OP_Ex9E ||
+           op == Op::OP_ExA1;
+}
+
+/// <summary>
+/// Addresses of all instructions that can be reached from the start address without executing data
+/// </summary>
+std::bitset<MEMORY_SIZE> FindReachable(const memory_t& memory, u32 romEnd)
+{
+    std::bitset<MEMORY_SIZE> reachable;
+    std::vector<u32> pending{Chip8::START_ADDRESS};
+
+    while (!pending.empty())
+    {
+        u32 address = pending.back();
+        pending.pop_back();
+
+        // Code outside of the ROM is left to the interpreter
+        if (address < Chip8::START_ADDRESS || address + 1 >= romEnd || reachable[address])
+        {
+            continue;
+        }
+
+        reachable[address] = true;
+
+        const Instruction instruction = DECODE_TABLE[(memory[address] << 8u) | memory[address + 1]];
+
+        switch (instruction.op)
+        {
+            case Op::OP_1nnn:
+                pending.push_back(instruction.nnn);
+                break;
+            case Op::OP_2nnn:
+                pending.push_back(instruction.nnn);
+                pending.push_back(address + 2);
+                break;
+            case Op::OP_00EE:
+            case Op::OP_Bnnn:
+                // Dynamic targets are resolved at run time through the dispatcher
+                break;
+            case Op::OP_F000:
+                // The second word is the address
+                pending.push_back(address + 4);
+                break;
+            default:
+                if (IsSkip(instruction.op))
+                {
+                    pending.push_back(address + 4);
+                }
+                pending.push_back(address + 2);
+                break;
+        }
+    }
+
+    return reachable;
+}
+
+/// <summary>
+/// Whether the translation of the instruction may continue with the one behind it without going through a jump
+/// </summary>
+bool FallsThrough(Op op)
+{
+    return op != Op::OP_1nnn && op != Op::OP_2nnn && op != Op::OP_00EE && op != Op::OP_Bnnn && op != Op::OP_F000;
+}
+
+/// <summary>
+/// Addresses that translated code jumps to, other than the instruction behind the jumping one
+/// </summary>
+std::bitset<MEMORY_SIZE> FindTargets(const memory_t& memory, const std::bitset<MEMORY_SIZE>& reachable, u32 romEnd)
+{
+    std::bitset<MEMORY_SIZE> targets;
+
+    for (u32 address = Chip8::START_ADDRESS; address < romEnd; ++address)
+    {
+        if (!reachable[address])
+        {
+            continue;
+        }
+
+        const Instruction instruction = DECODE_TABLE[(memory[address] << 8u) | memory[address + 1]];
+
+        if (instruction.op == Op::OP_1nnn || instruction.op == Op::OP_2nnn)
+        {
+            targets[instruction.nnn] = true;
+        }
+        else if (IsSkip(instruction.op) || instruction.op == Op::OP_F000)
+        {
+            targets[(address + 4) % MEMORY_SIZE] = true;
+        }
+    }
+
+    return targets;
+}
+}  // namespace
+
+aot::Runner::Runner(const Program& program, Chip8& chip8) :
+    program(program), chip8(chip8), modified(program.blockCount)
+{
+    Check(program.codeBegin, program.codeEnd - program.codeBegin);
+}
+
+u64 aot::Runner::Run(u64 instructions)
+{
+    u64 executed = 0;
+
+    while (executed < instructions)
+    {
+        // Without modified blocks the translated code can skip its checks
+        const u8* blocks = modifiedBlocks > 0 ? modified.data() : nullptr;
+        const u64 translated = program.run(chip8, instructions - executed, blocks);
+
+        if (translated > 0)
+        {
+            executed += translated;
+
+            // The translated code returns right after writing to itself, with I still pointing at what it wrote
+            Check(chip8.index, 16);
+        }
+        else
+        {
+            const Instruction instruction =
+                DECODE_TABLE[(chip8.memory[chip8.pc] << 8) | chip8.memory[(chip8.pc + 1) % MEMORY_SIZE]];
+            const u16 index = chip8.index;
+
+            chip8.Cycle();
+            ++executed;
+            ++interpreted;
+
+            // Interpreted code can reach memory writes too, at most 16 bytes from I
+            if (instruction.op == Op::OP_Fx33 || instruction.op == Op::OP_Fx55 || instruction.op == Op::OP_5xy2)
+            {
+                Check(index, 16);
+            }
+        }
+    }
+
+    return executed;
+}
+
+bool aot::Runner::Translated(u16 address) const
+{
+    for (u32 block = 0; block < program.blockCount; ++block)
+    {
+        if (address >= program.blockBegin[block] && address < program.blockEnd[block] &&
+            (address - program.blockBegin[block]) % 2 == 0)
+        {
+            return modified[block] == 0;
+        }
+    }
+
+    return false;
+}
+
+void aot::Runner::Check(u32 address, u32 size)
+{
+    for (u32 block = 0; block < program.blockCount; ++block)
+    {
+        const u32 begin = program.blockBegin[block];
+        const u32 end = program.blockEnd[block];
+
+        if (begin >= address + size || end <= address)
+        {
+            continue;
+        }
+
+        const u8* image = program.image + (begin - Chip8::START_ADDRESS);
+        const bool differs = !std::equal(chip8.memory.begin() + begin, chip8.memory.begin() + end, image);
+
+        if (differs != (modified[block] != 0))
+        {
+            modified[block] = differs ? 1 : 0;
+            modifiedBlocks = differs ? modifiedBlocks + 1 : modifiedBlocks - 1;
+        }
+    }
+}
+
+std::string aot::Translate(const memory_t& memory, u32 romSize, std::string_view name)
+{
+    const u32 romEnd = std::min<u32>(Chip8::START_ADDRESS + romSize, memory.size());
+    const std::bitset<MEMORY_SIZE> reachable = FindReachable(memory, romEnd);
+
+    u32 codeBegin = romEnd;
+    u32 codeEnd = Chip8::START_ADDRESS;
+
+    for (u32 address = Chip8::START_ADDRESS; address < romEnd; ++address)
+    {
+        if (reachable[address])
+        {
+            codeBegin = std::min(codeBegin, address);
+            codeEnd = std::max(codeEnd, address + 2);
+        }
+    }
+
+    codeBegin = std::min(codeBegin, codeEnd);
+
+    // A block starts at every instruction that isn't only reached from the one in front of it. Its first instruction
+    // and the dispatcher check that the block wasn't modified, so the rest of it runs without checks.
+    const std::bitset<MEMORY_SIZE> targets = FindTargets(memory, reachable, romEnd);
+    std::vector<u32> blockOf(romEnd);
+    std::vector<u32> blockBegin;
+    std::vector<u32> blockEnd;
+    std::bitset<MEMORY_SIZE> leaders;
+
+    for (u32 address = Chip8::START_ADDRESS; address < romEnd; ++address)
+    {
+        if (!reachable[address])
+        {
+            continue;
+        }
+
+        const u32 previous = address - 2;
+        const bool continues = reachable[previous] && !targets[address] &&
+                               FallsThrough(DECODE_TABLE[(memory[previous] << 8u) | memory[previous + 1]].op);
+
+        if (continues)
+        {
+            blockOf[address] = blockOf[previous];
+            blockEnd[blockOf[address]] = address + 2;
+        }
+        else
+        {
+            leaders[address] = true;
+            blockOf[address] = static_cast<u32>(blockBegin.size());
+            blockBegin.push_back(address);
+            blockEnd.push_back(address + 2);
+        }
+    }
+
+    auto blockTable = [](const std::vector<u32>& addresses) {
+        std::string table;
+        for (size_t i = 0; i < addresses.size(); ++i)
+        {
+            table += (i % 8 == 0 ? "\n    " : " ") + Hex(addresses[i], 3) + ",";
+        }
+        return (addresses.empty() ? std::string("0") : table) + "\n";
+    };
+
+    auto check = [&](u32 address, const char* indent) {
+        return std::string(indent) + "if (modified && modified[" + std::to_string(blockOf[address]) + "])\n" + indent +
+               "    return executed;\n";
+    };
+
+    auto jump = [&](u32 address) {
+        return address < reachable.size() && reachable[address] ? "goto " + Label(address) + ";"
+                                                                 : std::string("goto dispatch;");
+    };
+
+    std::ostringstream out;
+
+    out << "// Generated by chip8_aot, do not edit\n\n";
+    out << "#include \"aot.h\"\n";
+    out << "#include \"instructions.h\"\n\n";
+    out << "namespace\n{\n";
+    out << "using namespace chip8;\n\n";
+    out << "constexpr u16 CODE_BEGIN = " << Hex(codeBegin, 3) << ";\n";
+    out << "constexpr u16 CODE_END = " << Hex(codeEnd, 3) << ";\n\n";
+
+    out << "const u8 IMAGE[] = {";
+    for (u32 address = Chip8::START_ADDRESS; address < romEnd; ++address)
+    {
+        out << ((address - Chip8::START_ADDRESS) % 16 == 0 ? "\n    " : " ") << Hex(memory[address], 2) << ",";
+    }
+    out << (romEnd == Chip8::START_ADDRESS ? "0" : "") << "\n};\n\n";
+
+    out << "constexpr u32 BLOCK_COUNT = " << blockBegin.size() << ";\n";
+    out << "const u16 BLOCK_BEGIN[] = {" << blockTable(blockBegin) << "};\n";
+    out << "const u16 BLOCK_END[] = {" << blockTable(blockEnd) << "};\n\n";
+
+    out << "[[maybe_unused]] bool WritesCode(const Chip8& c, u32 size)\n{\n";
+    out << "    return c.index < CODE_END && c.index + size > CODE_BEGIN;\n}\n\n";
+
+    out << "u64 Run(Chip8& c, u64 budget, [[maybe_unused]] const u8* modified)\n{\n";
+    out << "    u64 executed = 0;\n";
+    out << "    goto dispatch;\n\n";
+
+    for (u32 address = Chip8::START_ADDRESS; address < romEnd; ++address)
+    {
+        if (!reachable[address])
+        {
+            continue;
+        }
+
+        const u16 opcode = (memory[address] << 8u) | memory[address + 1];
+        const Instruction instruction = DECODE_TABLE[opcode];
+        const u32 next = address + 2;
+
+        out << Label(address) << ":  // " << Hex(opcode, 4) << "\n";
+        if (leaders[address])
+        {
+            out << check(address, "    ");
+        }
+        out << "    c.pc = " << Hex(next, 3) << ";\n";
+
+        if (std::string call = Call(instruction); !call.empty())
+        {
+            out << "    " << call << "\n";
+        }
+
+        out << "    c.TickTimers();\n";
+        out << "    ++executed;\n";
+
+        switch (instruction.op)
+        {
+            case Op::OP_1nnn:
+            case Op::OP_2nnn:
+                // Jumps may form loops, give the host a chance to run
+                out << "    if (executed >= budget)\n        return executed;\n";
+                out << "    " << jump(instruction.nnn) << "\n";
+                break;
+            case Op::OP_00EE:
+            case Op::OP_Bnnn:
+                out << "    goto dispatch;\n";
+                break;
+            case Op::OP_Fx0A:
+            case Op::OP_00FD:
+                out << "    if (c.pc == " << Hex(address, 3) << ")\n        return executed;\n";
+                out << "    " << jump(next) << "\n";
+                break;
+            case Op::OP_Fx33:
+                out << "    if (WritesCode(c, 3))\n        return executed;\n";
+                out << "    " << jump(next) << "\n";
+                break;
+            case Op::OP_Fx55:
+                out << "    if (WritesCode(c, " << instruction.x + 1 << "))\n        return executed;\n";
+                out << "    " << jump(next) << "\n";
+                break;
+            case Op::OP_5xy2: {
+                const u32 count = std::max(instruction.x, instruction.y) - std::min(instruction.x, instruction.y) + 1;
+                out << "    if (WritesCode(c, " << count << "))\n        return executed;\n";
+                out << "    " << jump(next) << "\n";
+                break;
+            }
+            case Op::OP_F000:
+                out << "    " << jump(next + 2) << "\n";
+                break;
+            default:
+                if (IsSkip(instruction.op))
+                {
+                    out << "    if (c.pc != " << Hex(next, 3) << ")\n        " << jump(next + 2) << "\n";
+                }
+                out << "    " << jump(next) << "\n";
+                break;
+        }
+
+        out << "\n";
+    }
+
+    out << "dispatch:\n";
+    out << "    if (executed >= budget)\n        return executed;\n\n";
+    out << "    switch (c.pc)\n    {\n";
+    for (u32 address = Chip8::START_ADDRESS; address < romEnd; ++address)
+    {
+        if (reachable[address])
+        {
+            out << "        case " << Hex(address, 3) << ":\n";
+            if (!leaders[address])
+            {
+                out << check(address, "            ");
+            }
+            out << "            goto " << Label(address) << ";\n";
+        }
+    }
+    out << "        default:\n            return executed;\n    }\n}\n";
+    out << "}  // namespace\n\n";
+
+    out << "namespace chip8::aot\n{\n";
+    out << "extern const Program " << name << ";\n\n";
+    out << "const Program " << name << "{\"" << name << "\", &Run, IMAGE, sizeof(IMAGE), CODE_BEGIN, CODE_END,\n";
+    out << "    BLOCK_BEGIN, BLOCK_END, BLOCK_COUNT};\n";
+    out << "}  // namespace chip8::aot\n";
+
+    return out.str();
+}
@@ -0,0 +1,66 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "aot.h"
+#include "emulator.h"
+
+using namespace chip8;
+
+int main(int argc, char* argv[])
+{
+    if (argc != 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <ROM> <Name> <Output>\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    char const* romFilename = argv[1];
+    char const* name = argv[2];
+    char const* outputFilename = argv[3];
+
+    std::error_code error;
+    auto romSize = std::filesystem::file_size(romFilename, error);
+
+    if (error)
+    {
+        std::cerr << "Can't read " << romFilename << ": " << error.message() << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    Chip8 chip8;
+    chip8.LoadRom(romFilename);
+
+    std::ofstream output(outputFilename);
+    output << aot::Translate(chip8.memory, static_cast<u32>(romSize), name);
+
+    if (!output)
+    {
+        std::cerr << "Can't write " << outputFilename << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    return 0;
+}
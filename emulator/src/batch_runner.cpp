@@ -0,0 +1,198 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "batch_runner.h"
+
+#include <algorithm>
+
+using namespace chip8;
+
+BatchRunner::BatchRunner(u32 threads)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (u32 i = 0; i < threads; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    // Only start them once the vector is complete, since they steal from each other
+    for (u32 i = 0; i < threads; ++i)
+    {
+        workers[i]->thread = std::thread(&BatchRunner::Work, this, i);
+    }
+}
+
+BatchRunner::~BatchRunner()
+{
+    stop = true;
+    ++generation;
+    generation.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker->thread.join();
+    }
+}
+
+u32 BatchRunner::Add(const Chip8& chip8, u32 instructionsPerFrame)
+{
+    instances.push_back(std::make_unique<Instance>(chip8, instructionsPerFrame));
+    return Size() - 1;
+}
+
+void BatchRunner::RunFrames(u64 frames)
+{
+    if (frames == 0 || instances.empty())
+    {
+        return;
+    }
+
+    // Neighbouring instances start on different workers, stealing evens out the rest
+    for (u32 i = 0; i < Size(); ++i)
+    {
+        instances[i]->remaining = frames;
+
+        Worker& worker = *workers[i % Threads()];
+        std::lock_guard lock(worker.mutex);
+        worker.tasks.push_back(i);
+    }
+
+    pending = Size();
+    ++generation;
+    generation.notify_all();
+
+    for (u32 left = pending; left > 0; left = pending)
+    {
+        pending.wait(left);
+    }
+}
+
+std::vector<WorkerStats> BatchRunner::Stats() const
+{
+    std::vector<WorkerStats> stats;
+
+    for (const auto& worker : workers)
+    {
+        stats.push_back(worker->stats);
+    }
+
+    return stats;
+}
+
+void BatchRunner::ResetStats()
+{
+    for (auto& worker : workers)
+    {
+        worker->stats = {};
+    }
+}
+
+bool BatchRunner::Pop(u32 index, u32& task, bool& stolen)
+{
+    {
+        Worker& own = *workers[index];
+        std::lock_guard lock(own.mutex);
+
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            stolen = false;
+            return true;
+        }
+    }
+
+    for (u32 i = 1; i < Threads(); ++i)
+    {
+        Worker& victim = *workers[(index + i) % Threads()];
+        std::lock_guard lock(victim.mutex);
+
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            stolen = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void BatchRunner::Work(u32 index)
+{
+    Worker& worker = *workers[index];
+    u64 seen = 0;
+
+    while (true)
+    {
+        generation.wait(seen);
+        seen = generation;
+
+        if (stop)
+        {
+            return;
+        }
+
+        while (pending > 0)
+        {
+            u32 task;
+            bool stolen;
+
+            if (!Pop(index, task, stolen))
+            {
+                // The last chunks are still running on other workers
+                std::this_thread::yield();
+                continue;
+            }
+
+            Instance& instance = *instances[task];
+            const u64 frames = std::min(framesPerTask, instance.remaining);
+
+            const auto begin = std::chrono::steady_clock::now();
+            instance.scheduler.RunFrames(frames);
+            worker.stats.busy += std::chrono::steady_clock::now() - begin;
+
+            ++worker.stats.tasks;
+            worker.stats.steals += stolen;
+            worker.stats.frames += frames;
+            worker.stats.instructions += frames * instance.scheduler.instructionsPerFrame;
+
+            instance.remaining -= frames;
+
+            if (instance.remaining > 0)
+            {
+                // Stays with this worker while its state is in the cache, unless another one steals it
+                std::lock_guard lock(worker.mutex);
+                worker.tasks.push_back(task);
+            }
+            else if (--pending == 0)
+            {
+                pending.notify_all();
+            }
+        }
+    }
+}
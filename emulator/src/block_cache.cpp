@@ -0,0 +1,123 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "block_cache.h"
+
+#include <algorithm>
+
+using namespace chip8;
+
+BlockCache::BlockCache(Chip8& chip8) : chip8(chip8), blocks(chip8.memory.size())
+{
+}
+
+u32 BlockCache::Step()
+{
+    const u16 pc = chip8.pc;
+
+    if (pc + 1u >= chip8.memory.size())
+    {
+        chip8.Cycle();
+        ++dispatches;
+        return 1;
+    }
+
+    std::unique_ptr<ir::Block>& block = blocks[pc];
+
+    if (!block)
+    {
+        block = std::make_unique<ir::Block>(ir::Build(chip8.memory, pc, MAX_BLOCK_INSTRUCTIONS));
+        ir::Optimize(*block);
+
+        if (superinstructions)
+        {
+            ir::Fuse(*block, chip8.memory);
+        }
+    }
+
+    const Instruction last = block->nodes.back().instruction;
+    u32 executed = 0;
+
+    for (const ir::Node& node : block->nodes)
+    {
+        chip8.pc = node.address + 2;
+        chip8.Execute(node.instruction);
+
+        const u32 retired = ir::Retired(node, chip8.pc);
+        chip8.TickTimers(retired);
+        executed += retired;
+    }
+
+    dispatches += block->nodes.size();
+
+    if (last.op == Op::OP_Fx33)
+    {
+        Invalidate(chip8.index, 3);
+    }
+    else if (last.op == Op::OP_Fx55)
+    {
+        Invalidate(chip8.index, last.x + 1);
+    }
+    else if (last.op == Op::OP_5xy2)
+    {
+        Invalidate(chip8.index, std::max(last.x, last.y) - std::min(last.x, last.y) + 1);
+    }
+
+    return executed;
+}
+
+u64 BlockCache::Run(u64 instructions)
+{
+    u64 executed = 0;
+
+    while (executed < instructions)
+    {
+        executed += Step();
+    }
+
+    return executed;
+}
+
+void BlockCache::Invalidate(u32 address, u32 size)
+{
+    // A block covers at most MAX_BLOCK_INSTRUCTIONS instructions in front of the range, plus the jump that ir::Fuse
+    // absorbs behind them
+    const u32 reach = MAX_BLOCK_INSTRUCTIONS * 2 + 2;
+    u32 begin = address > reach ? address - reach : 0;
+    u32 end = std::min<u32>(address + size, blocks.size());
+
+    for (u32 start = begin; start < end; ++start)
+    {
+        if (blocks[start] && blocks[start]->end > address)
+        {
+            blocks[start].reset();
+        }
+    }
+}
+
+void BlockCache::InvalidateAll()
+{
+    for (auto& block : blocks)
+    {
+        block.reset();
+    }
+}
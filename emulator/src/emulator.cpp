@@ -23,18 +23,52 @@
 #include "emulator.h"
 
 #include <chrono>
+#include <cstring>
+
+#include "core.h"
+#include "instructions.h"
+#include "specialized.h"
 
 using namespace chip8;
 
-Chip8::Chip8() : randomGenerator(std::chrono::system_clock::now().time_since_epoch().count())
+namespace
 {
-    auto it = memory.begin();
-    std::advance(it, FONTSET_START_ADDRESS);
-    std::copy(fontset.begin(), fontset.end(), it);
+/// Power-on state every instance starts from
+constexpr MachineState PRISTINE = [] {
+    MachineState state{};
+    std::copy(fontset.begin(), fontset.end(), state.memory.begin() + MachineState::FONTSET_START_ADDRESS);
+    std::copy(bigFontset.begin(), bigFontset.end(), state.memory.begin() + MachineState::BIG_FONTSET_START_ADDRESS);
+    return state;
+}();
+}  // namespace
 
+Chip8::Chip8()
+    : MachineState(PRISTINE), randomGenerator(std::chrono::system_clock::now().time_since_epoch().count())
+{
     randomByte = std::uniform_int_distribution<unsigned int>(0, 255);
+}
+
+void Chip8::Reset()
+{
+    std::memcpy(static_cast<MachineState*>(this), &PRISTINE, sizeof(MachineState));
+    opcode = 0;
+
+    InvalidateDecodeCache();
+}
+
+void Chip8::Reset(u32 seed)
+{
+    Reset();
 
-    InitInstructionTable();
+    randomGenerator.seed(seed);
+    randomByte.reset();
+}
+
+void Chip8::Restore(const MachineState& state)
+{
+    std::memcpy(static_cast<MachineState*>(this), &state, sizeof(MachineState));
+
+    InvalidateDecodeCache();
 }
 
 void Chip8::LoadRom(std::string_view filename)
@@ -50,355 +84,291 @@ void Chip8::LoadRom(std::string_view filename)
     file.seekg(0, std::ios::beg);
     file.read(reinterpret_cast<char*>(&memory[START_ADDRESS]), size);
     file.close();
+
+    InvalidateDecodeCache();
+}
+
+void Chip8::InvalidateDecodeCache()
+{
+    writtenPages.set();
+    loresWritten = true;
+    hiresWritten = true;
+#ifdef CHIP8_STATE_HASH
+    hashedPages.reset();
+    loresHashed = false;
+    hiresHashed = false;
+#endif
+
+    if (!decodeCache.empty())
+    {
+        std::fill(decodeCache.begin(), decodeCache.end(), Instruction{Op::OP_UNDECODED});
+    }
 }
 
 void Chip8::OP_00E0()
 {
-    std::fill(video.begin(), video.end(), 0);
+    ops::OP_00E0(*this);
 }
 
 void Chip8::OP_00EE()
 {
-    pc = stack[--sp];
+    ops::OP_00EE(*this);
 }
 
+#define GET_VX (opcode & 0x0F00u) >> 8u
+#define GET_VY (opcode & 0x00F0u) >> 4u
+#define GET_N opcode & 0x000Fu
+#define GET_KK opcode & 0x00FFu
+#define GET_NNN opcode & 0x0FFFu
+
 void Chip8::OP_1nnn()
 {
-    pc = opcode & 0x0FFFu;
+    ops::OP_1nnn(*this, GET_NNN);
 }
 
 void Chip8::OP_2nnn()
 {
-    u16 address = opcode & 0x0FFFu;
-    stack[sp++] = pc;
-    pc = address;
+    ops::OP_2nnn(*this, GET_NNN);
 }
 
-#define GET_VX (opcode & 0x0F00u) >> 8u
-#define GET_VY (opcode & 0x00F0u) >> 4u
-
 void Chip8::OP_3xkk()
 {
-    u8 vx = GET_VX;
-    u8 byte = opcode & 0x00FFu;
-
-    if (registers[vx] == byte)
-    {
-        pc += 2;
-    }
+    ops::OP_3xkk(*this, GET_VX, GET_KK);
 }
 
 void Chip8::OP_4xkk()
 {
-    u8 vx = GET_VX;
-    u8 byte = opcode & 0x00FFu;
-
-    if (registers[vx] != byte)
-    {
-        pc += 2;
-    }
+    ops::OP_4xkk(*this, GET_VX, GET_KK);
 }
 
 void Chip8::OP_5xy0()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-
-    if (registers[vx] == registers[vy])
-    {
-        pc += 2;
-    }
+    ops::OP_5xy0(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_6xkk()
 {
-    u8 vx = GET_VX;
-    u8 byte = opcode & 0x00FFu;
-
-    registers[vx] = byte;
+    ops::OP_6xkk(*this, GET_VX, GET_KK);
 }
 
 void Chip8::OP_7xkk()
 {
-    u8 vx = (opcode & 0xF00u) >> 8u;
-    u8 byte = opcode & 0x00FFu;
-
-    registers[vx] += byte;
+    ops::OP_7xkk(*this, GET_VX, GET_KK);
 }
 
 void Chip8::OP_8xy0()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-
-    registers[vx] = registers[vy];
+    ops::OP_8xy0(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_8xy1()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-
-    registers[vx] |= registers[vy];
+    ops::OP_8xy1(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_8xy2()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-
-    registers[vx] &= registers[vy];
+    ops::OP_8xy2(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_8xy3()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-
-    registers[vx] ^= registers[vy];
+    ops::OP_8xy3(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_8xy4()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-
-    u16 sum = registers[vx] + registers[vy];
-
-    if (sum >= 256U)
-    {
-        registers[0xF] = 1;
-    }
-    else
-    {
-        registers[0xF] = 0;
-    }
-
-    registers[vx] = sum & 0xFFu;
+    ops::OP_8xy4(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_8xy5()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-
-    if (registers[vx] > registers[vy])
-    {
-        registers[0xF] = 1u;
-    }
-    else
-    {
-        registers[0xF] = 0;
-    }
-
-    registers[vx] -= registers[vy];
+    ops::OP_8xy5(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_8xy6()
 {
-    u8 vx = GET_VX;
-
-    registers[0xF] = (registers[vx] & 0x01u);
-    registers[vx] >>= 1;
+    ops::OP_8xy6(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_8xy7()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-
-    if (registers[vy] > registers[vx])
-    {
-        registers[0xF] = 1u;
-    }
-    else
-    {
-        registers[0xF] = 0;
-    }
-
-    registers[vx] = registers[vy] - registers[vx];
+    ops::OP_8xy7(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_8xyE()
 {
-    u8 vx = GET_VX;
-
-    registers[0xF] = (registers[vx] & 0x80u) >> 7u;
-    registers[vx] <<= 1;
+    ops::OP_8xyE(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_9xy0()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-
-    if (registers[vx] != registers[vy])
-    {
-        pc += 2;
-    }
+    ops::OP_9xy0(*this, GET_VX, GET_VY);
 }
 
 void Chip8::OP_Annn()
 {
-    index = opcode & 0x0FFFu;
+    ops::OP_Annn(*this, GET_NNN);
 }
 
 void Chip8::OP_Bnnn()
 {
-    u16 address = opcode & 0x0FFFu;
-    pc = registers[0] + address;
+    ops::OP_Bnnn(*this, GET_NNN);
 }
 
 void Chip8::OP_Cxkk()
 {
-    u8 vx = GET_VX;
-    u8 byte = opcode & 0x00FFu;
-
-    registers[vx] = randomByte(randomGenerator) & byte;
+    ops::OP_Cxkk(*this, GET_VX, GET_KK);
 }
 
 void Chip8::OP_Dxyn()
 {
-    u8 vx = GET_VX;
-    u8 vy = GET_VY;
-    u8 height = opcode & 0x000Fu;
+    ops::OP_Dxyn(*this, GET_VX, GET_VY, GET_N);
+}
 
-    u8 xPos = registers[vx] % VIDEO_WIDTH;
-    u8 yPos = registers[vy] % VIDEO_HEIGHT;
+void chip8::Chip8::OP_Ex9E()
+{
+    ops::OP_Ex9E(*this, GET_VX);
+}
 
-    registers[0xF] = 0;
+void chip8::Chip8::OP_ExA1()
+{
+    ops::OP_ExA1(*this, GET_VX);
+}
 
-    for (size_t row = 0; row < height; row++)
-    {
-        u8 spriteByte = memory[index + row];
+void chip8::Chip8::OP_Fx07()
+{
+    ops::OP_Fx07(*this, GET_VX);
+}
 
-        for (size_t col = 0; col < 8; col++)
-        {
-            u32 index = (yPos + row) * VIDEO_WIDTH + (xPos + col);
-            index %= (VIDEO_WIDTH * VIDEO_HEIGHT);
-            u8 spritePixel = spriteByte & (0x80 >> col);
-            auto* screenPixel = &video[index];
+void chip8::Chip8::OP_Fx0A()
+{
+    ops::OP_Fx0A(*this, GET_VX);
+}
 
-            if (spritePixel)
-            {
-                if (*screenPixel == UINT32_MAX)
-                {
-                    registers[0xF] = 1;
-                }
+void chip8::Chip8::OP_Fx15()
+{
+    ops::OP_Fx15(*this, GET_VX);
+}
 
-                *screenPixel ^= UINT32_MAX;
-            }
-        }
-    }
+void chip8::Chip8::OP_Fx18()
+{
+    ops::OP_Fx18(*this, GET_VX);
 }
 
-void chip8::Chip8::OP_Ex9E()
+void chip8::Chip8::OP_Fx1E()
 {
-    u8 vx = GET_VX;
-    u8 key = registers[vx];
+    ops::OP_Fx1E(*this, GET_VX);
+}
 
-    if (keypad[key])
-    {
-        pc += 2;
-    }
+void chip8::Chip8::OP_Fx29()
+{
+    ops::OP_Fx29(*this, GET_VX);
 }
 
-void chip8::Chip8::OP_ExA1()
+void chip8::Chip8::OP_Fx33()
 {
-    u8 vx = GET_VX;
-    u8 key = registers[vx];
+    ops::OP_Fx33(*this, GET_VX);
+}
 
-    if (!keypad[key])
-    {
-        pc += 2;
-    }
+void chip8::Chip8::OP_Fx55()
+{
+    ops::OP_Fx55(*this, GET_VX);
 }
 
-void chip8::Chip8::OP_Fx07()
+void chip8::Chip8::OP_Fx65()
 {
-    u8 vx = GET_VX;
-    registers[vx] = delayTimer;
+    ops::OP_Fx65(*this, GET_VX);
 }
 
-void chip8::Chip8::OP_Fx0A()
+void chip8::Chip8::OP_00Cn()
 {
-    u8 vx = GET_VX;
+    ops::OP_00Cn(*this, GET_N);
+}
 
-    for (u8 i = 0; i < keypad.size(); ++i)
-    {
-        if (keypad[i])
-        {
-            registers[vx] = i;
-            return;
-        }
-    }
+void chip8::Chip8::OP_00FB()
+{
+    ops::OP_00FB(*this);
+}
 
-    pc -= 2;
+void chip8::Chip8::OP_00FC()
+{
+    ops::OP_00FC(*this);
 }
 
-void chip8::Chip8::OP_Fx15()
+void chip8::Chip8::OP_00FD()
 {
-    u8 vx = GET_VX;
-    delayTimer = registers[vx];
+    ops::OP_00FD(*this);
 }
 
-void chip8::Chip8::OP_Fx18()
+void chip8::Chip8::OP_00FE()
 {
-    u8 vx = GET_VX;
-    soundTimer = registers[vx];
+    ops::OP_00FE(*this);
 }
 
-void chip8::Chip8::OP_Fx1E()
+void chip8::Chip8::OP_00FF()
 {
-    u8 vx = GET_VX;
-    index += registers[vx];
+    ops::OP_00FF(*this);
 }
 
-void chip8::Chip8::OP_Fx29()
+void chip8::Chip8::OP_Fx30()
 {
-    u8 vx = GET_VX;
-    u8 digit = registers[vx];
+    ops::OP_Fx30(*this, GET_VX);
+}
 
-    index = FONTSET_START_ADDRESS + (5 * digit);
+void chip8::Chip8::OP_Fx75()
+{
+    ops::OP_Fx75(*this, GET_VX);
 }
 
-void chip8::Chip8::OP_Fx33()
+void chip8::Chip8::OP_Fx85()
 {
-    u8 vx = GET_VX;
-    u8 value = registers[vx];
+    ops::OP_Fx85(*this, GET_VX);
+}
 
-    memory[index + 2] = value % 10;
-    value /= 10;
+void chip8::Chip8::OP_00Dn()
+{
+    ops::OP_00Dn(*this, GET_N);
+}
 
-    memory[index + 1] = value % 10;
-    value /= 10;
+void chip8::Chip8::OP_5xy2()
+{
+    ops::OP_5xy2(*this, GET_VX, GET_VY);
+}
 
-    memory[index] = value % 10;
+void chip8::Chip8::OP_5xy3()
+{
+    ops::OP_5xy3(*this, GET_VX, GET_VY);
 }
 
-void chip8::Chip8::OP_Fx55()
+void chip8::Chip8::OP_F000()
 {
-    u8 vx = GET_VX;
+    ops::OP_F000(*this);
+}
 
-    for (u8 i = 0; i <= vx; ++i)
-    {
-        memory[index + i] = registers[i];
-    }
+void chip8::Chip8::OP_Fn01()
+{
+    ops::OP_Fn01(*this, GET_VX);
 }
 
-void chip8::Chip8::OP_Fx65()
+void chip8::Chip8::OP_F002()
 {
-    u8 vx = GET_VX;
+    ops::OP_F002(*this);
+}
 
-    for (u8 i = 0; i <= vx; ++i)
-    {
-        registers[i] = memory[index + i];
-    }
+void chip8::Chip8::OP_Fx3A()
+{
+    ops::OP_Fx3A(*this, GET_VX);
 }
 
 void chip8::Chip8::Table0()
 {
-    ((*this).*(table0[opcode & 0x000Fu]))();
+    ((*this).*(table0[opcode & 0x00FFu]))();
+}
+
+void chip8::Chip8::Table5()
+{
+    ((*this).*(table5[opcode & 0x000Fu]))();
 }
 
 void chip8::Chip8::Table8()
@@ -418,84 +388,225 @@ void chip8::Chip8::TableF()
 
 void chip8::Chip8::OP_NOP() {}
 
-void chip8::Chip8::InitInstructionTable()
-{
-    table[0x0] = &Chip8::Table0;
-    table[0x1] = &Chip8::OP_1nnn;
-    table[0x2] = &Chip8::OP_2nnn;
-    table[0x3] = &Chip8::OP_3xkk;
-    table[0x4] = &Chip8::OP_4xkk;
-    table[0x5] = &Chip8::OP_5xy0;
-    table[0x6] = &Chip8::OP_6xkk;
-    table[0x7] = &Chip8::OP_7xkk;
-    table[0x8] = &Chip8::Table8;
-    table[0x9] = &Chip8::OP_9xy0;
-    table[0xA] = &Chip8::OP_Annn;
-    table[0xB] = &Chip8::OP_Bnnn;
-    table[0xC] = &Chip8::OP_Cxkk;
-    table[0xD] = &Chip8::OP_Dxyn;
-    table[0xE] = &Chip8::TableE;
-    table[0xF] = &Chip8::TableF;
-
-    for (size_t i = 0; i <= 0xE; i++)
+namespace
+{
+using Chip8Func = Chip8::Chip8Func;
+
+template <size_t Size>
+constexpr std::array<Chip8Func, Size> NopTable()
+{
+    std::array<Chip8Func, Size> table{};
+    table.fill(&Chip8::OP_NOP);
+    return table;
+}
+}  // namespace
+
+constexpr std::array<Chip8Func, 0xF + 1> Chip8::table = {
+    &Chip8::Table0,
+    &Chip8::OP_1nnn,
+    &Chip8::OP_2nnn,
+    &Chip8::OP_3xkk,
+    &Chip8::OP_4xkk,
+    &Chip8::Table5,
+    &Chip8::OP_6xkk,
+    &Chip8::OP_7xkk,
+    &Chip8::Table8,
+    &Chip8::OP_9xy0,
+    &Chip8::OP_Annn,
+    &Chip8::OP_Bnnn,
+    &Chip8::OP_Cxkk,
+    &Chip8::OP_Dxyn,
+    &Chip8::TableE,
+    &Chip8::TableF,
+};
+
+constexpr std::array<Chip8Func, 0xFF + 1> Chip8::table0 = [] {
+    auto table = NopTable<0xFF + 1>();
+
+    // 00E0 and 00EE only look at the last nibble
+    for (u32 kk = 0; kk <= 0xF0u; kk += 0x10u)
     {
-        table0[i] = &Chip8::OP_NOP;
-        table8[i] = &Chip8::OP_NOP;
-        tableE[i] = &Chip8::OP_NOP;
+        table[kk] = &Chip8::OP_00E0;
+        table[kk + 0xE] = &Chip8::OP_00EE;
     }
 
-    table0[0x0] = &Chip8::OP_00E0;
-    table0[0xE] = &Chip8::OP_00EE;
+    for (u32 n = 0; n <= 0xFu; ++n)
+    {
+        table[0xC0 + n] = &Chip8::OP_00Cn;
+        table[0xD0 + n] = &Chip8::OP_00Dn;
+    }
 
-    table8[0x0] = &Chip8::OP_8xy0;
-    table8[0x1] = &Chip8::OP_8xy1;
-    table8[0x2] = &Chip8::OP_8xy2;
-    table8[0x3] = &Chip8::OP_8xy3;
-    table8[0x4] = &Chip8::OP_8xy4;
-    table8[0x5] = &Chip8::OP_8xy5;
-    table8[0x6] = &Chip8::OP_8xy6;
-    table8[0x7] = &Chip8::OP_8xy7;
-    table8[0xE] = &Chip8::OP_8xyE;
+    table[0xFB] = &Chip8::OP_00FB;
+    table[0xFC] = &Chip8::OP_00FC;
+    table[0xFD] = &Chip8::OP_00FD;
+    table[0xFE] = &Chip8::OP_00FE;
+    table[0xFF] = &Chip8::OP_00FF;
+    return table;
+}();
+
+constexpr std::array<Chip8Func, 0xF + 1> Chip8::table5 = [] {
+    // Like 00E0, 5xy0 does not care about the last nibble
+    std::array<Chip8Func, 0xF + 1> table{};
+    table.fill(&Chip8::OP_5xy0);
+    table[0x2] = &Chip8::OP_5xy2;
+    table[0x3] = &Chip8::OP_5xy3;
+    return table;
+}();
+
+constexpr std::array<Chip8Func, 0xF + 1> Chip8::table8 = [] {
+    auto table = NopTable<0xF + 1>();
+    table[0x0] = &Chip8::OP_8xy0;
+    table[0x1] = &Chip8::OP_8xy1;
+    table[0x2] = &Chip8::OP_8xy2;
+    table[0x3] = &Chip8::OP_8xy3;
+    table[0x4] = &Chip8::OP_8xy4;
+    table[0x5] = &Chip8::OP_8xy5;
+    table[0x6] = &Chip8::OP_8xy6;
+    table[0x7] = &Chip8::OP_8xy7;
+    table[0xE] = &Chip8::OP_8xyE;
+    return table;
+}();
+
+constexpr std::array<Chip8Func, 0xF + 1> Chip8::tableE = [] {
+    auto table = NopTable<0xF + 1>();
+    table[0x1] = &Chip8::OP_ExA1;
+    table[0xE] = &Chip8::OP_Ex9E;
+    return table;
+}();
+
+constexpr std::array<Chip8Func, 0xFF + 1> Chip8::tableF = [] {
+    auto table = NopTable<0xFF + 1>();
+    table[0x00] = &Chip8::OP_F000;
+    table[0x01] = &Chip8::OP_Fn01;
+    table[0x02] = &Chip8::OP_F002;
+    table[0x07] = &Chip8::OP_Fx07;
+    table[0x0A] = &Chip8::OP_Fx0A;
+    table[0x15] = &Chip8::OP_Fx15;
+    table[0x18] = &Chip8::OP_Fx18;
+    table[0x1E] = &Chip8::OP_Fx1E;
+    table[0x29] = &Chip8::OP_Fx29;
+    table[0x30] = &Chip8::OP_Fx30;
+    table[0x33] = &Chip8::OP_Fx33;
+    table[0x3A] = &Chip8::OP_Fx3A;
+    table[0x55] = &Chip8::OP_Fx55;
+    table[0x65] = &Chip8::OP_Fx65;
+    table[0x75] = &Chip8::OP_Fx75;
+    table[0x85] = &Chip8::OP_Fx85;
+    return table;
+}();
+
+void chip8::Chip8::Execute(Instruction instruction)
+{
+    Core<quirks::Legacy>::Execute(*this, instruction);
+}
+
+void chip8::Chip8::LoadRom(std::string_view filename, Variant romVariant)
+{
+    variant = romVariant;
+    LoadRom(filename);
+}
+
+u64 chip8::Chip8::Run(u64 cycles)
+{
+    switch (variant)
+    {
+        case Variant::Legacy:
+            for (u64 i = 0; i < cycles; ++i)
+            {
+                Cycle();
+            }
+            break;
+        case Variant::Chip8:
+            Core<quirks::Chip8>::Run(*this, cycles);
+            break;
+        case Variant::SuperChip:
+            Core<quirks::SuperChip>::Run(*this, cycles);
+            break;
+        case Variant::XoChip:
+            Core<quirks::XoChip>::Run(*this, cycles);
+            break;
+    }
 
-    tableE[0x1] = &Chip8::OP_ExA1;
-    tableE[0xE] = &Chip8::OP_Ex9E;
+    return cycles;
+}
 
-    for (size_t i = 0; i <= 0x65; i++)
+chip8::RunResult chip8::Chip8::RunFor(u64 instructions)
+{
+    return RunUntil(StopOn(StopReason::Breakpoint), instructions);
+}
+
+chip8::RunResult chip8::Chip8::RunUntil(stop_mask_t stopOn, u64 budget)
+{
+    switch (variant)
     {
-        tableF[i] = &Chip8::OP_NOP;
+        case Variant::Chip8:
+            return Core<quirks::Chip8>::RunUntil(*this, stopOn, budget);
+        case Variant::SuperChip:
+            return Core<quirks::SuperChip>::RunUntil(*this, stopOn, budget);
+        case Variant::XoChip:
+            return Core<quirks::XoChip>::RunUntil(*this, stopOn, budget);
+        case Variant::Legacy:
+            break;
     }
 
-    tableF[0x07] = &Chip8::OP_Fx07;
-    tableF[0x0A] = &Chip8::OP_Fx0A;
-    tableF[0x15] = &Chip8::OP_Fx15;
-    tableF[0x18] = &Chip8::OP_Fx18;
-    tableF[0x1E] = &Chip8::OP_Fx1E;
-    tableF[0x29] = &Chip8::OP_Fx29;
-    tableF[0x33] = &Chip8::OP_Fx33;
-    tableF[0x55] = &Chip8::OP_Fx55;
-    tableF[0x65] = &Chip8::OP_Fx65;
+    return Core<quirks::Legacy>::RunUntil(*this, stopOn, budget);
 }
 
 void chip8::Chip8::Cycle()
 {
-    // Fetch
-    opcode = (memory[pc] << 8u) | memory[pc + 1];
+    if (variant != Variant::Legacy)
+    {
+        // The other platforms always run on the switch engine specialised for their quirks
+        Run(1);
+        return;
+    }
 
-    // Increment the PC before we execute anything
-    pc += 2;
+    if (dispatch == Dispatch::Cached)
+    {
+        if (decodeCache.empty())
+        {
+            decodeCache.resize(memory.size(), Instruction{Op::OP_UNDECODED});
+        }
 
-    // Decode and Execute
-    ((*this).*(table[(opcode & 0xF000u) >> 12u]))();
+        // Fetch and decode only if the instruction isn't in the cache yet
+        Instruction& instruction = decodeCache[pc];
+
+        if (instruction.op == Op::OP_UNDECODED)
+        {
+            instruction = DECODE_TABLE[(memory[pc] << 8u) | memory[pc + 1]];
+        }
+
+        // Increment the PC before we execute anything
+        pc += 2;
 
-    // Decrement the delay timer if it's been set
-    if (delayTimer > 0)
+        Execute(instruction);
+    }
+    else
     {
-        --delayTimer;
+        // Fetch
+        u16 instruction = (memory[pc] << 8u) | memory[pc + 1];
+
+        // Increment the PC before we execute anything
+        pc += 2;
+
+        // Decode and Execute
+        if (dispatch == Dispatch::Switch)
+        {
+            Execute(DECODE_TABLE[instruction]);
+        }
+        else if (dispatch == Dispatch::Specialized)
+        {
+            specialized::Execute(*this, instruction);
+        }
+        else
+        {
+            opcode = instruction;
+            ((*this).*(table[(opcode & 0xF000u) >> 12u]))();
+        }
     }
 
-    // Decrement the sound timer if it's been set
-    if (soundTimer > 0)
+    if (timing == Timing::PerInstruction)
     {
-        --soundTimer;
+        TickTimers();
     }
 }
@@ -0,0 +1,148 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#if defined(__unix__)
+#include <cerrno>
+#include <ctime>
+#endif
+
+using namespace chip8;
+
+namespace
+{
+void SleepUntil(FramePacer::clock::time_point time)
+{
+#if defined(__unix__)
+    // steady_clock is CLOCK_MONOTONIC, an absolute sleep on it isn't extended by signals or a late start
+    const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    const timespec deadline{static_cast<time_t>(sinceEpoch / 1'000'000'000),
+                            static_cast<long>(sinceEpoch % 1'000'000'000)};
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+    {
+    }
+#else
+    std::this_thread::sleep_until(time);
+#endif
+}
+
+void WaitUntil(FramePacer::clock::time_point time)
+{
+    if (time - FramePacer::clock::now() > FramePacer::SPIN_TAIL)
+    {
+        SleepUntil(time - FramePacer::SPIN_TAIL);
+    }
+
+    while (FramePacer::clock::now() < time)
+    {
+    }
+}
+}  // namespace
+
+FramePacer::FramePacer(u32 framesPerSecond, Pacing pacing) :
+    framesPerSecond(framesPerSecond), pacing(pacing), epoch(clock::now())
+{
+}
+
+FramePacer::clock::time_point FramePacer::Deadline(u64 index) const
+{
+    // Computed from the frame number, so a period that isn't a whole number of nanoseconds doesn't drift
+    return epoch + std::chrono::nanoseconds(index * 1'000'000'000 / framesPerSecond);
+}
+
+void FramePacer::Wait()
+{
+    ++frame;
+
+    auto now = clock::now();
+
+    if (now - Deadline(frame) > Period())
+    {
+        ++missed;
+        epoch = now;
+        frame = 0;
+    }
+    else
+    {
+        WaitUntil(Deadline(frame));
+        now = clock::now();
+    }
+
+    if (frameStart != clock::time_point{})
+    {
+        const auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(now - frameStart);
+        const auto deviation = std::chrono::abs(interval - Period());
+        const double value = static_cast<double>(interval.count());
+
+        ++intervals;
+        sum += value;
+        sumOfSquares += value * value;
+        maxDeviation = std::max(maxDeviation, deviation);
+    }
+
+    frameStart = now;
+}
+
+void FramePacer::Presenting()
+{
+    presentStart = clock::now();
+}
+
+void FramePacer::FrameDone()
+{
+    if (pacing != Pacing::LowLatency || presentStart < frameStart)
+    {
+        return;
+    }
+
+    // A vsynced present blocks until the display takes the frame, which is time the frame could have spent waiting for
+    // input instead. Later deadlines shrink the wait, a wait below the margin moves them earlier again. Only part of
+    // the difference is applied, so a single slow frame doesn't throw the deadlines off. Moving the epoch keeps them
+    // continuous, and it follows a display refresh that drifts against the nominal period.
+    const auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - presentStart);
+    epoch += (wait - PresentMargin()) / 4;
+}
+
+FrameStats FramePacer::Stats() const
+{
+    FrameStats stats;
+    stats.frames = intervals;
+    stats.missed = missed;
+    stats.maxDeviation = maxDeviation;
+
+    if (intervals > 0)
+    {
+        const double mean = sum / static_cast<double>(intervals);
+        const double variance = std::max(0.0, sumOfSquares / static_cast<double>(intervals) - mean * mean);
+
+        stats.mean = std::chrono::nanoseconds(std::llround(mean));
+        stats.jitter = std::chrono::nanoseconds(std::llround(std::sqrt(variance)));
+    }
+
+    return stats;
+}
@@ -0,0 +1,258 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "emulator.h"
+#include "quirks.h"
+#include "scheduler.h"
+#include "video.h"
+
+using namespace chip8;
+
+namespace
+{
+/// <summary>
+/// Key press or release from an input script
+/// </summary>
+struct KeyEvent
+{
+    u64 frame;
+    u8 key;
+    u8 pressed;
+};
+
+[[noreturn]] void Usage(char const* program)
+{
+    std::cerr << "Usage: " << program << " <ROM> [--frames <N> | --instructions <N>] [--ipf <N>]\n"
+              << "       [--variant legacy|chip8|superchip|xochip] [--input <Script>] [--no-fast-forward]\n\n"
+              << "The input script has one event per line: <Frame> <Key (hex)> <1 to press, 0 to release>\n";
+    std::exit(EXIT_FAILURE);
+}
+
+Variant ParseVariant(std::string_view name)
+{
+    static const std::map<std::string_view, Variant> VARIANTS = {{"legacy", Variant::Legacy},
+                                                                 {"chip8", Variant::Chip8},
+                                                                 {"superchip", Variant::SuperChip},
+                                                                 {"xochip", Variant::XoChip}};
+
+    auto variant = VARIANTS.find(name);
+
+    if (variant == VARIANTS.end())
+    {
+        std::cerr << "Unknown variant " << name << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    return variant->second;
+}
+
+std::vector<KeyEvent> LoadInput(char const* filename)
+{
+    std::ifstream file(filename);
+
+    if (!file)
+    {
+        std::cerr << "Can't read " << filename << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<KeyEvent> events;
+    std::string line;
+
+    for (u32 number = 1; std::getline(file, line); ++number)
+    {
+        line = line.substr(0, line.find('#'));
+
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        u64 frame;
+        u32 key;
+        u32 pressed;
+
+        if (!(fields >> std::dec >> frame >> std::hex >> key >> std::dec >> pressed) || key > 0xF || pressed > 1)
+        {
+            std::cerr << filename << ":" << number << ": expected <Frame> <Key> <0|1>\n";
+            std::exit(EXIT_FAILURE);
+        }
+
+        events.push_back({frame, static_cast<u8>(key), static_cast<u8>(pressed)});
+    }
+
+    std::stable_sort(
+        events.begin(), events.end(), [](const KeyEvent& a, const KeyEvent& b) { return a.frame < b.frame; });
+
+    return events;
+}
+
+void PrintState(const Chip8& chip8)
+{
+    std::cout << std::hex << std::uppercase << std::setfill('0');
+    std::cout << "PC: " << std::setw(4) << chip8.pc << "  I: " << std::setw(4) << chip8.index
+              << "  SP: " << std::setw(2) << +chip8.sp << "  DT: " << std::setw(2) << +chip8.delayTimer
+              << "  ST: " << std::setw(2) << +chip8.soundTimer << "\n";
+
+    for (u32 i = 0; i < chip8.registers.size(); ++i)
+    {
+        std::cout << "V" << i << ": " << std::setw(2) << +chip8.registers[i] << (i % 8 == 7 ? "\n" : "  ");
+    }
+
+    std::cout << "Stack:";
+
+    for (u32 i = 0; i < chip8.sp; ++i)
+    {
+        std::cout << " " << std::setw(4) << chip8.stack[i];
+    }
+
+    std::cout << "\n" << std::dec << std::nouppercase << std::setfill(' ');
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        Usage(argv[0]);
+    }
+
+    char const* romFilename = argv[1];
+    u64 frames = 600;
+    u64 instructions = 0;
+    u32 instructionsPerFrame = Scheduler::DEFAULT_INSTRUCTIONS_PER_FRAME;
+    Variant variant = Variant::Legacy;
+    char const* inputFilename = nullptr;
+    bool fastForward = true;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string_view option = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (option == "--frames" && hasValue)
+        {
+            frames = std::stoull(argv[++i]);
+            instructions = 0;
+        }
+        else if (option == "--instructions" && hasValue)
+        {
+            instructions = std::stoull(argv[++i]);
+        }
+        else if (option == "--ipf" && hasValue)
+        {
+            instructionsPerFrame = static_cast<u32>(std::stoul(argv[++i]));
+        }
+        else if (option == "--variant" && hasValue)
+        {
+            variant = ParseVariant(argv[++i]);
+        }
+        else if (option == "--input" && hasValue)
+        {
+            inputFilename = argv[++i];
+        }
+        else if (option == "--no-fast-forward")
+        {
+            fastForward = false;
+        }
+        else
+        {
+            Usage(argv[0]);
+        }
+    }
+
+    if (instructionsPerFrame == 0)
+    {
+        Usage(argv[0]);
+    }
+
+    // An instruction count runs whole frames and then the instructions that are left, without ticking the timers
+    u64 remainder = 0;
+
+    if (instructions > 0)
+    {
+        frames = instructions / instructionsPerFrame;
+        remainder = instructions % instructionsPerFrame;
+    }
+
+    if (!std::filesystem::is_regular_file(romFilename))
+    {
+        std::cerr << "Can't read " << romFilename << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    const std::vector<KeyEvent> input = inputFilename ? LoadInput(inputFilename) : std::vector<KeyEvent>{};
+
+    Chip8 chip8;
+    chip8.LoadRom(romFilename, variant);
+
+    Scheduler scheduler(chip8, instructionsPerFrame);
+    scheduler.fastForward = fastForward;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Runs the frames between input events at once, so idle frames can be fast-forwarded
+    auto event = input.begin();
+
+    while (scheduler.frames < frames)
+    {
+        for (; event != input.end() && event->frame <= scheduler.frames; ++event)
+        {
+            chip8.keypad[event->key] = event->pressed;
+        }
+
+        const u64 next = event != input.end() ? std::min(event->frame, frames) : frames;
+        scheduler.RunFrames(next - scheduler.frames);
+    }
+
+    chip8.Run(remainder);
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const u64 executed = frames * instructionsPerFrame + remainder;
+    const double ips = static_cast<double>(executed) / elapsed.count();
+
+    std::cout << "Frames: " << scheduler.frames << "\n"
+              << "Instructions: " << executed << (fastForward ? " (idle frames fast-forwarded)" : "") << "\n"
+              << "Time: " << elapsed.count() << " s\n"
+              << "IPS: " << std::fixed << std::setprecision(0) << ips << "\n"
+              << "MIPS: " << std::setprecision(2) << ips / 1e6 << "\n"
+              << "Frame hash: " << std::hex << std::setw(16) << std::setfill('0') << FrameHash(chip8) << std::dec
+              << std::setfill(' ') << "\n";
+
+    PrintState(chip8);
+
+    return 0;
+}
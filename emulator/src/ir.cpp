@@ -0,0 +1,510 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "ir.h"
+
+#include <algorithm>
+#include <array>
+
+#include "emulator.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr u16 VF = 1u << 0xF;
+
+/// Mask of the registers V0 through Vx
+u16 RegistersUpTo(u8 x)
+{
+    return static_cast<u16>((2u << x) - 1);
+}
+
+/// Mask of the registers Vx through Vy, or Vy through Vx
+u16 RegisterRange(u8 x, u8 y)
+{
+    const u8 low = std::min(x, y);
+    return RegistersUpTo(std::max(x, y)) & ~static_cast<u16>((1u << low) - 1);
+}
+
+bool EndsBlock(Op op)
+{
+    switch (op)
+    {
+        case Op::OP_00EE:
+        case Op::OP_1nnn:
+        case Op::OP_2nnn:
+        case Op::OP_3xkk:
+        case Op::OP_4xkk:
+        case Op::OP_5xy0:
+        case Op::OP_9xy0:
+        case Op::OP_Bnnn:
+        case Op::OP_Ex9E:
+        case Op::OP_ExA1:
+        case Op::OP_Fx0A:
+        case Op::OP_Fx33:
+        case Op::OP_Fx55:
+        case Op::OP_00FD:
+        case Op::OP_5xy2:
+        case Op::OP_F000:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// Registers an instruction reads
+u16 Reads(Instruction instruction)
+{
+    const u16 vx = 1u << instruction.x;
+    const u16 vy = 1u << instruction.y;
+
+    switch (instruction.op)
+    {
+        case Op::OP_3xkk:
+        case Op::OP_4xkk:
+        case Op::OP_7xkk:
+        case Op::OP_8xy6:
+        case Op::OP_8xyE:
+        case Op::OP_8xy6_NF:
+        case Op::OP_8xyE_NF:
+        case Op::OP_Ex9E:
+        case Op::OP_ExA1:
+        case Op::OP_Fx15:
+        case Op::OP_Fx18:
+        case Op::OP_Fx1E:
+        case Op::OP_Fx29:
+        case Op::OP_Fx30:
+        case Op::OP_Fx33:
+            return vx;
+        case Op::OP_8xy0:
+            return vy;
+        case Op::OP_5xy0:
+        case Op::OP_8xy1:
+        case Op::OP_8xy2:
+        case Op::OP_8xy3:
+        case Op::OP_8xy4:
+        case Op::OP_8xy5:
+        case Op::OP_8xy7:
+        case Op::OP_8xy4_NF:
+        case Op::OP_8xy5_NF:
+        case Op::OP_8xy7_NF:
+        case Op::OP_9xy0:
+        case Op::OP_Dxyn:
+        case Op::OP_Dxyn_NF:
+            return vx | vy;
+        case Op::OP_Bnnn:
+            return 1u;
+        case Op::OP_Fx55:
+        case Op::OP_Fx75:
+            return RegistersUpTo(instruction.x);
+        case Op::OP_5xy2:
+            return RegisterRange(instruction.x, instruction.y);
+        default:
+            return 0;
+    }
+}
+
+/// Registers an instruction always writes
+u16 Writes(Instruction instruction)
+{
+    const u16 vx = 1u << instruction.x;
+
+    switch (instruction.op)
+    {
+        case Op::OP_6xkk:
+        case Op::OP_7xkk:
+        case Op::OP_8xy0:
+        case Op::OP_8xy1:
+        case Op::OP_8xy2:
+        case Op::OP_8xy3:
+        case Op::OP_8xy4_NF:
+        case Op::OP_8xy5_NF:
+        case Op::OP_8xy6_NF:
+        case Op::OP_8xy7_NF:
+        case Op::OP_8xyE_NF:
+        case Op::OP_Cxkk:
+        case Op::OP_Fx07:
+            return vx;
+        case Op::OP_8xy4:
+        case Op::OP_8xy5:
+        case Op::OP_8xy6:
+        case Op::OP_8xy7:
+        case Op::OP_8xyE:
+            return vx | VF;
+        case Op::OP_Dxyn:
+            return VF;
+        case Op::OP_Fx65:
+        case Op::OP_Fx85:
+            return RegistersUpTo(instruction.x);
+        case Op::OP_5xy3:
+            return RegisterRange(instruction.x, instruction.y);
+        default:
+            // Fx0A only writes Vx once a key is pressed
+            return 0;
+    }
+}
+
+bool ReadsIndex(Op op)
+{
+    return op == Op::OP_Dxyn || op == Op::OP_Dxyn_NF || op == Op::OP_Fx1E || op == Op::OP_Fx33 ||
+           op == Op::OP_Fx55 || op == Op::OP_Fx65 || op == Op::OP_5xy2 || op == Op::OP_5xy3 || op == Op::OP_F002;
+}
+
+bool WritesIndex(Op op)
+{
+    return op == Op::OP_Annn || op == Op::OP_Fx29 || op == Op::OP_Fx30 || op == Op::OP_Fx1E || op == Op::OP_F000;
+}
+
+/// <summary>
+/// Variant of an instruction without the VF write, or OP_NOP if there is none. 8xy5, 8xy6, 8xy7 and 8xyE read their
+/// operands again after writing VF, so they only qualify if neither operand is VF.
+/// </summary>
+Op WithoutFlag(Instruction instruction)
+{
+    const bool usesVF = instruction.x == 0xF || instruction.y == 0xF;
+
+    switch (instruction.op)
+    {
+        case Op::OP_8xy4:
+            return Op::OP_8xy4_NF;
+        case Op::OP_8xy5:
+            return usesVF ? Op::OP_NOP : Op::OP_8xy5_NF;
+        case Op::OP_8xy6:
+            return instruction.x == 0xF ? Op::OP_NOP : Op::OP_8xy6_NF;
+        case Op::OP_8xy7:
+            return usesVF ? Op::OP_NOP : Op::OP_8xy7_NF;
+        case Op::OP_8xyE:
+            return instruction.x == 0xF ? Op::OP_NOP : Op::OP_8xyE_NF;
+        case Op::OP_Dxyn:
+            return Op::OP_Dxyn_NF;
+        default:
+            return Op::OP_NOP;
+    }
+}
+
+void Load(Instruction& instruction, u8 value)
+{
+    instruction.op = Op::OP_6xkk;
+    instruction.kk = value;
+}
+
+void Jump(Instruction& instruction, u32 target)
+{
+    instruction.op = Op::OP_1nnn;
+    instruction.nnn = static_cast<u16>(target);
+}
+}  // namespace
+
+u32 ir::Block::Instructions() const
+{
+    u32 instructions = 0;
+
+    for (const Node& node : nodes)
+    {
+        instructions += node.ticks;
+    }
+
+    return instructions;
+}
+
+ir::Block ir::Build(const memory_t& memory, u16 address, u32 maxInstructions)
+{
+    Block block;
+    block.begin = address;
+
+    u32 pc = address;
+
+    while (block.nodes.size() < maxInstructions && pc + 1 < memory.size())
+    {
+        Node node;
+        node.instruction = DECODE_TABLE[(memory[pc] << 8u) | memory[pc + 1]];
+        node.address = static_cast<u16>(pc);
+        block.nodes.push_back(node);
+
+        pc += 2;
+
+        if (EndsBlock(node.instruction.op))
+        {
+            break;
+        }
+    }
+
+    block.end = static_cast<u16>(pc);
+
+    return block;
+}
+
+void ir::EliminateDeadFlags(Block& block)
+{
+    // Everything is live once the block is left
+    bool flagLive = true;
+
+    for (auto node = block.nodes.rbegin(); node != block.nodes.rend(); ++node)
+    {
+        Instruction& instruction = node->instruction;
+
+        if (!flagLive)
+        {
+            if (Op op = WithoutFlag(instruction); op != Op::OP_NOP)
+            {
+                instruction.op = op;
+            }
+        }
+
+        flagLive = (flagLive && !(Writes(instruction) & VF)) || (Reads(instruction) & VF);
+    }
+}
+
+void ir::PropagateConstants(Block& block)
+{
+    std::array<u8, 16> value{};
+    u16 known = 0;
+    u16 indexValue = 0;
+    bool indexKnown = false;
+
+    auto isKnown = [&known](u8 reg) { return (known & (1u << reg)) != 0; };
+
+    for (Node& node : block.nodes)
+    {
+        Instruction& instruction = node.instruction;
+        const u8 x = instruction.x;
+        const u8 y = instruction.y;
+        const u32 next = node.address + 2u;
+
+        switch (instruction.op)
+        {
+            case Op::OP_7xkk:
+                if (isKnown(x))
+                {
+                    Load(instruction, value[x] + instruction.kk);
+                }
+                break;
+            case Op::OP_8xy0:
+                if (isKnown(y))
+                {
+                    Load(instruction, value[y]);
+                }
+                break;
+            case Op::OP_8xy1:
+            case Op::OP_8xy2:
+            case Op::OP_8xy3:
+            case Op::OP_8xy4_NF:
+            case Op::OP_8xy5_NF:
+            case Op::OP_8xy7_NF:
+                if (isKnown(x) && isKnown(y))
+                {
+                    const u8 vx = value[x];
+                    const u8 vy = value[y];
+                    const Op op = instruction.op;
+
+                    Load(instruction,
+                         op == Op::OP_8xy1      ? vx | vy
+                         : op == Op::OP_8xy2    ? vx & vy
+                         : op == Op::OP_8xy3    ? vx ^ vy
+                         : op == Op::OP_8xy4_NF ? vx + vy
+                         : op == Op::OP_8xy5_NF ? vx - vy
+                                                : vy - vx);
+                }
+                else if (instruction.op == Op::OP_8xy4_NF && isKnown(y))
+                {
+                    instruction.op = Op::OP_7xkk;
+                    instruction.kk = value[y];
+                }
+                break;
+            case Op::OP_8xy6_NF:
+            case Op::OP_8xyE_NF:
+                if (isKnown(x))
+                {
+                    Load(instruction, instruction.op == Op::OP_8xy6_NF ? value[x] >> 1 : value[x] << 1);
+                }
+                break;
+            case Op::OP_3xkk:
+            case Op::OP_4xkk:
+                if (isKnown(x) && next + 2 <= 0xFFF)
+                {
+                    const bool equal = value[x] == instruction.kk;
+                    const bool skip = instruction.op == Op::OP_3xkk ? equal : !equal;
+                    Jump(instruction, skip ? next + 2 : next);
+                }
+                break;
+            case Op::OP_5xy0:
+            case Op::OP_9xy0:
+                if (isKnown(x) && isKnown(y) && next + 2 <= 0xFFF)
+                {
+                    const bool equal = value[x] == value[y];
+                    const bool skip = instruction.op == Op::OP_5xy0 ? equal : !equal;
+                    Jump(instruction, skip ? next + 2 : next);
+                }
+                break;
+            case Op::OP_Fx1E:
+                if (isKnown(x) && indexKnown && indexValue + value[x] <= 0xFFF)
+                {
+                    instruction.op = Op::OP_Annn;
+                    instruction.nnn = indexValue + value[x];
+                }
+                break;
+            case Op::OP_Fx29:
+                if (isKnown(x))
+                {
+                    instruction.op = Op::OP_Annn;
+                    instruction.nnn = Chip8::FONTSET_START_ADDRESS + 5 * value[x];
+                }
+                break;
+            case Op::OP_Fx30:
+                if (isKnown(x))
+                {
+                    instruction.op = Op::OP_Annn;
+                    instruction.nnn = Chip8::BIG_FONTSET_START_ADDRESS + 10 * value[x];
+                }
+                break;
+            default:
+                break;
+        }
+
+        // Track what the possibly rewritten instruction leaves behind
+        const u16 writes = Writes(instruction);
+
+        if (instruction.op == Op::OP_6xkk)
+        {
+            value[x] = instruction.kk;
+            known |= 1u << x;
+        }
+        else
+        {
+            known &= ~writes;
+        }
+
+        if (instruction.op == Op::OP_Fx0A)
+        {
+            known &= ~(1u << x);
+        }
+
+        if (instruction.op == Op::OP_Annn)
+        {
+            indexValue = instruction.nnn;
+            indexKnown = true;
+        }
+        else if (WritesIndex(instruction.op))
+        {
+            indexKnown = false;
+        }
+    }
+}
+
+void ir::RemoveRedundantIndexLoads(Block& block)
+{
+    bool indexLive = true;
+
+    for (auto node = block.nodes.rbegin(); node != block.nodes.rend(); ++node)
+    {
+        Instruction& instruction = node->instruction;
+
+        if (!indexLive && (instruction.op == Op::OP_Annn || instruction.op == Op::OP_Fx29 ||
+                           instruction.op == Op::OP_Fx30))
+        {
+            instruction.op = Op::OP_NOP;
+        }
+
+        indexLive = (indexLive && !WritesIndex(instruction.op)) || ReadsIndex(instruction.op);
+    }
+}
+
+void ir::Optimize(Block& block)
+{
+    EliminateDeadFlags(block);
+    PropagateConstants(block);
+    RemoveRedundantIndexLoads(block);
+
+    // Removed instructions only leave their timer tick behind
+    std::vector<Node> nodes;
+    nodes.reserve(block.nodes.size());
+
+    for (const Node& node : block.nodes)
+    {
+        if (node.instruction.op == Op::OP_NOP && !nodes.empty())
+        {
+            nodes.back().ticks += node.ticks;
+        }
+        else
+        {
+            nodes.push_back(node);
+        }
+    }
+
+    block.nodes = std::move(nodes);
+}
+
+void ir::Fuse(Block& block, const memory_t& memory)
+{
+    std::vector<Node> nodes;
+    nodes.reserve(block.nodes.size());
+
+    // Only nodes that hold a single instruction are fused, so the instructions of a sequence are adjacent in memory
+    for (const Node& node : block.nodes)
+    {
+        const auto [op, x, y, n, kk, nnn] = node.instruction;
+
+        if (!nodes.empty() && nodes.back().ticks == 1 && nodes.back().instruction.op == Op::OP_Annn &&
+            (op == Op::OP_Dxyn || op == Op::OP_Dxyn_NF))
+        {
+            Node& load = nodes.back();
+            const Op fused = op == Op::OP_Dxyn ? Op::OP_AnnnDxyn : Op::OP_AnnnDxyn_NF;
+            load.instruction = Instruction{fused, x, y, n, 0, load.instruction.nnn};
+            load.ticks += node.ticks;
+            continue;
+        }
+
+        nodes.push_back(node);
+    }
+
+    if (nodes.size() >= 2 && block.end + 1u < memory.size())
+    {
+        Node& first = nodes[nodes.size() - 2];
+        const Instruction skip = nodes.back().instruction;
+        const Instruction jump = DECODE_TABLE[(memory[block.end] << 8u) | memory[block.end + 1]];
+        const Instruction head = first.instruction;
+
+        // Leaving the loop has to be distinguishable from jumping, see Retired
+        if (first.ticks == 1 && skip.op == Op::OP_3xkk && skip.x == head.x && jump.op == Op::OP_1nnn &&
+            jump.nnn != block.end + 2)
+        {
+            if (head.op == Op::OP_7xkk)
+            {
+                first.instruction = Instruction{Op::OP_7xkk3xkk1nnn, head.x, skip.kk, 0, head.kk, jump.nnn};
+            }
+            else if (head.op == Op::OP_Fx07)
+            {
+                first.instruction = Instruction{Op::OP_Fx073xkk1nnn, head.x, 0, 0, skip.kk, jump.nnn};
+            }
+
+            if (first.instruction.op != head.op)
+            {
+                first.ticks = 3;
+                nodes.pop_back();
+                block.end += 2;
+            }
+        }
+    }
+
+    block.nodes = std::move(nodes);
+}
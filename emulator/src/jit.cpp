@@ -0,0 +1,604 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "jit.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "ir.h"
+
+using namespace chip8;
+
+namespace
+{
+constexpr size_t CODE_BUFFER_SIZE = 1024 * 1024;
+
+/// Operand encodings of the x86-64 registers used by the translated code
+constexpr u8 EAX = 0;
+constexpr u8 ECX = 1;
+constexpr u8 EDX = 2;
+
+/// Offsets of the Chip8 members relative to the state pointer passed in rdi
+struct Offsets
+{
+    explicit Offsets(const Chip8& chip8)
+    {
+        auto offset = [&chip8](const void* member) {
+            return static_cast<i32>(reinterpret_cast<const u8*>(member) - reinterpret_cast<const u8*>(&chip8));
+        };
+
+        registers = offset(&chip8.registers);
+        index = offset(&chip8.index);
+        pc = offset(&chip8.pc);
+        stack = offset(&chip8.stack);
+        sp = offset(&chip8.sp);
+        delayTimer = offset(&chip8.delayTimer);
+        soundTimer = offset(&chip8.soundTimer);
+    }
+
+    i32 V(u8 x) const { return registers + x; }
+
+    i32 registers;
+    i32 index;
+    i32 pc;
+    i32 stack;
+    i32 sp;
+    i32 delayTimer;
+    i32 soundTimer;
+};
+
+/// <summary>
+/// Minimal x86-64 encoder for the instructions the translator needs. Memory operands are always [rdi + disp32].
+/// </summary>
+class Assembler
+{
+public:
+    void Byte(u8 value) { bytes.push_back(value); }
+
+    void Imm16(u16 value)
+    {
+        Byte(value & 0xFFu);
+        Byte(value >> 8u);
+    }
+
+    void Imm32(u32 value)
+    {
+        Imm16(value & 0xFFFFu);
+        Imm16(value >> 16u);
+    }
+
+    /// ModRM with mod = 10 and rm = rdi, followed by the displacement
+    void Mem(u8 reg, i32 disp)
+    {
+        Byte(0x80u | (reg << 3u) | 0x7u);
+        Imm32(static_cast<u32>(disp));
+    }
+
+    /// movzx r32, byte [rdi + disp]
+    void LoadByte(u8 reg, i32 disp)
+    {
+        Byte(0x0F);
+        Byte(0xB6);
+        Mem(reg, disp);
+    }
+
+    /// mov byte [rdi + disp], r8
+    void StoreByte(i32 disp, u8 reg)
+    {
+        Byte(0x88);
+        Mem(reg, disp);
+    }
+
+    /// mov word [rdi + disp], r16
+    void StoreWord(i32 disp, u8 reg)
+    {
+        Byte(0x66);
+        Byte(0x89);
+        Mem(reg, disp);
+    }
+
+    /// mov byte [rdi + disp], imm8
+    void StoreByteImm(i32 disp, u8 value)
+    {
+        Byte(0xC6);
+        Mem(0, disp);
+        Byte(value);
+    }
+
+    /// mov word [rdi + disp], imm16
+    void StoreWordImm(i32 disp, u16 value)
+    {
+        Byte(0x66);
+        Byte(0xC7);
+        Mem(0, disp);
+        Imm16(value);
+    }
+
+    /// Group 1 operation with an immediate (/0 add, /2 adc, /5 sub, /7 cmp) on byte [rdi + disp]
+    void ArithMemImm(u8 extension, i32 disp, u8 value)
+    {
+        Byte(0x80);
+        Mem(extension, disp);
+        Byte(value);
+    }
+
+    /// Operation with a byte memory operand, either direction depending on the opcode
+    void ArithMem(u8 opcode, u8 reg, i32 disp)
+    {
+        Byte(opcode);
+        Mem(reg, disp);
+    }
+
+    /// Group 2 shift by one (/4 shl, /5 shr) on byte [rdi + disp]
+    void ShiftMem(u8 extension, i32 disp)
+    {
+        Byte(0xD0);
+        Mem(extension, disp);
+    }
+
+    /// setcc r8
+    void Set(u8 condition, u8 reg)
+    {
+        Byte(0x0F);
+        Byte(condition);
+        Byte(0xC0u | reg);
+    }
+
+    /// Saturating subtraction of the number of ticks from a timer byte
+    void Tick(i32 disp, u32 ticks)
+    {
+        Byte(0x31);  // xor ecx, ecx
+        Byte(0xC9);
+        LoadByte(EAX, disp);
+        Byte(0x2D);  // sub eax, imm32
+        Imm32(ticks);
+        Byte(0x0F);  // cmovs eax, ecx
+        Byte(0x48);
+        Byte(0xC1);
+        StoreByte(disp, EAX);
+    }
+
+    std::vector<u8> bytes;
+};
+
+constexpr u8 OP_ADD_MEM_REG = 0x00;
+constexpr u8 OP_OR_MEM_REG = 0x08;
+constexpr u8 OP_AND_MEM_REG = 0x20;
+constexpr u8 OP_SUB_MEM_REG = 0x28;
+constexpr u8 OP_XOR_MEM_REG = 0x30;
+constexpr u8 OP_CMP_MEM_REG = 0x38;
+constexpr u8 OP_SUB_REG_MEM = 0x2A;
+constexpr u8 OP_CMP_REG_MEM = 0x3A;
+
+constexpr u8 SETC = 0x92;
+constexpr u8 SETE = 0x94;
+constexpr u8 SETNE = 0x95;
+constexpr u8 SETA = 0x97;
+
+/// pc = next + 2 if the condition flag computed before is set, otherwise next
+void EmitSkip(Assembler& a, const Offsets& o, u8 condition, u16 next)
+{
+    a.Set(condition, EAX);
+    a.Byte(0x01);  // add eax, eax
+    a.Byte(0xC0);
+    a.Byte(0x05);  // add eax, imm32
+    a.Imm32(next);
+    a.StoreWord(o.pc, EAX);
+}
+
+void EmitTicks(Assembler& a, const Offsets& o, u32 ticks)
+{
+    if (ticks > 0)
+    {
+        a.Tick(o.delayTimer, ticks);
+        a.Tick(o.soundTimer, ticks);
+    }
+}
+
+/// <summary>
+/// Translate a single instruction. The translation mirrors the order of reads and writes of the interpreter, so the
+/// result is identical even when an operand register is VF.
+/// </summary>
+/// <returns> False if the instruction has no native translation</returns>
+bool Emit(Assembler& a, const Offsets& o, Instruction instruction, u16 next, bool& terminator)
+{
+    const auto [op, x, y, n, kk, nnn] = instruction;
+
+    switch (op)
+    {
+        case Op::OP_NOP:
+            break;
+
+        case Op::OP_00EE:
+            a.Byte(0xFE);  // dec byte [sp]
+            a.Mem(1, o.sp);
+            a.LoadByte(EAX, o.sp);
+            a.Byte(0x0F);  // movzx eax, word [rdi + rax * 2 + stack]
+            a.Byte(0xB7);
+            a.Byte(0x84);
+            a.Byte(0x47);
+            a.Imm32(static_cast<u32>(o.stack));
+            a.StoreWord(o.pc, EAX);
+            terminator = true;
+            break;
+
+        case Op::OP_1nnn:
+            a.StoreWordImm(o.pc, nnn);
+            terminator = true;
+            break;
+
+        case Op::OP_2nnn:
+            a.LoadByte(EAX, o.sp);
+            a.Byte(0x66);  // mov word [rdi + rax * 2 + stack], next
+            a.Byte(0xC7);
+            a.Byte(0x84);
+            a.Byte(0x47);
+            a.Imm32(static_cast<u32>(o.stack));
+            a.Imm16(next);
+            a.Byte(0xFE);  // inc byte [sp]
+            a.Mem(0, o.sp);
+            a.StoreWordImm(o.pc, nnn);
+            terminator = true;
+            break;
+
+        case Op::OP_3xkk:
+        case Op::OP_4xkk:
+            a.Byte(0x31);  // xor eax, eax
+            a.Byte(0xC0);
+            a.ArithMemImm(7, o.V(x), kk);
+            EmitSkip(a, o, op == Op::OP_3xkk ? SETE : SETNE, next);
+            terminator = true;
+            break;
+
+        case Op::OP_5xy0:
+        case Op::OP_9xy0:
+            a.LoadByte(ECX, o.V(y));
+            a.Byte(0x31);  // xor eax, eax
+            a.Byte(0xC0);
+            a.ArithMem(OP_CMP_MEM_REG, ECX, o.V(x));
+            EmitSkip(a, o, op == Op::OP_5xy0 ? SETE : SETNE, next);
+            terminator = true;
+            break;
+
+        case Op::OP_6xkk:
+            a.StoreByteImm(o.V(x), kk);
+            break;
+
+        case Op::OP_7xkk:
+            a.ArithMemImm(0, o.V(x), kk);
+            break;
+
+        case Op::OP_8xy0:
+            a.LoadByte(EAX, o.V(y));
+            a.StoreByte(o.V(x), EAX);
+            break;
+
+        case Op::OP_8xy1:
+        case Op::OP_8xy2:
+        case Op::OP_8xy3:
+            a.LoadByte(EAX, o.V(y));
+            a.ArithMem(op == Op::OP_8xy1   ? OP_OR_MEM_REG
+                       : op == Op::OP_8xy2 ? OP_AND_MEM_REG
+                                           : OP_XOR_MEM_REG,
+                       EAX,
+                       o.V(x));
+            break;
+
+        case Op::OP_8xy4:
+            a.LoadByte(EAX, o.V(x));
+            a.LoadByte(ECX, o.V(y));
+            a.Byte(0x00);  // add al, cl
+            a.Byte(0xC8);
+            a.Set(SETC, EDX);
+            a.StoreByte(o.V(0xF), EDX);
+            a.StoreByte(o.V(x), EAX);
+            break;
+
+        case Op::OP_8xy5:
+        case Op::OP_8xy7: {
+            // 8xy5 computes Vx - Vy, 8xy7 computes Vy - Vx
+            const i32 minuend = op == Op::OP_8xy5 ? o.V(x) : o.V(y);
+            const i32 subtrahend = op == Op::OP_8xy5 ? o.V(y) : o.V(x);
+            a.LoadByte(EAX, minuend);
+            a.ArithMem(OP_CMP_REG_MEM, EAX, subtrahend);
+            a.Set(SETA, EDX);
+            a.StoreByte(o.V(0xF), EDX);
+            a.LoadByte(EAX, minuend);
+            a.ArithMem(OP_SUB_REG_MEM, EAX, subtrahend);
+            a.StoreByte(o.V(x), EAX);
+            break;
+        }
+
+        case Op::OP_8xy6:
+            a.LoadByte(EAX, o.V(x));
+            a.Byte(0x24);  // and al, 1
+            a.Byte(0x01);
+            a.StoreByte(o.V(0xF), EAX);
+            a.ShiftMem(5, o.V(x));
+            break;
+
+        case Op::OP_8xyE:
+            a.LoadByte(EAX, o.V(x));
+            a.Byte(0xC0);  // shr al, 7
+            a.Byte(0xE8);
+            a.Byte(0x07);
+            a.StoreByte(o.V(0xF), EAX);
+            a.ShiftMem(4, o.V(x));
+            break;
+
+        case Op::OP_8xy4_NF:
+            a.LoadByte(EAX, o.V(y));
+            a.ArithMem(OP_ADD_MEM_REG, EAX, o.V(x));
+            break;
+
+        case Op::OP_8xy5_NF:
+            a.LoadByte(EAX, o.V(y));
+            a.ArithMem(OP_SUB_MEM_REG, EAX, o.V(x));
+            break;
+
+        case Op::OP_8xy7_NF:
+            a.LoadByte(EAX, o.V(y));
+            a.ArithMem(OP_SUB_REG_MEM, EAX, o.V(x));
+            a.StoreByte(o.V(x), EAX);
+            break;
+
+        case Op::OP_8xy6_NF:
+            a.ShiftMem(5, o.V(x));
+            break;
+
+        case Op::OP_8xyE_NF:
+            a.ShiftMem(4, o.V(x));
+            break;
+
+        case Op::OP_Annn:
+            a.StoreWordImm(o.index, nnn);
+            break;
+
+        case Op::OP_Bnnn:
+            a.LoadByte(EAX, o.V(0));
+            a.Byte(0x05);  // add eax, imm32
+            a.Imm32(nnn);
+            a.StoreWord(o.pc, EAX);
+            terminator = true;
+            break;
+
+        case Op::OP_Fx07:
+            a.LoadByte(EAX, o.delayTimer);
+            a.StoreByte(o.V(x), EAX);
+            break;
+
+        case Op::OP_Fx15:
+            a.LoadByte(EAX, o.V(x));
+            a.StoreByte(o.delayTimer, EAX);
+            break;
+
+        case Op::OP_Fx18:
+            a.LoadByte(EAX, o.V(x));
+            a.StoreByte(o.soundTimer, EAX);
+            break;
+
+        case Op::OP_Fx1E:
+            a.LoadByte(EAX, o.V(x));
+            a.Byte(0x66);  // add word [index], ax
+            a.Byte(0x01);
+            a.Mem(EAX, o.index);
+            break;
+
+        case Op::OP_Fx29:
+            a.LoadByte(EAX, o.V(x));
+            a.Byte(0x8D);  // lea eax, [rax + rax * 4 + FONTSET_START_ADDRESS]
+            a.Byte(0x44);
+            a.Byte(0x80);
+            a.Byte(Chip8::FONTSET_START_ADDRESS);
+            a.StoreWord(o.index, EAX);
+            break;
+
+        default:
+            // Drawing, input, randomness and memory access go through the interpreter
+            return false;
+    }
+
+    return true;
+}
+}  // namespace
+
+Jit::Jit(Chip8& chip8) :
+    chip8(chip8), blocks(chip8.memory.size()), blockEnds(chip8.memory.size()), untranslated(chip8.memory.size())
+{
+    void* buffer = mmap(nullptr, CODE_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (buffer == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+
+    code = static_cast<u8*>(buffer);
+    codeSize = CODE_BUFFER_SIZE;
+}
+
+Jit::~Jit()
+{
+    munmap(code, codeSize);
+}
+
+u32 Jit::Step()
+{
+    const u16 pc = chip8.pc;
+
+    if (pc < blocks.size() && !untranslated[pc])
+    {
+        if (!blocks[pc])
+        {
+            blocks[pc] = Compile(pc);
+        }
+
+        if (blocks[pc])
+        {
+            return blocks[pc](&chip8);
+        }
+
+        untranslated[pc] = true;
+    }
+
+    // No translation, let the interpreter execute the instruction
+    const Instruction instruction = DECODE_TABLE[(chip8.memory[pc] << 8u) | chip8.memory[pc + 1]];
+    const u16 index = chip8.index;
+
+    chip8.Cycle();
+
+    if (instruction.op == Op::OP_Fx33)
+    {
+        Invalidate(index, 3);
+    }
+    else if (instruction.op == Op::OP_Fx55)
+    {
+        Invalidate(index, instruction.x + 1);
+    }
+    else if (instruction.op == Op::OP_5xy2)
+    {
+        Invalidate(index, std::max(instruction.x, instruction.y) - std::min(instruction.x, instruction.y) + 1);
+    }
+
+    return 1;
+}
+
+u64 Jit::Run(u64 instructions)
+{
+    u64 executed = 0;
+
+    while (executed < instructions)
+    {
+        executed += Step();
+    }
+
+    return executed;
+}
+
+void Jit::Invalidate(u32 address, u32 size)
+{
+    // A block covers at most MAX_BLOCK_INSTRUCTIONS instructions in front of the range
+    const u32 reach = MAX_BLOCK_INSTRUCTIONS * 2;
+    u32 begin = address > reach ? address - reach : 0;
+    u32 end = std::min<u32>(address + size, blocks.size());
+
+    for (u32 start = begin; start < end; ++start)
+    {
+        if (blocks[start] && blockEnds[start] > address)
+        {
+            blocks[start] = nullptr;
+        }
+
+        // The marker only depends on the single instruction at its address
+        if (untranslated[start] && start + 2 > address)
+        {
+            untranslated[start] = false;
+        }
+    }
+}
+
+void Jit::InvalidateAll()
+{
+    std::fill(blocks.begin(), blocks.end(), nullptr);
+    std::fill(untranslated.begin(), untranslated.end(), false);
+    codeUsed = 0;
+}
+
+Jit::Block Jit::Compile(u16 address)
+{
+    const Offsets offsets(chip8);
+    Assembler a;
+
+    ++compilations;
+
+    ir::Block block = ir::Build(chip8.memory, address, MAX_BLOCK_INSTRUCTIONS);
+
+    // Cut the block in front of the first instruction without a translation, before the optimiser sees it
+    for (size_t i = 0; i < block.nodes.size(); ++i)
+    {
+        Assembler probe;
+        bool terminator = false;
+
+        if (!Emit(probe, offsets, block.nodes[i].instruction, 0, terminator))
+        {
+            block.end = block.nodes[i].address;
+            block.nodes.resize(i);
+            break;
+        }
+    }
+
+    if (block.nodes.empty())
+    {
+        return nullptr;
+    }
+
+    ir::Optimize(block);
+
+    u32 count = 0;
+    u32 ticked = 0;
+    bool terminator = false;
+
+    for (const ir::Node& node : block.nodes)
+    {
+        const Op op = node.instruction.op;
+
+        // The timers tick after every instruction, but they only have to be up to date when an instruction uses them
+        if (op == Op::OP_Fx07 || op == Op::OP_Fx15 || op == Op::OP_Fx18)
+        {
+            EmitTicks(a, offsets, count - ticked);
+            ticked = count;
+        }
+
+        Emit(a, offsets, node.instruction, static_cast<u16>(node.address + 2), terminator);
+        count += node.ticks;
+    }
+
+    EmitTicks(a, offsets, count - ticked);
+
+    if (!terminator)
+    {
+        a.StoreWordImm(offsets.pc, block.end);
+    }
+
+    a.Byte(0xB8);  // mov eax, count
+    a.Imm32(count);
+    a.Byte(0xC3);  // ret
+
+    if (codeUsed + a.bytes.size() > codeSize)
+    {
+        InvalidateAll();
+    }
+
+    u8* entry = code + codeUsed;
+
+    mprotect(code, codeSize, PROT_READ | PROT_WRITE);
+    std::memcpy(entry, a.bytes.data(), a.bytes.size());
+    mprotect(code, codeSize, PROT_READ | PROT_EXEC);
+
+    codeUsed += a.bytes.size();
+    blockEnds[address] = block.end;
+
+    return reinterpret_cast<Block>(entry);
+}
@@ -0,0 +1,556 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lockstep.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "core.h"
+#include "decode.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace chip8;
+
+namespace
+{
+/// Granularity at which memory is tracked as the same in every lane
+constexpr u32 BLOCK_SIZE = 64;
+
+#if defined(__SSE2__)
+__m128i LoadLanes(const u8* lanes)
+{
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+}
+
+void StoreLanes(u8* lanes, __m128i value)
+{
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), value);
+}
+
+/// <summary>
+/// a in the lanes of the mask, b in the others
+/// </summary>
+__m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+void StoreLanes(u8* lanes, __m128i value, __m128i mask)
+{
+    StoreLanes(lanes, Select(mask, value, LoadLanes(lanes)));
+}
+
+/// <summary>
+/// 16 lanes of u16, lanes 0-7 in lo and 8-15 in hi
+/// </summary>
+struct Wide
+{
+    __m128i lo;
+    __m128i hi;
+};
+
+Wide LoadLanes(const u16* lanes)
+{
+    return {_mm_load_si128(reinterpret_cast<const __m128i*>(lanes)),
+            _mm_load_si128(reinterpret_cast<const __m128i*>(lanes + 8))};
+}
+
+void StoreLanes(u16* lanes, Wide value, Wide mask)
+{
+    const Wide old = LoadLanes(lanes);
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), Select(mask.lo, value.lo, old.lo));
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes + 8), Select(mask.hi, value.hi, old.hi));
+}
+
+Wide Set(u16 value)
+{
+    return {_mm_set1_epi16(static_cast<short>(value)), _mm_set1_epi16(static_cast<short>(value))};
+}
+
+Wide Add(Wide a, Wide b)
+{
+    return {_mm_add_epi16(a.lo, b.lo), _mm_add_epi16(a.hi, b.hi)};
+}
+
+/// Zero extend u8 lanes
+Wide Widen(__m128i bytes)
+{
+    const __m128i zero = _mm_setzero_si128();
+    return {_mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero)};
+}
+
+/// Extend a mask of u8 lanes to u16 lanes
+Wide WidenMask(__m128i mask)
+{
+    return {_mm_unpacklo_epi8(mask, mask), _mm_unpackhi_epi8(mask, mask)};
+}
+
+/// Mask with the lanes of the set bits
+__m128i MaskFromBits(u32 bits)
+{
+    const __m128i select = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i bytes = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(bits & 0xFFu)),
+                                             _mm_set1_epi8(static_cast<char>(bits >> 8u)));
+
+    return _mm_cmpeq_epi8(_mm_and_si128(bytes, select), select);
+}
+
+/// Lanes where a > b, unsigned
+__m128i Greater(__m128i a, __m128i b)
+{
+    return _mm_andnot_si128(_mm_cmpeq_epi8(_mm_max_epu8(a, b), b), _mm_set1_epi8(-1));
+}
+#endif
+}  // namespace
+
+template <typename Quirks>
+Lockstep<Quirks>::Lockstep() : machines(LANES), shared(MEMORY_SIZE / BLOCK_SIZE, true)
+{
+    for (Chip8& machine : machines)
+    {
+        machine.timing = Timing::Frame;
+    }
+}
+
+template <typename Quirks>
+void Lockstep<Quirks>::Load(u32 lane, const Chip8& chip8)
+{
+    machines[lane] = chip8;
+    machines[lane].timing = Timing::Frame;
+    enabled |= 1u << lane;
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        registers[i][lane] = chip8.registers[i];
+        stack[i][lane] = chip8.stack[i];
+    }
+
+    pc[lane] = chip8.pc;
+    index[lane] = chip8.index;
+    sp[lane] = chip8.sp;
+    delayTimer[lane] = chip8.delayTimer;
+    soundTimer[lane] = chip8.soundTimer;
+
+    // Compare every lane with the first one
+    const memory_t& first = machines[std::countr_zero(enabled)].memory;
+
+    for (u32 block = 0; block < shared.size(); ++block)
+    {
+        const u32 begin = block * BLOCK_SIZE;
+        bool same = true;
+
+        for (u32 other = enabled; other != 0 && same; other &= other - 1)
+        {
+            const memory_t& memory = machines[std::countr_zero(other)].memory;
+            same = std::equal(first.begin() + begin, first.begin() + begin + BLOCK_SIZE, memory.begin() + begin);
+        }
+
+        shared[block] = same;
+    }
+}
+
+template <typename Quirks>
+Chip8 Lockstep<Quirks>::Lane(u32 lane) const
+{
+    Chip8 chip8 = machines[lane];
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        chip8.registers[i] = registers[i][lane];
+        chip8.stack[i] = stack[i][lane];
+    }
+
+    chip8.pc = pc[lane];
+    chip8.index = index[lane];
+    chip8.sp = sp[lane];
+    chip8.delayTimer = delayTimer[lane];
+    chip8.soundTimer = soundTimer[lane];
+
+    return chip8;
+}
+
+template <typename Quirks>
+void Lockstep<Quirks>::RunFrames(u64 frames, u32 instructionsPerFrame)
+{
+    for (u64 i = 0; i < frames; ++i)
+    {
+        RunFrame(instructionsPerFrame);
+    }
+}
+
+template <typename Quirks>
+void Lockstep<Quirks>::RunFrame(u32 instructionsPerFrame)
+{
+    // The budget of a lane is counted in 16 bits
+    for (u32 left = instructionsPerFrame; left > 0;)
+    {
+        const u16 budget = static_cast<u16>(std::min<u32>(left, UINT16_MAX));
+        Run(budget);
+        left -= budget;
+    }
+
+    for (u32 lane = 0; lane < LANES; ++lane)
+    {
+        delayTimer[lane] = delayTimer[lane] > 0 ? delayTimer[lane] - 1 : 0;
+        soundTimer[lane] = soundTimer[lane] > 0 ? soundTimer[lane] - 1 : 0;
+    }
+}
+
+template <typename Quirks>
+u16 Lockstep<Quirks>::Fetch(u32 lane, u16 address) const
+{
+    const memory_t& memory = machines[lane].memory;
+    return (memory[address] << 8u) | memory[address + 1];
+}
+
+template <typename Quirks>
+void Lockstep<Quirks>::MarkWritten(u32 address, u32 size)
+{
+    for (u32 i = address; i < address + size; i += BLOCK_SIZE)
+    {
+        shared[(i % MEMORY_SIZE) / BLOCK_SIZE] = false;
+    }
+
+    shared[((address + size - 1) % MEMORY_SIZE) / BLOCK_SIZE] = false;
+}
+
+template <typename Quirks>
+void Lockstep<Quirks>::Run(u16 budget)
+{
+    for (u32 lane = 0; lane < LANES; ++lane)
+    {
+        remaining[lane] = (enabled >> lane) & 1u ? budget : 0;
+    }
+
+    while (true)
+    {
+#if defined(__SSE2__)
+        // Lowest pc of the lanes with budget left. SSE2 only compares signed 16 bit lanes, so the addresses are biased.
+        const Wide left = LoadLanes(remaining.data());
+        const __m128i zero = _mm_setzero_si128();
+        const Wide done = {_mm_cmpeq_epi16(left.lo, zero), _mm_cmpeq_epi16(left.hi, zero)};
+        const __m128i finished = _mm_packs_epi16(done.lo, done.hi);
+
+        if (_mm_movemask_epi8(finished) == 0xFFFF)
+        {
+            return;
+        }
+
+        const __m128i bias = _mm_set1_epi16(INT16_MIN);
+        const Wide address = LoadLanes(pc.data());
+        __m128i lowest = _mm_min_epi16(_mm_xor_si128(_mm_or_si128(address.lo, done.lo), bias),
+                                       _mm_xor_si128(_mm_or_si128(address.hi, done.hi), bias));
+        lowest = _mm_min_epi16(lowest, _mm_shuffle_epi32(lowest, _MM_SHUFFLE(1, 0, 3, 2)));
+        lowest = _mm_min_epi16(lowest, _mm_shuffle_epi32(lowest, _MM_SHUFFLE(2, 3, 0, 1)));
+        lowest = _mm_min_epi16(lowest, _mm_shufflelo_epi16(lowest, _MM_SHUFFLE(2, 3, 0, 1)));
+        const u16 leader = static_cast<u16>(_mm_cvtsi128_si32(lowest) ^ INT16_MIN);
+
+        const __m128i same = _mm_packs_epi16(_mm_cmpeq_epi16(address.lo, _mm_set1_epi16(static_cast<short>(leader))),
+                                             _mm_cmpeq_epi16(address.hi, _mm_set1_epi16(static_cast<short>(leader))));
+        u32 group = static_cast<u32>(_mm_movemask_epi8(_mm_andnot_si128(finished, same)));
+#else
+        u32 group = 0;
+        u16 leader = UINT16_MAX;
+
+        for (u32 lane = 0; lane < LANES; ++lane)
+        {
+            if (remaining[lane] > 0 && pc[lane] <= leader)
+            {
+                group = pc[lane] < leader ? 0 : group;
+                group |= 1u << lane;
+                leader = pc[lane];
+            }
+        }
+
+        if (group == 0)
+        {
+            return;
+        }
+#endif
+
+        const u32 first = std::countr_zero(group);
+        const u16 opcode = Fetch(first, leader);
+
+        // Lanes that wrote to their code may hold a different instruction, they wait for a later step
+        if (!shared[(leader % MEMORY_SIZE) / BLOCK_SIZE] || !shared[((leader + 1u) % MEMORY_SIZE) / BLOCK_SIZE])
+        {
+            for (u32 other = group & (group - 1); other != 0; other &= other - 1)
+            {
+                const u32 lane = std::countr_zero(other);
+
+                if (Fetch(lane, leader) != opcode)
+                {
+                    group &= ~(1u << lane);
+                }
+            }
+        }
+
+        Execute(group, DECODE_TABLE[opcode]);
+
+        for (u32 lanes = group; lanes != 0; lanes &= lanes - 1)
+        {
+            --remaining[std::countr_zero(lanes)];
+        }
+
+        ++stats.steps;
+        stats.laneInstructions += std::popcount(group);
+    }
+}
+
+template <typename Quirks>
+void Lockstep<Quirks>::ExecuteScalar(u32 lane, Instruction instruction)
+{
+    Chip8& c = machines[lane];
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        c.registers[i] = registers[i][lane];
+        c.stack[i] = stack[i][lane];
+    }
+
+    c.pc = pc[lane];
+    c.index = index[lane];
+    c.sp = sp[lane];
+    c.delayTimer = delayTimer[lane];
+    c.soundTimer = soundTimer[lane];
+
+    // Only these write to memory, at most 16 bytes from I
+    if (instruction.op == Op::OP_Fx33 || instruction.op == Op::OP_Fx55 || instruction.op == Op::OP_5xy2)
+    {
+        MarkWritten(c.index, 16);
+    }
+
+    Core<Quirks>::Execute(c, instruction);
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        registers[i][lane] = c.registers[i];
+        stack[i][lane] = c.stack[i];
+    }
+
+    pc[lane] = c.pc;
+    index[lane] = c.index;
+    sp[lane] = c.sp;
+    delayTimer[lane] = c.delayTimer;
+    soundTimer[lane] = c.soundTimer;
+
+    ++stats.scalarInstructions;
+}
+
+template <typename Quirks>
+void Lockstep<Quirks>::Execute(u32 group, Instruction instruction)
+{
+    // Increment the PC before we execute anything
+    for (u32 lanes = group; lanes != 0; lanes &= lanes - 1)
+    {
+        pc[std::countr_zero(lanes)] += 2;
+    }
+
+#if defined(__SSE2__)
+    const auto [op, x, y, n, kk, nnn] = instruction;
+    const __m128i mask = MaskFromBits(group);
+    const Wide wideMask = WidenMask(mask);
+    const __m128i one = _mm_set1_epi8(1);
+
+    u8* vx = registers[x].data();
+    u8* vy = registers[y].data();
+    u8* vf = registers[0xF].data();
+
+    // Skips of lanes in which the condition holds. Skip<Quirks> looks at the next instruction for XO-CHIP.
+    auto skip = [&](__m128i condition) {
+        const Wide taken = WidenMask(_mm_and_si128(condition, mask));
+        StoreLanes(pc.data(), Add(LoadLanes(pc.data()), Set(2)), taken);
+    };
+
+    switch (op)
+    {
+        case Op::OP_NOP:
+        case Op::OP_UNDECODED:
+            return;
+        case Op::OP_1nnn:
+            StoreLanes(pc.data(), Set(nnn), wideMask);
+            return;
+        case Op::OP_2nnn:
+            for (u32 lanes = group; lanes != 0; lanes &= lanes - 1)
+            {
+                const u32 lane = std::countr_zero(lanes);
+                stack[sp[lane]++][lane] = pc[lane];
+            }
+
+            StoreLanes(pc.data(), Set(nnn), wideMask);
+            return;
+        case Op::OP_00EE:
+            for (u32 lanes = group; lanes != 0; lanes &= lanes - 1)
+            {
+                const u32 lane = std::countr_zero(lanes);
+                pc[lane] = stack[--sp[lane]][lane];
+            }
+            return;
+        case Op::OP_3xkk:
+            if constexpr (!Quirks::SKIPS_LONG_LOAD)
+            {
+                skip(_mm_cmpeq_epi8(LoadLanes(vx), _mm_set1_epi8(static_cast<char>(kk))));
+                return;
+            }
+            break;
+        case Op::OP_4xkk:
+            if constexpr (!Quirks::SKIPS_LONG_LOAD)
+            {
+                skip(_mm_andnot_si128(_mm_cmpeq_epi8(LoadLanes(vx), _mm_set1_epi8(static_cast<char>(kk))), mask));
+                return;
+            }
+            break;
+        case Op::OP_5xy0:
+            if constexpr (!Quirks::SKIPS_LONG_LOAD)
+            {
+                skip(_mm_cmpeq_epi8(LoadLanes(vx), LoadLanes(vy)));
+                return;
+            }
+            break;
+        case Op::OP_9xy0:
+            if constexpr (!Quirks::SKIPS_LONG_LOAD)
+            {
+                skip(_mm_andnot_si128(_mm_cmpeq_epi8(LoadLanes(vx), LoadLanes(vy)), mask));
+                return;
+            }
+            break;
+        case Op::OP_6xkk:
+            StoreLanes(vx, _mm_set1_epi8(static_cast<char>(kk)), mask);
+            return;
+        case Op::OP_7xkk:
+            StoreLanes(vx, _mm_add_epi8(LoadLanes(vx), _mm_set1_epi8(static_cast<char>(kk))), mask);
+            return;
+        case Op::OP_8xy0:
+            StoreLanes(vx, LoadLanes(vy), mask);
+            return;
+        case Op::OP_8xy1:
+        case Op::OP_8xy2:
+        case Op::OP_8xy3: {
+            const __m128i a = LoadLanes(vx);
+            const __m128i b = LoadLanes(vy);
+            const __m128i result = op == Op::OP_8xy1   ? _mm_or_si128(a, b)
+                                   : op == Op::OP_8xy2 ? _mm_and_si128(a, b)
+                                                       : _mm_xor_si128(a, b);
+            StoreLanes(vx, result, mask);
+
+            if constexpr (Quirks::LOGIC_RESETS_VF)
+            {
+                StoreLanes(vf, _mm_setzero_si128(), mask);
+            }
+            return;
+        }
+        case Op::OP_8xy4: {
+            const __m128i a = LoadLanes(vx);
+            const __m128i sum = _mm_add_epi8(a, LoadLanes(vy));
+            StoreLanes(vf, _mm_and_si128(Greater(a, sum), one), mask);
+            StoreLanes(vx, sum, mask);
+            return;
+        }
+        // The flag is written first, like the scalar kernels do, which matters if x or y is F
+        case Op::OP_8xy5:
+            StoreLanes(vf, _mm_and_si128(Greater(LoadLanes(vx), LoadLanes(vy)), one), mask);
+            StoreLanes(vx, _mm_sub_epi8(LoadLanes(vx), LoadLanes(vy)), mask);
+            return;
+        case Op::OP_8xy7:
+            StoreLanes(vf, _mm_and_si128(Greater(LoadLanes(vy), LoadLanes(vx)), one), mask);
+            StoreLanes(vx, _mm_sub_epi8(LoadLanes(vy), LoadLanes(vx)), mask);
+            return;
+        case Op::OP_8xy6:
+            if constexpr (Quirks::SHIFT_USES_VY)
+            {
+                const __m128i value = LoadLanes(vy);
+                StoreLanes(vx, _mm_and_si128(_mm_srli_epi16(value, 1), _mm_set1_epi8(0x7F)), mask);
+                StoreLanes(vf, _mm_and_si128(value, one), mask);
+            }
+            else
+            {
+                StoreLanes(vf, _mm_and_si128(LoadLanes(vx), one), mask);
+                StoreLanes(vx, _mm_and_si128(_mm_srli_epi16(LoadLanes(vx), 1), _mm_set1_epi8(0x7F)), mask);
+            }
+            return;
+        case Op::OP_8xyE:
+            if constexpr (Quirks::SHIFT_USES_VY)
+            {
+                const __m128i value = LoadLanes(vy);
+                StoreLanes(vx, _mm_add_epi8(value, value), mask);
+                StoreLanes(vf, _mm_and_si128(_mm_srli_epi16(value, 7), one), mask);
+            }
+            else
+            {
+                StoreLanes(vf, _mm_and_si128(_mm_srli_epi16(LoadLanes(vx), 7), one), mask);
+                StoreLanes(vx, _mm_add_epi8(LoadLanes(vx), LoadLanes(vx)), mask);
+            }
+            return;
+        case Op::OP_Annn:
+            StoreLanes(index.data(), Set(nnn), wideMask);
+            return;
+        case Op::OP_Bnnn: {
+            const u8 jump = Quirks::JUMP_USES_VX ? nnn >> 8u : 0;
+            StoreLanes(pc.data(), Add(Widen(LoadLanes(registers[jump].data())), Set(nnn)), wideMask);
+            return;
+        }
+        case Op::OP_Cxkk:
+            for (u32 lanes = group; lanes != 0; lanes &= lanes - 1)
+            {
+                const u32 lane = std::countr_zero(lanes);
+                Chip8& c = machines[lane];
+                registers[x][lane] = c.randomByte(c.randomGenerator) & kk;
+            }
+            return;
+        case Op::OP_Fx07:
+            StoreLanes(vx, LoadLanes(delayTimer.data()), mask);
+            return;
+        case Op::OP_Fx15:
+            StoreLanes(delayTimer.data(), LoadLanes(vx), mask);
+            return;
+        case Op::OP_Fx18:
+            StoreLanes(soundTimer.data(), LoadLanes(vx), mask);
+            return;
+        case Op::OP_Fx1E:
+            StoreLanes(index.data(), Add(LoadLanes(index.data()), Widen(LoadLanes(vx))), wideMask);
+            return;
+        case Op::OP_Fx29: {
+            const Wide digit = Widen(LoadLanes(vx));
+            const __m128i five = _mm_set1_epi16(5);
+            const Wide offset = {_mm_mullo_epi16(digit.lo, five), _mm_mullo_epi16(digit.hi, five)};
+            StoreLanes(index.data(), Add(offset, Set(Chip8::FONTSET_START_ADDRESS)), wideMask);
+            return;
+        }
+        default:
+            break;
+    }
+#endif
+
+    for (u32 lanes = group; lanes != 0; lanes &= lanes - 1)
+    {
+        ExecuteScalar(std::countr_zero(lanes), instruction);
+    }
+}
+
+template class chip8::Lockstep<quirks::Legacy>;
+template class chip8::Lockstep<quirks::Chip8>;
+template class chip8::Lockstep<quirks::SuperChip>;
+template class chip8::Lockstep<quirks::XoChip>;
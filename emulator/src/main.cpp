@@ -22,56 +22,89 @@
 
 #include <chrono>
 #include <iostream>
+#include <string_view>
 
 #include "emulator.h"
+#include "frame_pacer.h"
 #include "platform.h"
+#include "rewind.h"
+#include "scheduler.h"
+#include "video.h"
 
 using namespace chip8;
 
 int main(int argc, char* argv[])
 {
-    if (argc != 4)
+    if (argc != 4 && !(argc == 5 && std::string_view(argv[4]) == "--low-latency"))
     {
-        std::cerr << "Usage: " << argv[0] << " <Scale> <Delay> <ROM>\n";
+        std::cerr << "Usage: " << argv[0] << " <Scale> <InstructionsPerFrame> <ROM> [--low-latency]\n";
         std::exit(EXIT_FAILURE);
     }
 
     int videoScale = std::stoi(argv[1]);
-    int cycleDelay = std::stoi(argv[2]);
+    u32 instructionsPerFrame = std::stoul(argv[2]);
     char const* romFilename = argv[3];
+    Pacing pacing = argc == 5 ? Pacing::LowLatency : Pacing::Fixed;
+
+    // Beeps last one frame, the sound timer is checked again after the next one
+    auto beepTime = std::chrono::duration_cast<std::chrono::milliseconds>(Scheduler::FRAME_TIME);
 
     Platform platform("CHIP-8 Emulator",
                       VIDEO_WIDTH * videoScale,
                       VIDEO_HEIGHT * videoScale,
-                      VIDEO_WIDTH,
-                      VIDEO_HEIGHT,
-                      75 * cycleDelay);
+                      RgbaFrame::WIDTH,
+                      RgbaFrame::HEIGHT,
+                      static_cast<int>(beepTime.count()),
+                      pacing == Pacing::LowLatency);
 
     Chip8 chip8;
     chip8.LoadRom(romFilename);
 
-    int videoPitch = sizeof(chip8.video[0]) * VIDEO_WIDTH;
+    Scheduler scheduler(chip8, instructionsPerFrame);
+    RgbaFrame frame;
+    Rewind rewind;
+    MachineState previous;
 
-    auto lastCycleTime = std::chrono::high_resolution_clock::now();
+    FramePacer pacer(Scheduler::FRAMES_PER_SECOND, pacing);
     bool quit = false;
 
     while (!quit)
     {
-        quit = platform.ProcessInput(chip8.keypad.data());
+        pacer.Wait();
 
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        float dt = std::chrono::duration<float, std::chrono::milliseconds::period>(currentTime - lastCycleTime).count();
+        quit = platform.ProcessInput(chip8.keypad.data());
 
-        if (dt > cycleDelay)
+        if (platform.RewindHeld())
+        {
+            // Plays the history backwards while the hotkey is held, the keys stay as they are held now
+            if (rewind.StepBack(previous))
+            {
+                const keypad_t keys = chip8.keypad;
+                chip8.Restore(previous);
+                chip8.keypad = keys;
+            }
+        }
+        else
         {
-            lastCycleTime = currentTime;
+            scheduler.RunFrame();
+            rewind.Record(chip8);
+        }
 
-            chip8.Cycle();
+        // Presents once per frame, and only expands the framebuffer again if the frame changed it
+        frame.Update(chip8);
+        pacer.Presenting();
+        platform.Update(frame.Data(), RgbaFrame::PITCH);
+        platform.SoundOutput(chip8.soundTimer);
 
-            platform.Update(chip8.video.data(), videoPitch);
-            platform.SoundOutput(chip8.soundTimer);
-        }
+        pacer.FrameDone();
     }
 
+    const FrameStats stats = pacer.Stats();
+    std::cerr << "Frames: " << stats.frames << ", missed: " << stats.missed
+              << ", mean: " << std::chrono::duration<double, std::milli>(stats.mean).count()
+              << " ms, jitter: " << std::chrono::duration<double, std::milli>(stats.jitter).count()
+              << " ms, max deviation: " << std::chrono::duration<double, std::milli>(stats.maxDeviation).count()
+              << " ms\n";
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "paged_memory.h"
+
+#include <cstring>
+
+using namespace chip8;
+
+namespace
+{
+using video_pages_t = std::bitset<PagedMachine::VIDEO_PAGES>;
+
+/// Pages covered by a member of MachineState that lies in the framebuffers
+video_pages_t VideoPages(u32 offset, u32 size)
+{
+    video_pages_t pages;
+    for (u32 page = (offset - PagedMachine::VIDEO_OFFSET) / MEMORY_PAGE_SIZE;
+         page <= (offset - PagedMachine::VIDEO_OFFSET + size - 1) / MEMORY_PAGE_SIZE;
+         ++page)
+    {
+        pages.set(page);
+    }
+    return pages;
+}
+
+const video_pages_t LORES_PAGES = VideoPages(offsetof(MachineState, video), sizeof(video_mem_t)) |
+                                  VideoPages(offsetof(MachineState, video2), sizeof(video_mem_t));
+const video_pages_t HIRES_PAGES = VideoPages(offsetof(MachineState, hiresVideo), sizeof(hires_video_t)) |
+                                  VideoPages(offsetof(MachineState, hiresVideo2), sizeof(hires_video_t));
+
+PagedMachine::PagedVideo::bytes_t VideoOf(const MachineState& state)
+{
+    return PagedMachine::PagedVideo::bytes_t(
+        reinterpret_cast<const u8*>(&state) + PagedMachine::VIDEO_OFFSET, PagedMachine::VIDEO_SIZE);
+}
+}  // namespace
+
+template <u32 PAGES>
+PagedBytes<PAGES>::PagedBytes(bytes_t bytes) : table(std::make_shared<table_t>())
+{
+    for (u32 page = 0; page < PAGES; ++page)
+    {
+        (*table)[page] = std::make_shared<page_t>();
+        std::memcpy((*table)[page]->data(), bytes.data() + page * MEMORY_PAGE_SIZE, MEMORY_PAGE_SIZE);
+    }
+}
+
+template <u32 PAGES>
+PagedBytes<PAGES>::PagedBytes(bytes_t bytes, const PagedBytes& base) : table(base.table)
+{
+    Update(bytes, std::bitset<PAGES>().set());
+}
+
+template <u32 PAGES>
+void PagedBytes<PAGES>::CopyTo(std::span<u8, PAGES * MEMORY_PAGE_SIZE> bytes) const
+{
+    for (u32 page = 0; page < PAGES; ++page)
+    {
+        std::memcpy(bytes.data() + page * MEMORY_PAGE_SIZE, (*table)[page]->data(), MEMORY_PAGE_SIZE);
+    }
+}
+
+template <u32 PAGES>
+typename PagedBytes<PAGES>::page_t& PagedBytes<PAGES>::Writable(u32 page)
+{
+    if (table.use_count() > 1)
+    {
+        table = std::make_shared<table_t>(*table);
+    }
+
+    std::shared_ptr<page_t>& pointer = (*table)[page];
+    if (pointer.use_count() > 1)
+    {
+        pointer = std::make_shared<page_t>(*pointer);
+    }
+    return *pointer;
+}
+
+template <u32 PAGES>
+void PagedBytes<PAGES>::Update(bytes_t bytes, const std::bitset<PAGES>& written)
+{
+    for (u32 page = 0; page < PAGES; ++page)
+    {
+        const u8* contents = bytes.data() + page * MEMORY_PAGE_SIZE;
+
+        if (written[page] && std::memcmp((*table)[page]->data(), contents, MEMORY_PAGE_SIZE) != 0)
+        {
+            std::memcpy(Writable(page).data(), contents, MEMORY_PAGE_SIZE);
+        }
+    }
+}
+
+template <u32 PAGES>
+void PagedBytes<PAGES>::Write(u32 address, u8 value)
+{
+    if (Read(address) != value)
+    {
+        Writable(address / MEMORY_PAGE_SIZE)[address % MEMORY_PAGE_SIZE] = value;
+    }
+}
+
+template class chip8::PagedBytes<MEMORY_PAGES>;
+template class chip8::PagedBytes<PagedMachine::VIDEO_PAGES>;
+
+PagedMachine::PagedMachine(const MachineState& state) : video(VideoOf(state)), memory(state.memory)
+{
+    std::memcpy(head.data(), &state, head.size());
+}
+
+PagedMachine::PagedMachine(const MachineState& state, const PagedMachine& base) :
+    video(VideoOf(state), base.video), memory(state.memory, base.memory)
+{
+    std::memcpy(head.data(), &state, head.size());
+}
+
+void PagedMachine::LoadInto(Chip8& chip8) const
+{
+    std::memcpy(static_cast<MachineState*>(&chip8), head.data(), head.size());
+    u8* framebuffers = reinterpret_cast<u8*>(static_cast<MachineState*>(&chip8)) + VIDEO_OFFSET;
+    video.CopyTo(std::span<u8, VIDEO_SIZE>(framebuffers, VIDEO_SIZE));
+    memory.CopyTo(chip8.memory);
+
+    chip8.InvalidateDecodeCache();
+    chip8.writtenPages.reset();
+    chip8.loresWritten = false;
+    chip8.hiresWritten = false;
+}
+
+void PagedMachine::SaveFrom(const Chip8& chip8)
+{
+    std::memcpy(head.data(), static_cast<const MachineState*>(&chip8), head.size());
+
+    const video_pages_t written = (chip8.loresWritten ? LORES_PAGES : video_pages_t()) |
+                                  (chip8.hiresWritten ? HIRES_PAGES : video_pages_t());
+    if (written.any())
+    {
+        video.Update(VideoOf(chip8), written);
+    }
+    memory.Update(chip8.memory, chip8.writtenPages);
+}
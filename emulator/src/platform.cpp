@@ -26,14 +26,19 @@
 
 using namespace chip8;
 
-Platform::Platform(
-    char const* title, int windowWidth, int windowHeight, int textureWidth, int textureHeight, int cycleTime)
+Platform::Platform(char const* title,
+                   int windowWidth,
+                   int windowHeight,
+                   int textureWidth,
+                   int textureHeight,
+                   int cycleTime,
+                   bool vsync)
 {
     SDL_Init(SDL_INIT_VIDEO);
 
     window = SDL_CreateWindow(title, 100, 100, windowWidth, windowHeight, SDL_WINDOW_SHOWN);
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
 
     texture =
         SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, textureWidth, textureHeight);
@@ -91,6 +96,11 @@ bool Platform::ProcessInput(uint8_t* keys)
                     }
                     break;
 
+                    case SDLK_BACKSPACE: {
+                        rewindHeld = true;
+                    }
+                    break;
+
                     case SDLK_x: {
                         keys[0] = 1;
                     }
@@ -177,6 +187,11 @@ bool Platform::ProcessInput(uint8_t* keys)
             case SDL_KEYUP: {
                 switch (event.key.keysym.sym)
                 {
+                    case SDLK_BACKSPACE: {
+                        rewindHeld = false;
+                    }
+                    break;
+
                     case SDLK_x: {
                         keys[0] = 0;
                     }
@@ -0,0 +1,220 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "rewind.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace chip8;
+
+namespace
+{
+constexpr std::size_t WORDS = sizeof(MachineState) / sizeof(u64);
+
+static_assert(sizeof(MachineState) % sizeof(u64) == 0, "The state is compared word by word");
+
+/// A delta is a sequence of (unchanged words, changed words) runs, each followed by the XOR of the changed words. Run
+/// lengths are LEB128 varints, at most 5 bytes for 32 bits.
+constexpr std::size_t MAX_DELTA_SIZE = WORDS * sizeof(u64) + (WORDS + 1) * 2 * 5;
+
+u64 Word(const MachineState& state, std::size_t i)
+{
+    u64 word;
+    std::memcpy(&word, reinterpret_cast<const u8*>(&state) + i * sizeof(u64), sizeof(word));
+    return word;
+}
+
+u8* PutVarint(u8* out, std::size_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = static_cast<u8>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<u8>(value);
+    return out;
+}
+
+const u8* GetVarint(const u8* in, std::size_t& value)
+{
+    value = 0;
+    for (u32 shift = 0;; shift += 7)
+    {
+        const u8 byte = *in++;
+        value |= static_cast<std::size_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return in;
+        }
+    }
+}
+
+/// Encode the XOR of both states, returns the end of the delta
+u8* Encode(const MachineState& from, const MachineState& to, u8* out)
+{
+    std::size_t i = 0;
+    while (i < WORDS)
+    {
+        const std::size_t unchanged = i;
+        while (i < WORDS && Word(from, i) == Word(to, i))
+        {
+            ++i;
+        }
+
+        const std::size_t changed = i;
+        while (i < WORDS && Word(from, i) != Word(to, i))
+        {
+            ++i;
+        }
+
+        out = PutVarint(out, changed - unchanged);
+        out = PutVarint(out, i - changed);
+        for (std::size_t j = changed; j < i; ++j)
+        {
+            const u64 delta = Word(from, j) ^ Word(to, j);
+            std::memcpy(out, &delta, sizeof(delta));
+            out += sizeof(delta);
+        }
+    }
+    return out;
+}
+
+/// XOR a delta into the state, which turns either of the two states it was encoded from into the other one
+void Apply(const u8* in, const u8* end, MachineState& state)
+{
+    auto* words = reinterpret_cast<u8*>(&state);
+    std::size_t i = 0;
+
+    while (in < end)
+    {
+        std::size_t unchanged;
+        std::size_t changed;
+        in = GetVarint(in, unchanged);
+        in = GetVarint(in, changed);
+        i += unchanged;
+
+        for (; changed > 0; --changed, ++i, in += sizeof(u64))
+        {
+            u64 word;
+            u64 delta;
+            std::memcpy(&word, words + i * sizeof(u64), sizeof(word));
+            std::memcpy(&delta, in, sizeof(delta));
+            word ^= delta;
+            std::memcpy(words + i * sizeof(u64), &word, sizeof(word));
+        }
+    }
+}
+}  // namespace
+
+Rewind::Rewind(std::size_t capacity) : ring(capacity), newest(std::make_unique<MachineState>()), scratch(MAX_DELTA_SIZE)
+{
+}
+
+void Rewind::Write(std::size_t position, const u8* data, std::size_t size)
+{
+    position %= ring.size();
+    const std::size_t first = std::min(size, ring.size() - position);
+    std::memcpy(ring.data() + position, data, first);
+    std::memcpy(ring.data(), data + first, size - first);
+}
+
+void Rewind::Read(std::size_t position, u8* data, std::size_t size) const
+{
+    position %= ring.size();
+    const std::size_t first = std::min(size, ring.size() - position);
+    std::memcpy(data, ring.data() + position, first);
+    std::memcpy(data + first, ring.data(), size - first);
+}
+
+void Rewind::DropOldest()
+{
+    size_field_t size;
+    Read(tail, reinterpret_cast<u8*>(&size), sizeof(size));
+
+    const std::size_t entry = size + 2 * sizeof(size_field_t);
+    tail = (tail + entry) % ring.size();
+    used -= entry;
+    --entries;
+}
+
+void Rewind::Record(const MachineState& state)
+{
+    if (!hasNewest)
+    {
+        *newest = state;
+        hasNewest = true;
+        return;
+    }
+
+    const auto size = static_cast<size_field_t>(Encode(state, *newest, scratch.data()) - scratch.data());
+    const std::size_t entry = size + 2 * sizeof(size_field_t);
+    *newest = state;
+
+    if (entry > ring.size())
+    {
+        // Not even this frame fits, so there is nothing to go back to
+        head = tail = used = entries = 0;
+        return;
+    }
+
+    while (ring.size() - used < entry)
+    {
+        DropOldest();
+    }
+
+    Write(head, reinterpret_cast<const u8*>(&size), sizeof(size));
+    Write(head + sizeof(size), scratch.data(), size);
+    Write(head + sizeof(size) + size, reinterpret_cast<const u8*>(&size), sizeof(size));
+    head = (head + entry) % ring.size();
+    used += entry;
+    ++entries;
+}
+
+bool Rewind::StepBack(MachineState& state)
+{
+    if (entries == 0)
+    {
+        return false;
+    }
+
+    size_field_t size;
+    const std::size_t end = head + ring.size();
+    Read(end - sizeof(size), reinterpret_cast<u8*>(&size), sizeof(size));
+
+    const std::size_t entry = size + 2 * sizeof(size_field_t);
+    Read(end - sizeof(size) - size, scratch.data(), size);
+    Apply(scratch.data(), scratch.data() + size, *newest);
+
+    head = (end - entry) % ring.size();
+    used -= entry;
+    --entries;
+
+    state = *newest;
+    return true;
+}
+
+void Rewind::Clear()
+{
+    head = tail = used = entries = 0;
+    hasNewest = false;
+}
@@ -0,0 +1,140 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "runtime.h"
+
+chip8::Task& chip8::Task::operator=(Task&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+        handle = std::exchange(other.handle, {});
+    }
+    return *this;
+}
+
+chip8::Task::~Task()
+{
+    if (handle)
+    {
+        handle.destroy();
+    }
+}
+
+void chip8::Runtime::Spawn(Task task)
+{
+    ready.push_back(task.handle);
+    tasks.push_back(std::move(task));
+}
+
+void chip8::Runtime::Wake(std::coroutine_handle<> handle, u64 at)
+{
+    wheel[at % WHEEL_SIZE].push_back({at, handle});
+}
+
+void chip8::Runtime::Signal(InputEvent& event)
+{
+    if (event.waiter)
+    {
+        ready.push_back(std::exchange(event.waiter, {}));
+    }
+    else
+    {
+        event.signalled = true;
+    }
+}
+
+void chip8::Runtime::RunFrame()
+{
+    // Timers of later rounds stay in the slot
+    auto& slot = wheel[frame % WHEEL_SIZE];
+    std::erase_if(slot, [this](const Timer& timer) {
+        if (timer.frame != frame)
+        {
+            return false;
+        }
+        ready.push_back(timer.handle);
+        return true;
+    });
+
+    // Tasks only wait for later frames or events, a signal from a task runs its waiter in this frame too
+    while (!ready.empty())
+    {
+        running.swap(ready);
+        for (const auto handle : running)
+        {
+            handle.resume();
+        }
+        resumes += running.size();
+        running.clear();
+    }
+
+    ++frame;
+}
+
+chip8::Emulator::Emulator(Runtime& runtime, const Chip8& machine, u32 instructionsPerFrame) :
+    chip8(machine),
+    scheduler(chip8, instructionsPerFrame),
+    runtime(runtime)
+{
+}
+
+void chip8::Emulator::SetKeys(const keypad_t& pressed)
+{
+    keys = pressed;
+    runtime.Signal(input);
+}
+
+void chip8::Emulator::CatchUp()
+{
+    // The keys didn't change while the task waited, so the machine stayed in its idle loop
+    scheduler.RunFrames(runtime.Frame() - start - scheduler.frames);
+}
+
+chip8::Task chip8::Emulator::Run()
+{
+    start = runtime.Frame() - scheduler.frames;
+    while (true)
+    {
+        CatchUp();
+        chip8.keypad = keys;
+        input.signalled = false;
+
+        const u64 idle = scheduler.IdleFrames();
+        if (idle == Scheduler::IDLE_FOREVER)
+        {
+            co_await runtime.Wait(input);
+        }
+        else if (idle > 0)
+        {
+            co_await runtime.Sleep(idle);
+        }
+        else
+        {
+            scheduler.RunFrame();
+            co_await runtime.NextFrame();
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "save_state.h"
+
+#include <fstream>
+#include <memory>
+#include <new>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace chip8;
+
+namespace
+{
+constexpr std::size_t FILE_SIZE = sizeof(SaveStateHeader) + sizeof(MachineState);
+}  // namespace
+
+bool chip8::SaveState(const Chip8& chip8, std::string_view filename)
+{
+    std::ofstream file(filename.data(), std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    SaveStateHeader header;
+    header.variant = chip8.variant;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(static_cast<const MachineState*>(&chip8)), sizeof(MachineState));
+
+    return file.good();
+}
+
+bool chip8::LoadState(Chip8& chip8, std::string_view filename)
+{
+    std::ifstream file(filename.data(), std::ios::binary);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    SaveStateHeader header;
+    auto state = std::make_unique<MachineState>();
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    file.read(reinterpret_cast<char*>(state.get()), sizeof(MachineState));
+
+    if (!file || !header.Valid())
+    {
+        return false;
+    }
+
+    chip8.Restore(*state);
+    chip8.variant = header.variant;
+
+    return true;
+}
+
+MappedSaveState::MappedSaveState(std::string_view filename)
+{
+#if defined(__unix__)
+    const int fd = open(filename.data(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat status{};
+    if (fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) >= FILE_SIZE)
+    {
+        // Mappings start at a page boundary, which keeps the state aligned
+        mapping = mmap(nullptr, FILE_SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            mapping = nullptr;
+        }
+    }
+    close(fd);
+
+    if (mapping == nullptr)
+    {
+        return;
+    }
+    size = FILE_SIZE;
+#else
+    std::ifstream file(filename.data(), std::ios::binary);
+
+    if (!file.is_open())
+    {
+        return;
+    }
+
+    mapping = ::operator new(FILE_SIZE, std::align_val_t{alignof(MachineState)});
+    file.read(static_cast<char*>(mapping), FILE_SIZE);
+
+    if (!file)
+    {
+        ::operator delete(mapping, std::align_val_t{alignof(MachineState)});
+        mapping = nullptr;
+        return;
+    }
+    size = FILE_SIZE;
+#endif
+
+    const auto* mapped = static_cast<const SaveStateHeader*>(mapping);
+    if (mapped->Valid())
+    {
+        header = mapped;
+    }
+}
+
+MappedSaveState::~MappedSaveState()
+{
+    if (mapping == nullptr)
+    {
+        return;
+    }
+
+#if defined(__unix__)
+    munmap(mapping, size);
+#else
+    ::operator delete(mapping, std::align_val_t{alignof(MachineState)});
+#endif
+}
@@ -0,0 +1,184 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "scheduler.h"
+
+#include <algorithm>
+
+#include "decode.h"
+
+using namespace chip8;
+
+namespace
+{
+/// <summary>
+/// Loop that the machine can't leave within a frame, because the timers and the keypad only change between frames
+/// </summary>
+struct IdleLoop
+{
+    /// Address of the first instruction
+    u16 head{};
+    /// Number of instructions, zero if the machine isn't in an idle loop
+    u8 length{};
+    /// Index of the instruction at pc
+    u8 position{};
+    /// Register that a delay timer poll loads the timer into
+    u8 x{};
+    /// Number of frames the machine stays in the loop
+    u64 frames{};
+};
+
+Instruction Fetch(const Chip8& c, u32 address)
+{
+    address &= MEMORY_SIZE - 1;
+    return DECODE_TABLE[(c.memory[address] << 8u) | c.memory[(address + 1) & (MEMORY_SIZE - 1)]];
+}
+
+IdleLoop FindIdleLoop(const Chip8& c)
+{
+    const Instruction current = Fetch(c, c.pc);
+
+    if (current.op == Op::OP_1nnn && current.nnn == c.pc)
+    {
+        return {c.pc, 1, 0, 0, Scheduler::IDLE_FOREVER};
+    }
+
+    if (current.op == Op::OP_Fx0A)
+    {
+        if (std::any_of(c.keypad.begin(), c.keypad.end(), [](u8 key) { return key != 0; }))
+        {
+            return {};
+        }
+
+        return {c.pc, 1, 0, 0, Scheduler::IDLE_FOREVER};
+    }
+
+    // Fx07; 3xkk; 1nnn with pc on any of the three
+    for (u8 position = 0; position < 3; ++position)
+    {
+        const u16 head = c.pc - 2 * position;
+        const Instruction load = Fetch(c, head);
+        const Instruction compare = Fetch(c, head + 2);
+        const Instruction jump = Fetch(c, head + 4);
+
+        if (load.op != Op::OP_Fx07 || compare.op != Op::OP_3xkk || compare.x != load.x || jump.op != Op::OP_1nnn ||
+            jump.nnn != head)
+        {
+            continue;
+        }
+
+        // Leaves in this frame if the timer has the value, or if the next skip sees the value loaded before
+        if (c.delayTimer == compare.kk || (position == 1 && c.registers[load.x] == compare.kk))
+        {
+            return {};
+        }
+
+        // The timer stops at zero, so it never reaches a larger value
+        const u64 frames = c.delayTimer > compare.kk ? c.delayTimer - compare.kk : Scheduler::IDLE_FOREVER;
+        return {head, 3, position, load.x, frames};
+    }
+
+    return {};
+}
+}  // namespace
+
+Scheduler::Scheduler(Chip8& chip8, u32 instructionsPerFrame) : instructionsPerFrame(instructionsPerFrame), chip8(chip8)
+{
+    chip8.timing = Timing::Frame;
+}
+
+void Scheduler::RunFrame()
+{
+    RunFrames(1);
+}
+
+void Scheduler::RunFrames(u64 count)
+{
+    while (count > 0)
+    {
+        const IdleLoop loop = fastForward && frameExecuted == 0 ? FindIdleLoop(chip8) : IdleLoop{};
+
+        // With fewer instructions than the loop has, a frame may not reload the timer, which the skip relies on
+        if (loop.length == 0 || instructionsPerFrame < loop.length)
+        {
+            chip8.Run(instructionsPerFrame - std::min<u64>(frameExecuted, instructionsPerFrame));
+            chip8.TickTimers();
+            frameExecuted = 0;
+            ++frames;
+            --count;
+            continue;
+        }
+
+        // Every iteration of the loop leaves the same state behind, except for the position in the loop and the timer
+        // value loaded last. Every skipped frame loads the timer at least once, so the last one leaves its value.
+        const u64 skipped = std::min(loop.frames, count);
+        const u64 executed = (skipped % loop.length) * (instructionsPerFrame % loop.length);
+        const u64 position = (loop.position + executed) % loop.length;
+
+        chip8.TickTimers(static_cast<u32>(std::min<u64>(skipped - 1, std::numeric_limits<u8>::max())));
+        chip8.pc = loop.head + 2 * position;
+
+        if (loop.length > 1)
+        {
+            chip8.registers[loop.x] = chip8.delayTimer;
+        }
+
+        chip8.TickTimers();
+        frames += skipped;
+        count -= skipped;
+    }
+}
+
+RunResult Scheduler::RunUntil(stop_mask_t stopOn)
+{
+    const RunResult result =
+        chip8.RunUntil(stopOn, instructionsPerFrame - std::min<u64>(frameExecuted, instructionsPerFrame));
+    frameExecuted += result.executed;
+
+    if (result.reason != StopReason::Budget)
+    {
+        return result;
+    }
+
+    chip8.TickTimers();
+    frameExecuted = 0;
+    ++frames;
+
+    return {StopReason::FrameEnd, result.executed};
+}
+
+u64 Scheduler::IdleFrames() const
+{
+    return FindIdleLoop(chip8).frames;
+}
+
+u64 Scheduler::Advance(std::chrono::nanoseconds elapsed)
+{
+    pending += elapsed;
+
+    const auto count = std::chrono::floor<frames_t>(pending);
+    pending -= count;
+
+    RunFrames(count.count());
+
+    return count.count();
+}
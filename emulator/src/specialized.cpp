@@ -0,0 +1,453 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "specialized.h"
+
+#include <array>
+#include <utility>
+
+#include "decode.h"
+#include "instructions.h"
+
+using namespace chip8;
+using specialized::handler_t;
+
+namespace
+{
+constexpr u8 KK(u16 opcode)
+{
+    return opcode & 0x00FFu;
+}
+
+constexpr u8 N(u16 opcode)
+{
+    return opcode & 0x000Fu;
+}
+
+// Handlers of the x-indexed groups
+
+template <u8 X>
+struct OP_3xkk
+{
+    static void Run(Chip8& c, u16 opcode) { ops::OP_3xkk(c, X, KK(opcode)); }
+};
+
+template <u8 X>
+struct OP_4xkk
+{
+    static void Run(Chip8& c, u16 opcode) { ops::OP_4xkk(c, X, KK(opcode)); }
+};
+
+template <u8 X>
+struct OP_6xkk
+{
+    static void Run(Chip8& c, u16 opcode) { ops::OP_6xkk(c, X, KK(opcode)); }
+};
+
+template <u8 X>
+struct OP_7xkk
+{
+    static void Run(Chip8& c, u16 opcode) { ops::OP_7xkk(c, X, KK(opcode)); }
+};
+
+template <u8 X>
+struct OP_Cxkk
+{
+    static void Run(Chip8& c, u16 opcode) { ops::OP_Cxkk(c, X, KK(opcode)); }
+};
+
+template <u8 X>
+struct OP_Ex9E
+{
+    static void Run(Chip8& c, u16) { ops::OP_Ex9E(c, X); }
+};
+
+template <u8 X>
+struct OP_ExA1
+{
+    static void Run(Chip8& c, u16) { ops::OP_ExA1(c, X); }
+};
+
+template <u8 X>
+struct OP_Fx07
+{
+    static void Run(Chip8& c, u16) { ops::OP_Fx07(c, X); }
+};
+
+template <u8 X>
+struct OP_Fx0A
+{
+    static void Run(Chip8& c, u16) { ops::OP_Fx0A(c, X); }
+};
+
+template <u8 X>
+struct OP_Fx15
+{
+    static void Run(Chip8& c, u16) { ops::OP_Fx15(c, X); }
+};
+
+template <u8 X>
+struct OP_Fx18
+{
+    static void Run(Chip8& c, u16) { ops::OP_Fx18(c, X); }
+};
+
+template <u8 X>
+struct OP_Fx1E
+{
+    static void Run(Chip8& c, u16) { ops::OP_Fx1E(c, X); }
+};
+
+template <u8 X>
+struct OP_Fx29
+{
+    static void Run(Chip8& c, u16) { ops::OP_Fx29(c, X); }
+};
+
+template <u8 X>
+struct OP_Fx33
+{
+    static void Run(Chip8& c, u16) { ops::OP_Fx33(c, X); }
+};
+
+template <u8 X>
+struct OP_Fx55
+{
+    static void Run(Chip8& c, u16) { ops::OP_Fx55(c, X); }
+};
+
+template <u8 X>
+struct OP_Fx65
+{
+    static void Run(Chip8& c, u16) { ops::OP_Fx65(c, X); }
+};
+
+// Handlers indexed by x and y
+
+template <u8 X, u8 Y>
+struct OP_5xy0
+{
+    static void Run(Chip8& c, u16) { ops::OP_5xy0(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_8xy0
+{
+    static void Run(Chip8& c, u16) { ops::OP_8xy0(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_8xy1
+{
+    static void Run(Chip8& c, u16) { ops::OP_8xy1(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_8xy2
+{
+    static void Run(Chip8& c, u16) { ops::OP_8xy2(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_8xy3
+{
+    static void Run(Chip8& c, u16) { ops::OP_8xy3(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_8xy4
+{
+    static void Run(Chip8& c, u16) { ops::OP_8xy4(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_8xy5
+{
+    static void Run(Chip8& c, u16) { ops::OP_8xy5(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_8xy6
+{
+    static void Run(Chip8& c, u16) { ops::OP_8xy6(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_8xy7
+{
+    static void Run(Chip8& c, u16) { ops::OP_8xy7(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_8xyE
+{
+    static void Run(Chip8& c, u16) { ops::OP_8xyE(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_9xy0
+{
+    static void Run(Chip8& c, u16) { ops::OP_9xy0(c, X, Y); }
+};
+
+template <u8 X, u8 Y>
+struct OP_Dxyn
+{
+    static void Run(Chip8& c, u16 opcode) { ops::OP_Dxyn(c, X, Y, N(opcode)); }
+};
+
+using x_table_t = std::array<handler_t, 16>;
+using xy_table_t = std::array<handler_t, 256>;
+
+template <template <u8> class Handler, size_t... X>
+constexpr x_table_t MakeXTable(std::index_sequence<X...>)
+{
+    return {&Handler<X>::Run...};
+}
+
+template <template <u8> class Handler>
+constexpr x_table_t MakeXTable()
+{
+    return MakeXTable<Handler>(std::make_index_sequence<16>());
+}
+
+/// Indexed by (x << 4) | y, which are bits 4 to 11 of the opcode
+template <template <u8, u8> class Handler, size_t... XY>
+constexpr xy_table_t MakeXYTable(std::index_sequence<XY...>)
+{
+    return {&Handler<(XY >> 4u), (XY & 0xFu)>::Run...};
+}
+
+template <template <u8, u8> class Handler>
+constexpr xy_table_t MakeXYTable()
+{
+    return MakeXYTable<Handler>(std::make_index_sequence<256>());
+}
+
+constexpr x_table_t TABLE_3xkk = MakeXTable<OP_3xkk>();
+constexpr x_table_t TABLE_4xkk = MakeXTable<OP_4xkk>();
+constexpr x_table_t TABLE_6xkk = MakeXTable<OP_6xkk>();
+constexpr x_table_t TABLE_7xkk = MakeXTable<OP_7xkk>();
+constexpr x_table_t TABLE_Cxkk = MakeXTable<OP_Cxkk>();
+constexpr x_table_t TABLE_Ex9E = MakeXTable<OP_Ex9E>();
+constexpr x_table_t TABLE_ExA1 = MakeXTable<OP_ExA1>();
+constexpr x_table_t TABLE_Fx07 = MakeXTable<OP_Fx07>();
+constexpr x_table_t TABLE_Fx0A = MakeXTable<OP_Fx0A>();
+constexpr x_table_t TABLE_Fx15 = MakeXTable<OP_Fx15>();
+constexpr x_table_t TABLE_Fx18 = MakeXTable<OP_Fx18>();
+constexpr x_table_t TABLE_Fx1E = MakeXTable<OP_Fx1E>();
+constexpr x_table_t TABLE_Fx29 = MakeXTable<OP_Fx29>();
+constexpr x_table_t TABLE_Fx33 = MakeXTable<OP_Fx33>();
+constexpr x_table_t TABLE_Fx55 = MakeXTable<OP_Fx55>();
+constexpr x_table_t TABLE_Fx65 = MakeXTable<OP_Fx65>();
+
+constexpr xy_table_t TABLE_5xy0 = MakeXYTable<OP_5xy0>();
+constexpr xy_table_t TABLE_9xy0 = MakeXYTable<OP_9xy0>();
+constexpr xy_table_t TABLE_Dxyn = MakeXYTable<OP_Dxyn>();
+
+constexpr xy_table_t TABLE_8xy0 = MakeXYTable<OP_8xy0>();
+constexpr xy_table_t TABLE_8xy1 = MakeXYTable<OP_8xy1>();
+constexpr xy_table_t TABLE_8xy2 = MakeXYTable<OP_8xy2>();
+constexpr xy_table_t TABLE_8xy3 = MakeXYTable<OP_8xy3>();
+constexpr xy_table_t TABLE_8xy4 = MakeXYTable<OP_8xy4>();
+constexpr xy_table_t TABLE_8xy5 = MakeXYTable<OP_8xy5>();
+constexpr xy_table_t TABLE_8xy6 = MakeXYTable<OP_8xy6>();
+constexpr xy_table_t TABLE_8xy7 = MakeXYTable<OP_8xy7>();
+constexpr xy_table_t TABLE_8xyE = MakeXYTable<OP_8xyE>();
+}  // namespace
+
+void specialized::Execute(Chip8& chip8, u16 opcode)
+{
+    // DECODE_TABLE picks the handler, so this engine decodes exactly like the others. The specialised tables are
+    // indexed by the decoded registers.
+    const auto [op, x, y, n, kk, nnn] = DECODE_TABLE[opcode];
+    const u8 xy = static_cast<u8>((x << 4u) | y);
+
+    switch (op)
+    {
+        case Op::OP_NOP:
+        case Op::OP_UNDECODED:
+            break;
+        case Op::OP_00E0:
+            ops::OP_00E0(chip8);
+            break;
+        case Op::OP_00EE:
+            ops::OP_00EE(chip8);
+            break;
+        case Op::OP_1nnn:
+            ops::OP_1nnn(chip8, nnn);
+            break;
+        case Op::OP_2nnn:
+            ops::OP_2nnn(chip8, nnn);
+            break;
+        case Op::OP_3xkk:
+            TABLE_3xkk[x](chip8, opcode);
+            break;
+        case Op::OP_4xkk:
+            TABLE_4xkk[x](chip8, opcode);
+            break;
+        case Op::OP_5xy0:
+            TABLE_5xy0[xy](chip8, opcode);
+            break;
+        case Op::OP_6xkk:
+            TABLE_6xkk[x](chip8, opcode);
+            break;
+        case Op::OP_7xkk:
+            TABLE_7xkk[x](chip8, opcode);
+            break;
+        case Op::OP_8xy0:
+            TABLE_8xy0[xy](chip8, opcode);
+            break;
+        case Op::OP_8xy1:
+            TABLE_8xy1[xy](chip8, opcode);
+            break;
+        case Op::OP_8xy2:
+            TABLE_8xy2[xy](chip8, opcode);
+            break;
+        case Op::OP_8xy3:
+            TABLE_8xy3[xy](chip8, opcode);
+            break;
+        case Op::OP_8xy4:
+            TABLE_8xy4[xy](chip8, opcode);
+            break;
+        case Op::OP_8xy5:
+            TABLE_8xy5[xy](chip8, opcode);
+            break;
+        case Op::OP_8xy6:
+            TABLE_8xy6[xy](chip8, opcode);
+            break;
+        case Op::OP_8xy7:
+            TABLE_8xy7[xy](chip8, opcode);
+            break;
+        case Op::OP_8xyE:
+            TABLE_8xyE[xy](chip8, opcode);
+            break;
+        case Op::OP_9xy0:
+            TABLE_9xy0[xy](chip8, opcode);
+            break;
+        case Op::OP_Annn:
+            ops::OP_Annn(chip8, nnn);
+            break;
+        case Op::OP_Bnnn:
+            ops::OP_Bnnn(chip8, nnn);
+            break;
+        case Op::OP_Cxkk:
+            TABLE_Cxkk[x](chip8, opcode);
+            break;
+        case Op::OP_Dxyn:
+            TABLE_Dxyn[xy](chip8, opcode);
+            break;
+        case Op::OP_Ex9E:
+            TABLE_Ex9E[x](chip8, opcode);
+            break;
+        case Op::OP_ExA1:
+            TABLE_ExA1[x](chip8, opcode);
+            break;
+        case Op::OP_Fx07:
+            TABLE_Fx07[x](chip8, opcode);
+            break;
+        case Op::OP_Fx0A:
+            TABLE_Fx0A[x](chip8, opcode);
+            break;
+        case Op::OP_Fx15:
+            TABLE_Fx15[x](chip8, opcode);
+            break;
+        case Op::OP_Fx18:
+            TABLE_Fx18[x](chip8, opcode);
+            break;
+        case Op::OP_Fx1E:
+            TABLE_Fx1E[x](chip8, opcode);
+            break;
+        case Op::OP_Fx29:
+            TABLE_Fx29[x](chip8, opcode);
+            break;
+        case Op::OP_Fx33:
+            TABLE_Fx33[x](chip8, opcode);
+            break;
+        case Op::OP_Fx55:
+            TABLE_Fx55[x](chip8, opcode);
+            break;
+        case Op::OP_Fx65:
+            TABLE_Fx65[x](chip8, opcode);
+            break;
+        case Op::OP_00Cn:
+            ops::OP_00Cn(chip8, n);
+            break;
+        case Op::OP_00FB:
+            ops::OP_00FB(chip8);
+            break;
+        case Op::OP_00FC:
+            ops::OP_00FC(chip8);
+            break;
+        case Op::OP_00FD:
+            ops::OP_00FD(chip8);
+            break;
+        case Op::OP_00FE:
+            ops::OP_00FE(chip8);
+            break;
+        case Op::OP_00FF:
+            ops::OP_00FF(chip8);
+            break;
+        case Op::OP_Fx30:
+            ops::OP_Fx30(chip8, x);
+            break;
+        case Op::OP_Fx75:
+            ops::OP_Fx75(chip8, x);
+            break;
+        case Op::OP_Fx85:
+            ops::OP_Fx85(chip8, x);
+            break;
+        case Op::OP_00Dn:
+            ops::OP_00Dn(chip8, n);
+            break;
+        case Op::OP_5xy2:
+            ops::OP_5xy2(chip8, x, y);
+            break;
+        case Op::OP_5xy3:
+            ops::OP_5xy3(chip8, x, y);
+            break;
+        case Op::OP_F000:
+            ops::OP_F000(chip8);
+            break;
+        case Op::OP_Fn01:
+            ops::OP_Fn01(chip8, x);
+            break;
+        case Op::OP_F002:
+            ops::OP_F002(chip8);
+            break;
+        case Op::OP_Fx3A:
+            ops::OP_Fx3A(chip8, x);
+            break;
+        // Only produced by the IR, never by DECODE_TABLE
+        case Op::OP_8xy4_NF:
+        case Op::OP_8xy5_NF:
+        case Op::OP_8xy6_NF:
+        case Op::OP_8xy7_NF:
+        case Op::OP_8xyE_NF:
+        case Op::OP_Dxyn_NF:
+        case Op::OP_AnnnDxyn:
+        case Op::OP_AnnnDxyn_NF:
+        case Op::OP_7xkk3xkk1nnn:
+        case Op::OP_Fx073xkk1nnn:
+            break;
+    }
+}
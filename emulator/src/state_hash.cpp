@@ -0,0 +1,149 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "state_hash.h"
+
+#include <bit>
+#include <cstring>
+
+using namespace chip8;
+
+namespace
+{
+constexpr u64 K1 = 0x9E3779B97F4A7C15;
+constexpr u64 K2 = 0xBF58476D1CE4E5B9;
+constexpr u64 K3 = 0x94D049BB133111EB;
+
+/// Final mix of SplitMix64
+u64 Mix(u64 hash)
+{
+    hash = (hash ^ (hash >> 30)) * K2;
+    hash = (hash ^ (hash >> 27)) * K3;
+    return hash ^ (hash >> 31);
+}
+
+u64 Round(u64 hash, u64 word)
+{
+    return std::rotl(hash ^ (word * K1), 31) * K2;
+}
+
+u64 HashWords(const u8* data, std::size_t size, u64 seed)
+{
+    u64 hash = Mix(seed + K1);
+    for (std::size_t i = 0; i < size; i += sizeof(u64))
+    {
+        u64 word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = Round(hash, word);
+    }
+    return Mix(hash);
+}
+
+template <typename Array>
+u64 HashArray(const Array& array, u64 seed)
+{
+    static_assert(sizeof(Array) % sizeof(u64) == 0, "Hashed by words");
+    return HashWords(reinterpret_cast<const u8*>(array.data()), sizeof(Array), seed);
+}
+
+/// The small fields, field by field so that padding doesn't count. Cheaper to hash on every call than to track.
+u64 HashHead(const MachineState& state)
+{
+    u64 hash = Round(Mix(K3), static_cast<u64>(state.index) | static_cast<u64>(state.pc) << 16u |
+                                  static_cast<u64>(state.sp) << 32u | static_cast<u64>(state.delayTimer) << 40u |
+                                  static_cast<u64>(state.soundTimer) << 48u | static_cast<u64>(state.hires) << 56u);
+    hash = Round(hash, static_cast<u64>(state.planes) | static_cast<u64>(state.pitch) << 8u);
+    hash = Round(hash, HashArray(state.registers, 1));
+    hash = Round(hash, HashArray(state.stack, 2));
+    hash = Round(hash, HashArray(state.keypad, 3));
+    hash = Round(hash, HashArray(state.flagRegisters, 4));
+    hash = Round(hash, HashArray(state.audioPattern, 5));
+    return hash;
+}
+
+/// Both bitplanes of one display mode
+u64 HashLores(const MachineState& state)
+{
+    return Round(HashArray(state.video, 6), HashArray(state.video2, 7));
+}
+
+u64 HashHires(const MachineState& state)
+{
+    return Round(HashArray(state.hiresVideo, 8), HashArray(state.hiresVideo2, 9));
+}
+
+u64 HashPage(const MachineState& state, u32 page)
+{
+    return HashWords(state.memory.data() + page * MEMORY_PAGE_SIZE, MEMORY_PAGE_SIZE, K2 + page);
+}
+
+u64 Combine(u64 head, u64 lores, u64 hires, u64 memory)
+{
+    return Mix(head ^ std::rotl(lores, 16) ^ std::rotl(hires, 32) ^ std::rotl(memory, 48));
+}
+}  // namespace
+
+u64 chip8::HashState(const MachineState& state)
+{
+    u64 memory = 0;
+    for (u32 page = 0; page < MEMORY_PAGES; ++page)
+    {
+        memory ^= HashPage(state, page);
+    }
+
+    return Combine(HashHead(state), HashLores(state), HashHires(state), memory);
+}
+
+u64 Chip8::StateHash()
+{
+#ifdef CHIP8_STATE_HASH
+    if (!hashedPages.all())
+    {
+        for (u32 page = 0; page < MEMORY_PAGES; ++page)
+        {
+            if (!hashedPages[page])
+            {
+                const u64 hash = HashPage(*this, page);
+                memoryHash ^= pageHashes[page] ^ hash;
+                pageHashes[page] = hash;
+            }
+        }
+        hashedPages.set();
+    }
+
+    if (!loresHashed)
+    {
+        loresHash = HashLores(*this);
+        loresHashed = true;
+    }
+
+    if (!hiresHashed)
+    {
+        hiresHash = HashHires(*this);
+        hiresHashed = true;
+    }
+
+    return Combine(HashHead(*this), loresHash, hiresHash, memoryHash);
+#else
+    return HashState(*this);
+#endif
+}
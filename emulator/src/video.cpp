@@ -0,0 +1,304 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "video.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "emulator.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace chip8;
+
+namespace
+{
+#if defined(__AVX2__)
+/// Eight pixels per step: broadcast a byte of the row, keep one bit per lane and widen it to a full lane
+void ExpandRow(u64 row, u32* rgba)
+{
+    const __m256i bits = _mm256_setr_epi32(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+
+    for (u32 i = 0; i < VIDEO_WIDTH / 8; ++i)
+    {
+        const int byte = static_cast<int>((row >> (VIDEO_WIDTH - 8 - 8 * i)) & 0xFFu);
+        const __m256i lanes = _mm256_and_si256(_mm256_set1_epi32(byte), bits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + 8 * i), _mm256_cmpeq_epi32(lanes, bits));
+    }
+}
+#elif defined(__SSE2__)
+/// Four pixels per step: broadcast a nibble of the row, keep one bit per lane and widen it to a full lane
+void ExpandRow(u64 row, u32* rgba)
+{
+    const __m128i bits = _mm_setr_epi32(0x8, 0x4, 0x2, 0x1);
+
+    for (u32 i = 0; i < VIDEO_WIDTH / 4; ++i)
+    {
+        const int nibble = static_cast<int>((row >> (VIDEO_WIDTH - 4 - 4 * i)) & 0xFu);
+        const __m128i lanes = _mm_and_si128(_mm_set1_epi32(nibble), bits);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + 4 * i), _mm_cmpeq_epi32(lanes, bits));
+    }
+}
+#else
+void ExpandRow(u64 row, u32* rgba)
+{
+    for (u32 x = 0; x < VIDEO_WIDTH; ++x)
+    {
+        rgba[x] = (row & PixelMask(x)) ? PIXEL_ON : PIXEL_OFF;
+    }
+}
+#endif
+
+static_assert(PIXEL_ON == UINT32_MAX && PIXEL_OFF == 0, "ExpandRow produces all ones and all zeros");
+
+/// Pixels of a row that is also drawn in the second bitplane, the rare case of XO-CHIP
+void ExpandRow(u64 row, u64 row2, u32* rgba)
+{
+    if (row2 == 0)
+    {
+        ExpandRow(row, rgba);
+        return;
+    }
+
+    constexpr u32 PALETTE[] = {PIXEL_OFF, PIXEL_ON, PIXEL_SECOND_PLANE, PIXEL_BOTH_PLANES};
+
+    for (u32 x = 0; x < 64; ++x)
+    {
+        const u32 colour = ((row & PixelMask(x)) ? 1u : 0u) | ((row2 & PixelMask(x)) ? 2u : 0u);
+        rgba[x] = PALETTE[colour];
+    }
+}
+
+/// Repeat every bit of the 32 pixels, so that they cover 64 pixels
+u64 DoublePixels(u32 pixels)
+{
+    u64 bits = pixels;
+    bits = (bits | (bits << 16u)) & 0x0000FFFF0000FFFFu;
+    bits = (bits | (bits << 8u)) & 0x00FF00FF00FF00FFu;
+    bits = (bits | (bits << 4u)) & 0x0F0F0F0F0F0F0F0Fu;
+    bits = (bits | (bits << 2u)) & 0x3333333333333333u;
+    bits = (bits | (bits << 1u)) & 0x5555555555555555u;
+    return bits | (bits << 1u);
+}
+
+/// Expand the low resolution bitplanes to the high resolution size, every pixel becomes 2x2 pixels
+void ExpandDoubled(const video_mem_t& video, const video_mem_t& video2, u32* rgba)
+{
+    for (u32 y = 0; y < VIDEO_HEIGHT; ++y)
+    {
+        u32* row = rgba + 2 * y * HIRES_WIDTH;
+        ExpandRow(DoublePixels(video[y] >> 32u), DoublePixels(video2[y] >> 32u), row);
+        ExpandRow(DoublePixels(video[y] & UINT32_MAX), DoublePixels(video2[y] & UINT32_MAX), row + 64);
+        std::memcpy(row + HIRES_WIDTH, row, HIRES_WIDTH * sizeof(u32));
+    }
+}
+
+constexpr u32 HIRES_WORDS = HIRES_WIDTH / 64;
+}  // namespace
+
+void chip8::ScrollDown(video_mem_t& video, u32 rows)
+{
+    rows = std::min(rows, VIDEO_HEIGHT);
+    std::move_backward(video.begin(), video.end() - rows, video.end());
+    std::fill(video.begin(), video.begin() + rows, 0);
+}
+
+void chip8::ScrollDown(hires_video_t& video, u32 rows)
+{
+    const u32 words = std::min(rows, HIRES_HEIGHT) * HIRES_WORDS;
+    std::move_backward(video.begin(), video.end() - words, video.end());
+    std::fill(video.begin(), video.begin() + words, 0);
+}
+
+void chip8::ScrollUp(video_mem_t& video, u32 rows)
+{
+    rows = std::min(rows, VIDEO_HEIGHT);
+    std::move(video.begin() + rows, video.end(), video.begin());
+    std::fill(video.end() - rows, video.end(), 0);
+}
+
+void chip8::ScrollUp(hires_video_t& video, u32 rows)
+{
+    const u32 words = std::min(rows, HIRES_HEIGHT) * HIRES_WORDS;
+    std::move(video.begin() + words, video.end(), video.begin());
+    std::fill(video.end() - words, video.end(), 0);
+}
+
+void chip8::ScrollRight(video_mem_t& video, u32 pixels)
+{
+    for (u64& row : video)
+    {
+        row >>= pixels;
+    }
+}
+
+void chip8::ScrollLeft(video_mem_t& video, u32 pixels)
+{
+    for (u64& row : video)
+    {
+        row <<= pixels;
+    }
+}
+
+#if defined(__SSE2__)
+// A whole row fits into one register: shift both words and carry the pixels that leave one word into the other
+
+void chip8::ScrollRight(hires_video_t& video, u32 pixels)
+{
+    const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(pixels));
+    const __m128i carryShift = _mm_cvtsi32_si128(static_cast<int>(64 - pixels));
+
+    for (u32 i = 0; i < video.size(); i += HIRES_WORDS)
+    {
+        auto* row = reinterpret_cast<__m128i*>(video.data() + i);
+        const __m128i words = _mm_loadu_si128(row);
+        const __m128i carry = _mm_slli_si128(_mm_sll_epi64(words, carryShift), 8);
+        _mm_storeu_si128(row, _mm_or_si128(_mm_srl_epi64(words, shift), carry));
+    }
+}
+
+void chip8::ScrollLeft(hires_video_t& video, u32 pixels)
+{
+    const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(pixels));
+    const __m128i carryShift = _mm_cvtsi32_si128(static_cast<int>(64 - pixels));
+
+    for (u32 i = 0; i < video.size(); i += HIRES_WORDS)
+    {
+        auto* row = reinterpret_cast<__m128i*>(video.data() + i);
+        const __m128i words = _mm_loadu_si128(row);
+        const __m128i carry = _mm_srli_si128(_mm_srl_epi64(words, carryShift), 8);
+        _mm_storeu_si128(row, _mm_or_si128(_mm_sll_epi64(words, shift), carry));
+    }
+}
+#else
+void chip8::ScrollRight(hires_video_t& video, u32 pixels)
+{
+    if (pixels == 0)
+    {
+        return;
+    }
+
+    for (u32 i = 0; i < video.size(); i += HIRES_WORDS)
+    {
+        video[i + 1] = (video[i + 1] >> pixels) | (video[i] << (64 - pixels));
+        video[i] >>= pixels;
+    }
+}
+
+void chip8::ScrollLeft(hires_video_t& video, u32 pixels)
+{
+    if (pixels == 0)
+    {
+        return;
+    }
+
+    for (u32 i = 0; i < video.size(); i += HIRES_WORDS)
+    {
+        video[i] = (video[i] << pixels) | (video[i + 1] >> (64 - pixels));
+        video[i + 1] <<= pixels;
+    }
+}
+#endif
+
+void chip8::ExpandToRgba(const video_mem_t& video, u32* rgba)
+{
+    for (u32 y = 0; y < VIDEO_HEIGHT; ++y)
+    {
+        ExpandRow(video[y], rgba + y * VIDEO_WIDTH);
+    }
+}
+
+void chip8::ExpandToRgba(const hires_video_t& video, u32* rgba)
+{
+    for (u32 i = 0; i < video.size(); ++i)
+    {
+        ExpandRow(video[i], rgba + 64 * i);
+    }
+}
+
+u64 chip8::FrameHash(const MachineState& state)
+{
+    constexpr u64 OFFSET_BASIS = 0xCBF29CE484222325;
+    constexpr u64 PRIME = 0x100000001B3;
+
+    u64 hash = OFFSET_BASIS;
+
+    auto add = [&hash](u64 word) {
+        for (u32 i = 0; i < sizeof(word); ++i)
+        {
+            hash = (hash ^ ((word >> (8 * i)) & 0xFFu)) * PRIME;
+        }
+    };
+
+    add(state.hires);
+
+    if (state.hires)
+    {
+        std::for_each(state.hiresVideo.begin(), state.hiresVideo.end(), add);
+        std::for_each(state.hiresVideo2.begin(), state.hiresVideo2.end(), add);
+    }
+    else
+    {
+        std::for_each(state.video.begin(), state.video.end(), add);
+        std::for_each(state.video2.begin(), state.video2.end(), add);
+    }
+
+    return hash;
+}
+
+bool RgbaFrame::Update(const MachineState& state)
+{
+    if (state.hires)
+    {
+        if (valid && hires && state.hiresVideo == expandedHires && state.hiresVideo2 == expandedHires2)
+        {
+            return false;
+        }
+
+        for (u32 i = 0; i < state.hiresVideo.size(); ++i)
+        {
+            ExpandRow(state.hiresVideo[i], state.hiresVideo2[i], pixels.data() + 64 * i);
+        }
+
+        expandedHires = state.hiresVideo;
+        expandedHires2 = state.hiresVideo2;
+    }
+    else
+    {
+        if (valid && !hires && state.video == expanded && state.video2 == expanded2)
+        {
+            return false;
+        }
+
+        ExpandDoubled(state.video, state.video2, pixels.data());
+        expanded = state.video;
+        expanded2 = state.video2;
+    }
+
+    hires = state.hires;
+    valid = true;
+
+    return true;
+}
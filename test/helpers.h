@@ -0,0 +1,215 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "emulator.h"
+#include "program.h"
+#include "types.h"
+
+namespace chip8::test
+{
+/// Executes the instruction at 0x204 once, overwrites it with Fx55 and then executes it again
+inline const program_t SELF_MODIFYING = {
+    0x6065,  // 200: LD V0, 65
+    0x6177,  // 202: LD V1, 77
+    0x6300,  // 204: LD V3, 0  -> becomes LD V5, 77
+    0x3201,  // 206: SE V2, 1
+    0x120C,  // 208: JP 20C
+    0x120A,  // 20A: JP 20A
+    0x6201,  // 20C: LD V2, 1
+    0xA204,  // 20E: LD I, 204
+    0xF155,  // 210: LD [I], V1
+    0x1204,  // 212: JP 204
+};
+
+/// Waits for the delay timer while reading it in the middle of a loop
+inline const program_t TIMERS = {
+    0x6A3C,  // 200: LD VA, 3C
+    0xFA15,  // 202: LD DT, VA
+    0xFA18,  // 204: LD ST, VA
+    0xF007,  // 206: LD V0, DT
+    0x7101,  // 208: ADD V1, 1
+    0xF207,  // 20A: LD V2, DT
+    0x3000,  // 20C: SE V0, 0
+    0x1206,  // 20E: JP 206
+    0x1210,  // 210: JP 210
+};
+
+/// Counted loop with arithmetic, drawing, BCD conversion and a subroutine call
+inline const program_t MIXED = {
+    0x6A00,  // 200: LD VA, 0
+    0x6B00,  // 202: LD VB, 0
+    0x2220,  // 204: CALL 220
+    0x7A03,  // 206: ADD VA, 3
+    0x7B01,  // 208: ADD VB, 1
+    0xA300,  // 20A: LD I, 300
+    0xFB33,  // 20C: LD B, VB
+    0xF265,  // 20E: LD V2, [I]
+    0x8124,  // 210: ADD V1, V2
+    0x8A1E,  // 212: SHL VA
+    0x3B40,  // 214: SE VB, 40
+    0x1204,  // 216: JP 204
+    0x1218,  // 218: JP 218
+    0x0000,  // 21A
+    0x0000,  // 21C
+    0x0000,  // 21E
+    0xFB29,  // 220: LD F, VB
+    0xDAB5,  // 222: DRW VA, VB, 5
+    0x8F15,  // 224: SUB VF, V1
+    0x00EE,  // 226: RET
+};
+
+/// Sprite drawing, a counted loop and a delay timer wait, the sequences that ir::Fuse turns into superinstructions
+inline const program_t IDIOMS = {
+    0x6A00,  // 200: LD VA, 0
+    0x6C00,  // 202: LD VC, 0
+    0xA050,  // 204: LD I, 050
+    0xDAB5,  // 206: DRW VA, VB, 5
+    0x7A05,  // 208: ADD VA, 5
+    0x7C01,  // 20A: ADD VC, 1
+    0x3C06,  // 20C: SE VC, 6
+    0x1204,  // 20E: JP 204
+    0x6003,  // 210: LD V0, 3
+    0xF015,  // 212: LD DT, V0
+    0xF007,  // 214: LD V0, DT
+    0x3000,  // 216: SE V0, 0
+    0x1214,  // 218: JP 214
+    0x7B06,  // 21A: ADD VB, 6
+    0x1200,  // 21C: JP 200
+};
+
+/// Switches between the display modes, draws large sprites and the big font, scrolls and uses the flag registers
+inline const program_t SUPER_CHIP = {
+    0x00FF,  // 200: HIGH
+    0x6A3C,  // 202: LD VA, 3C
+    0x6B04,  // 204: LD VB, 4
+    0xA050,  // 206: LD I, 050
+    0xDAB0,  // 208: DRW VA, VB, 0
+    0x00C3,  // 20A: SCD 3
+    0x00FB,  // 20C: SCR
+    0x6007,  // 20E: LD V0, 7
+    0xF030,  // 210: LD HF, V0
+    0xDABA,  // 212: DRW VA, VB, 10
+    0xF275,  // 214: LD R, V2
+    0x00FC,  // 216: SCL
+    0x72FF,  // 218: ADD V2, FF
+    0xF285,  // 21A: LD V2, R
+    0x7A7D,  // 21C: ADD VA, 7D
+    0x00FE,  // 21E: LOW
+    0xDAB0,  // 220: DRW VA, VB, 0
+    0x00C1,  // 222: SCD 1
+    0x1200,  // 224: JP 200
+};
+
+/// Draws to both bitplanes, scrolls one of them, copies register ranges and loads the audio pattern
+inline const program_t XO_CHIP = {
+    0x00FF,  // 200: HIGH
+    0xF301,  // 202: PLANE 3
+    0xF000,  // 204: LD I, 0050
+    0x0050,  // 206:
+    0x6A3C,  // 208: LD VA, 3C
+    0xDAB5,  // 20A: DRW VA, VB, 5
+    0xF201,  // 20C: PLANE 2
+    0x00D2,  // 20E: SCU 2
+    0x00FB,  // 210: SCR
+    0xA300,  // 212: LD I, 300
+    0x5A32,  // 214: LD [I], VA - V3
+    0x5523,  // 216: LD V5 - V2, [I]
+    0xF002,  // 218: AUDIO
+    0xFA3A,  // 21A: PITCH VA
+    0x7B07,  // 21C: ADD VB, 7
+    0xF101,  // 21E: PLANE 1
+    0x1200,  // 220: JP 200
+};
+
+/// <summary>
+/// Random straight-line code over a few registers and VF, followed by a jump back to the start. It reads and writes
+/// VF, I and the timers a lot to give the block optimisations something to do.
+/// </summary>
+inline program_t RandomBlock(std::mt19937& random, u32 size)
+{
+    constexpr u16 TEMPLATES[] = {0x6000, 0x7000, 0x8000, 0x8001, 0x8002, 0x8003, 0x8004, 0x8005, 0x8006,
+                                 0x8007, 0x800E, 0xA000, 0xD001, 0xF007, 0xF015, 0xF018, 0xF01E, 0xF029};
+    constexpr u8 REGISTERS[] = {0x0, 0x1, 0x2, 0x3, 0xF};
+
+    auto reg = [&random, &REGISTERS]() { return REGISTERS[random() % std::size(REGISTERS)]; };
+
+    program_t program;
+
+    for (u32 i = 0; i < size; ++i)
+    {
+        const u16 pattern = TEMPLATES[random() % std::size(TEMPLATES)];
+
+        switch (pattern >> 12u)
+        {
+            case 0x6:
+            case 0x7:
+                program.push_back(pattern | (reg() << 8u) | (random() & 0xFFu));
+                break;
+            case 0xA:
+                program.push_back(pattern | (random() % 0x400u));
+                break;
+            case 0xD:
+                // Fx1E can move I anywhere, so point it back into memory first
+                program.push_back(0xA000 | (random() % 0x400u));
+                program.push_back(pattern | (reg() << 8u) | (reg() << 4u));
+                break;
+            case 0xF:
+                program.push_back(pattern | (reg() << 8u));
+                break;
+            default:
+                program.push_back(pattern | (reg() << 8u) | (reg() << 4u));
+                break;
+        }
+    }
+
+    program.push_back(0x1000 | Chip8::START_ADDRESS);
+
+    return program;
+}
+
+inline void ExpectSameState(const Chip8& expected, const Chip8& actual, u16 instruction)
+{
+    EXPECT_EQ(expected.registers, actual.registers) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.memory, actual.memory) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.index, actual.index) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.pc, actual.pc) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.stack, actual.stack) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.sp, actual.sp) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.delayTimer, actual.delayTimer) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.soundTimer, actual.soundTimer) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.video, actual.video) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.hires, actual.hires) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.hiresVideo, actual.hiresVideo) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.flagRegisters, actual.flagRegisters) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.planes, actual.planes) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.video2, actual.video2) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.hiresVideo2, actual.hiresVideo2) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.audioPattern, actual.audioPattern) << "Instruction: 0x" << std::hex << instruction;
+    EXPECT_EQ(expected.pitch, actual.pitch) << "Instruction: 0x" << std::hex << instruction;
+}
+}  // namespace chip8::test
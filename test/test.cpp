@@ -24,6 +24,7 @@
 
 #include "emulator.h"
 #include "types.h"
+#include "video.h"
 
 using namespace chip8;
 
@@ -58,6 +59,48 @@ TEST(LoadROM, CheckFontsinMemory)
     }
 }
 
+TEST(ResetTest, RestoresPowerOnState)
+{
+    chip8::Chip8 emulator;
+    emulator.LoadRom("test.rom");
+    emulator.registers[0x3] = 0x42;
+    emulator.index = 0x300;
+    emulator.pc = 0x260;
+    emulator.sp = 2;
+    emulator.delayTimer = 7;
+    emulator.video[10] = UINT64_MAX;
+    emulator.memory[emulator.FONTSET_START_ADDRESS] = 0x00;
+
+    emulator.Reset();
+
+    chip8::Chip8 fresh;
+    ASSERT_EQ(emulator.registers, fresh.registers);
+    ASSERT_EQ(emulator.memory, fresh.memory);
+    ASSERT_EQ(emulator.index, fresh.index);
+    ASSERT_EQ(emulator.pc, fresh.START_ADDRESS);
+    ASSERT_EQ(emulator.sp, fresh.sp);
+    ASSERT_EQ(emulator.delayTimer, fresh.delayTimer);
+    ASSERT_EQ(emulator.video, fresh.video);
+}
+
+TEST(ResetTest, SeedMakesRandomNumbersReproducible)
+{
+    chip8::Chip8 first;
+    chip8::Chip8 second;
+    first.Reset(1234);
+    second.Reset(1234);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        first.opcode = 0xC0FF;
+        second.opcode = 0xC0FF;
+        first.OP_Cxkk();
+        second.OP_Cxkk();
+
+        ASSERT_EQ(first.registers[0x0], second.registers[0x0]);
+    }
+}
+
 TEST(InstructionTest, Test_OP_00E0)
 {
     chip8::Chip8 emulator;
@@ -792,10 +835,9 @@ TEST(InstructionTest, Test_OP_Dxyn)
         for (size_t col = 0; col < 8; col++)
         {
             u8 expectedValue = (spriteByte >> (7 - col)) & 1u;
-            u32 screenPixelValue = emulator.video[(y + row) * VIDEO_WIDTH + (x + col)];
-            u32 expectedPixelValue = expectedValue ? UINT32_MAX : 0;  // assuming 1 is represented as UINT32_MAX
+            bool screenPixelValue = Pixel(emulator.video, x + col, y + row);
 
-            ASSERT_EQ(screenPixelValue, expectedPixelValue);
+            ASSERT_EQ(screenPixelValue, expectedValue == 1);
         }
     }
 }
@@ -0,0 +1,189 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "aot.h"
+#include "emulator.h"
+#include "helpers.h"
+#include "types.h"
+
+namespace chip8::aot
+{
+extern const Program mixed;
+extern const Program self_modifying;
+extern const Program timers;
+extern const Program data_in_code;
+}  // namespace chip8::aot
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+/// <summary>
+/// Stands in for translated code with a single block covering 0x200 - 0x203 and counts the instructions it executed
+/// </summary>
+u64 translatedInstructions = 0;
+
+u64 RunInterpreted(Chip8& chip8, u64 budget, const u8* modified)
+{
+    u64 executed = 0;
+    while (executed < budget && chip8.pc >= 0x200 && chip8.pc < 0x204 && !(modified && modified[0]))
+    {
+        chip8.Cycle();
+        ++executed;
+    }
+
+    translatedInstructions += executed;
+    return executed;
+}
+
+const u8 IMAGE[] = {0x12, 0x04, 0x12, 0x02};
+const u16 BLOCK_BEGIN[] = {0x200};
+const u16 BLOCK_END[] = {0x204};
+}  // namespace
+
+TEST(AotTest, TranslatedProgramsMatchTheInterpreter)
+{
+    for (const auto& [program, rom] : {std::pair{&aot::mixed, "mixed.rom"}, std::pair{&aot::timers, "timers.rom"}})
+    {
+        chip8::Chip8 reference;
+        reference.LoadRom(rom);
+
+        chip8::Chip8 emulator = reference;
+        aot::Runner runner(*program, emulator);
+        ASSERT_TRUE(runner.Translated()) << program->name;
+
+        u64 executed = runner.Run(2000);
+
+        for (u64 i = 0; i < executed; ++i)
+        {
+            reference.Cycle();
+        }
+
+        ExpectSameState(reference, emulator, reference.memory[Chip8::START_ADDRESS]);
+        ASSERT_TRUE(runner.Translated()) << program->name;
+    }
+}
+
+TEST(AotTest, SelfModifyingCodeFallsBackToTheInterpreter)
+{
+    chip8::Chip8 reference;
+    reference.LoadRom("self_modifying.rom");
+
+    chip8::Chip8 emulator = reference;
+    aot::Runner runner(aot::self_modifying, emulator);
+
+    u64 executed = runner.Run(20);
+
+    for (u64 i = 0; i < executed; ++i)
+    {
+        reference.Cycle();
+    }
+
+    ExpectSameState(reference, emulator, 0);
+    ASSERT_FALSE(runner.Translated());
+    ASSERT_EQ(emulator.registers[0x5], 0x77);
+}
+
+TEST(AotTest, TranslateCoversOnlyReachableCode)
+{
+    chip8::Chip8 emulator;
+    LoadProgram(emulator, MIXED);
+
+    std::string source = aot::Translate(emulator.memory, static_cast<u32>(MIXED.size() * 2), "mixed");
+
+    EXPECT_NE(source.find("L_218:"), std::string::npos);
+    EXPECT_NE(source.find("L_226:"), std::string::npos);
+    EXPECT_EQ(source.find("L_21A:"), std::string::npos);
+    EXPECT_NE(source.find("ops::OP_Dxyn(c, 0xA, 0xB, 0x5);"), std::string::npos);
+}
+
+TEST(AotTest, InterpretedWritesIntoTranslatedCodeFallBackToTheInterpreter)
+{
+    const program_t program = {
+        0x1204,  // 200: JP 204
+        0x1202,  // 202: JP 202
+        0xA200,  // 204: LD I, 200
+        0x6012,  // 206: LD V0, 0x12
+        0x6134,  // 208: LD V1, 0x34
+        0xF155,  // 20A: LD [I], V1
+        0x1200,  // 20C: JP 200
+    };
+    const aot::Program translated{
+        "handwritten", &RunInterpreted, IMAGE, sizeof(IMAGE), 0x200, 0x204, BLOCK_BEGIN, BLOCK_END, 1};
+
+    chip8::Chip8 emulator;
+    LoadProgram(emulator, program);
+    aot::Runner runner(translated, emulator);
+    ASSERT_TRUE(runner.Translated());
+
+    translatedInstructions = 0;
+    ASSERT_EQ(runner.Run(5), 5u);
+    ASSERT_FALSE(runner.Translated());
+    ASSERT_EQ(translatedInstructions, 1u);
+
+    // 200 now holds JP 234, which only the interpreter knows about
+    runner.Run(2);
+    EXPECT_EQ(translatedInstructions, 1u);
+    EXPECT_EQ(emulator.pc, 0x234);
+}
+
+TEST(AotTest, DataWritesInsideTheCodeKeepItTranslated)
+{
+    chip8::Chip8 reference;
+    reference.LoadRom("data_in_code.rom");
+
+    chip8::Chip8 emulator = reference;
+    aot::Runner runner(aot::data_in_code, emulator);
+
+    // Fx33 stores into the gap between the loop and its exit test, which isn't code
+    const u64 executed = runner.Run(100);
+
+    for (u64 i = 0; i < executed; ++i)
+    {
+        reference.Cycle();
+    }
+
+    ExpectSameState(reference, emulator, 0);
+    ASSERT_EQ(emulator.pc, 0x214);
+    ASSERT_EQ(emulator.memory[0x20C], 1);
+    EXPECT_TRUE(runner.Translated());
+    EXPECT_TRUE(runner.Translated(0x206));
+    EXPECT_TRUE(runner.Translated(0x210));
+    EXPECT_FALSE(runner.Translated(0x20C));
+    EXPECT_EQ(runner.interpreted, 0u);
+}
+
+TEST(AotTest, OnlyModifiedBlocksFallBackToTheInterpreter)
+{
+    chip8::Chip8 emulator;
+    emulator.LoadRom("self_modifying.rom");
+    aot::Runner runner(aot::self_modifying, emulator);
+
+    runner.Run(20);
+
+    ASSERT_FALSE(runner.Translated());
+    EXPECT_FALSE(runner.Translated(0x204));
+    EXPECT_TRUE(runner.Translated(0x200));
+}
@@ -0,0 +1,113 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include "batch_runner.h"
+#include "emulator.h"
+#include "helpers.h"
+#include "scheduler.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+constexpr u32 INSTANCES = 24;
+constexpr u64 FRAMES = 100;
+
+Chip8 Machine(u32 index)
+{
+    const program_t* programs[] = {&MIXED, &TIMERS, &IDIOMS, &SUPER_CHIP, &XO_CHIP, &SELF_MODIFYING};
+
+    Chip8 chip8;
+    chip8.Reset(index);
+    LoadProgram(chip8, *programs[index % std::size(programs)]);
+    return chip8;
+}
+}  // namespace
+
+TEST(BatchRunnerTest, SameResultsForAnyThreadCount)
+{
+    std::vector<Chip8> expected;
+
+    for (u32 i = 0; i < INSTANCES; ++i)
+    {
+        expected.push_back(Machine(i));
+        Scheduler scheduler(expected.back(), 10 + i);
+        scheduler.RunFrames(FRAMES);
+    }
+
+    for (u32 threads : {1u, 3u, 8u})
+    {
+        BatchRunner runner(threads);
+        runner.framesPerTask = 7;
+
+        for (u32 i = 0; i < INSTANCES; ++i)
+        {
+            runner.Add(Machine(i), 10 + i);
+        }
+
+        runner.RunFrames(FRAMES / 2);
+        runner.RunFrames(FRAMES / 2);
+
+        for (u32 i = 0; i < INSTANCES; ++i)
+        {
+            ExpectSameState(expected[i], runner.Machine(i), static_cast<u16>(i));
+        }
+    }
+}
+
+TEST(BatchRunnerTest, CountsWorkPerWorker)
+{
+    BatchRunner runner(4);
+    runner.framesPerTask = 10;
+
+    for (u32 i = 0; i < INSTANCES; ++i)
+    {
+        runner.Add(Machine(i), 12);
+    }
+
+    runner.RunFrames(FRAMES);
+
+    const std::vector<WorkerStats> stats = runner.Stats();
+    ASSERT_EQ(stats.size(), 4u);
+
+    const WorkerStats total = std::accumulate(
+        stats.begin(), stats.end(), WorkerStats{}, [](WorkerStats sum, const WorkerStats& worker) {
+            sum.tasks += worker.tasks;
+            sum.steals += worker.steals;
+            sum.frames += worker.frames;
+            sum.instructions += worker.instructions;
+            return sum;
+        });
+
+    EXPECT_EQ(total.tasks, INSTANCES * FRAMES / 10);
+    EXPECT_EQ(total.frames, INSTANCES * FRAMES);
+    EXPECT_EQ(total.instructions, INSTANCES * FRAMES * 12);
+    EXPECT_LE(total.steals, total.tasks);
+
+    runner.ResetStats();
+    EXPECT_EQ(runner.Stats()[0].tasks, 0u);
+}
@@ -0,0 +1,145 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "emulator.h"
+#include "helpers.h"
+#include "types.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+TEST(DispatchTest, SwitchMatchesTableForEveryInstruction)
+{
+    std::mt19937 random(8);
+
+    chip8::Chip8 initial;
+    initial.index = 0x300;
+    initial.sp = 1;
+    initial.stack[0] = 0x280;
+    initial.delayTimer = 10;
+    initial.soundTimer = 3;
+    initial.keypad[0x7] = 1;
+
+    for (u32 instruction = 0; instruction <= 0xFFFF; ++instruction)
+    {
+        for (auto& reg : initial.registers)
+        {
+            reg = random() & 0xFFu;
+        }
+
+        initial.memory[initial.pc] = instruction >> 8u;
+        initial.memory[initial.pc + 1] = instruction & 0xFFu;
+
+        chip8::Chip8 table = initial;
+        table.dispatch = Dispatch::Table;
+        table.Cycle();
+
+        chip8::Chip8 flat = initial;
+        flat.dispatch = Dispatch::Switch;
+        flat.Cycle();
+
+        ExpectSameState(table, flat, instruction);
+
+        chip8::Chip8 cached = initial;
+        cached.dispatch = Dispatch::Cached;
+        cached.Cycle();
+
+        ExpectSameState(table, cached, instruction);
+
+        chip8::Chip8 specialized = initial;
+        specialized.dispatch = Dispatch::Specialized;
+        specialized.Cycle();
+
+        ExpectSameState(table, specialized, instruction);
+
+        if (HasFailure())
+        {
+            return;
+        }
+    }
+}
+
+TEST(DispatchTest, DecodeTableExtractsAllFields)
+{
+    Instruction instruction = DECODE_TABLE[0xD12A];
+    ASSERT_EQ(instruction.op, Op::OP_Dxyn);
+    ASSERT_EQ(instruction.x, 0x1);
+    ASSERT_EQ(instruction.y, 0x2);
+    ASSERT_EQ(instruction.n, 0xA);
+    ASSERT_EQ(instruction.kk, 0x2A);
+    ASSERT_EQ(instruction.nnn, 0x12A);
+
+    ASSERT_EQ(DECODE_TABLE[0x00E0].op, Op::OP_00E0);
+    ASSERT_EQ(DECODE_TABLE[0x00EE].op, Op::OP_00EE);
+    ASSERT_EQ(DECODE_TABLE[0x8AB6].op, Op::OP_8xy6);
+    ASSERT_EQ(DECODE_TABLE[0x8AB8].op, Op::OP_NOP);
+    ASSERT_EQ(DECODE_TABLE[0xE3A1].op, Op::OP_ExA1);
+    ASSERT_EQ(DECODE_TABLE[0xF465].op, Op::OP_Fx65);
+    ASSERT_EQ(DECODE_TABLE[0xF4FF].op, Op::OP_NOP);
+}
+
+TEST(DispatchTest, CachedEngineSeesSelfModifyingCode)
+{
+    chip8::Chip8 emulator;
+    emulator.dispatch = Dispatch::Cached;
+    LoadProgram(emulator, SELF_MODIFYING);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        emulator.Cycle();
+    }
+
+    ASSERT_EQ(emulator.pc, 0x20A);
+    ASSERT_EQ(emulator.registers[0x0], 0x65);
+    ASSERT_EQ(emulator.registers[0x3], 0x00);
+    ASSERT_EQ(emulator.registers[0x5], 0x77);
+}
+
+TEST(DispatchTest, AllEnginesRunProgramsIdentically)
+{
+    for (const program_t& program : {SELF_MODIFYING, TIMERS, MIXED, SUPER_CHIP, XO_CHIP})
+    {
+        chip8::Chip8 table;
+        table.dispatch = Dispatch::Table;
+        LoadProgram(table, program);
+
+        for (Dispatch dispatch : {Dispatch::Switch, Dispatch::Cached, Dispatch::Specialized})
+        {
+            chip8::Chip8 reference = table;
+
+            chip8::Chip8 emulator = table;
+            emulator.dispatch = dispatch;
+
+            for (int i = 0; i < 2000; ++i)
+            {
+                reference.Cycle();
+                emulator.Cycle();
+            }
+
+            ExpectSameState(reference, emulator, program.front());
+        }
+    }
+}
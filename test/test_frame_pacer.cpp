@@ -0,0 +1,97 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "frame_pacer.h"
+
+using namespace chip8;
+
+namespace
+{
+// Short frames keep the tests fast, the bounds are loose because the machine running them may be busy
+constexpr u32 FRAMES_PER_SECOND = 500;
+constexpr u32 FRAMES = 20;
+}  // namespace
+
+TEST(FramePacerTest, WaitsForAbsoluteDeadlines)
+{
+    FramePacer pacer(FRAMES_PER_SECOND);
+    const auto start = FramePacer::clock::now();
+
+    for (u32 i = 0; i < FRAMES; ++i)
+    {
+        pacer.Wait();
+        pacer.FrameDone();
+    }
+
+    const FrameStats stats = pacer.Stats();
+    EXPECT_GE(FramePacer::clock::now() - start, (FRAMES - 1) * pacer.Period());
+    EXPECT_EQ(stats.frames, FRAMES - 1);
+    EXPECT_GE(stats.mean, pacer.Period() / 2);
+}
+
+TEST(FramePacerTest, LowLatencyLocksToTheDisplay)
+{
+    FramePacer pacer(FRAMES_PER_SECOND, Pacing::LowLatency);
+
+    // A vsynced display that refreshes half a period after the nominal deadlines
+    const auto firstRefresh = FramePacer::clock::now() + pacer.Period() / 2;
+    auto minimumWait = pacer.Period();
+
+    for (u32 i = 0; i < 3 * FRAMES; ++i)
+    {
+        pacer.Wait();
+        pacer.Presenting();
+
+        const auto presented = FramePacer::clock::now();
+        const auto refresh = firstRefresh + ((presented - firstRefresh) / pacer.Period() + 1) * pacer.Period();
+        while (FramePacer::clock::now() < refresh)
+        {
+        }
+
+        pacer.FrameDone();
+
+        if (i >= 2 * FRAMES)
+        {
+            const auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(refresh - presented);
+            minimumWait = std::min(minimumWait, wait);
+        }
+    }
+
+    // With fixed pacing every present would wait half a period
+    EXPECT_LT(minimumWait, pacer.Period() / 4);
+}
+
+TEST(FramePacerTest, DropsFramesWhenBehind)
+{
+    FramePacer pacer(FRAMES_PER_SECOND);
+    pacer.Wait();
+
+    std::this_thread::sleep_for(pacer.Period() * 5);
+    pacer.Wait();
+
+    EXPECT_EQ(pacer.Stats().missed, 1u);
+}
@@ -0,0 +1,253 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "block_cache.h"
+#include "emulator.h"
+#include "helpers.h"
+#include "ir.h"
+#include "types.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+ir::Block BuildBlock(const program_t& program)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, program);
+    return ir::Build(chip8.memory, Chip8::START_ADDRESS, 64);
+}
+}  // namespace
+
+TEST(IrTest, BlocksEndAtBranches)
+{
+    ir::Block block = BuildBlock({0x6001, 0x7001, 0x3000, 0x6002});
+
+    ASSERT_EQ(block.nodes.size(), 3u);
+    EXPECT_EQ(block.begin, 0x200);
+    EXPECT_EQ(block.end, 0x206);
+    EXPECT_EQ(block.nodes[2].instruction.op, Op::OP_3xkk);
+}
+
+TEST(IrTest, EliminatesOverwrittenFlags)
+{
+    ir::Block block = BuildBlock({0x8014, 0x8125, 0x8F15, 0x8216, 0x6F00, 0x8314, 0x1200});
+    ir::EliminateDeadFlags(block);
+
+    EXPECT_EQ(block.nodes[0].instruction.op, Op::OP_8xy4_NF);
+    EXPECT_EQ(block.nodes[1].instruction.op, Op::OP_8xy5);  // VF is read by the 8F15 behind it
+    EXPECT_EQ(block.nodes[2].instruction.op, Op::OP_8xy5);  // Operates on VF itself
+    EXPECT_EQ(block.nodes[3].instruction.op, Op::OP_8xy6_NF);
+    EXPECT_EQ(block.nodes[5].instruction.op, Op::OP_8xy4);  // VF is live at the end of the block
+}
+
+TEST(IrTest, PropagatesConstants)
+{
+    ir::Block block = BuildBlock({0x6005, 0x7003, 0x8100, 0x8214, 0xF129, 0x3108});
+    ir::PropagateConstants(block);
+
+    EXPECT_EQ(block.nodes[1].instruction.op, Op::OP_6xkk);
+    EXPECT_EQ(block.nodes[1].instruction.kk, 0x08);
+    EXPECT_EQ(block.nodes[2].instruction.op, Op::OP_6xkk);
+    EXPECT_EQ(block.nodes[2].instruction.kk, 0x08);
+    EXPECT_EQ(block.nodes[3].instruction.op, Op::OP_8xy4);  // Still has to compute VF
+    EXPECT_EQ(block.nodes[4].instruction.op, Op::OP_Annn);
+    EXPECT_EQ(block.nodes[4].instruction.nnn, Chip8::FONTSET_START_ADDRESS + 5 * 0x08);
+    EXPECT_EQ(block.nodes[5].instruction.op, Op::OP_1nnn);
+    EXPECT_EQ(block.nodes[5].instruction.nnn, 0x20E);
+}
+
+TEST(IrTest, RemovesRedundantIndexLoads)
+{
+    ir::Block block = BuildBlock({0x6000, 0xA300, 0xF029, 0xA400, 0xD015, 0x1200});
+    ir::Optimize(block);
+
+    ASSERT_EQ(block.nodes.size(), 4u);
+    EXPECT_EQ(block.nodes[0].instruction.op, Op::OP_6xkk);
+    EXPECT_EQ(block.nodes[0].ticks, 3);
+    EXPECT_EQ(block.nodes[1].instruction.op, Op::OP_Annn);
+    EXPECT_EQ(block.nodes[1].instruction.nnn, 0x400);
+    EXPECT_EQ(block.Instructions(), 6u);
+}
+
+TEST(IrTest, FusesSuperinstructions)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, IDIOMS);
+
+    ir::Block loop = ir::Build(chip8.memory, 0x204, 64);
+    ir::Optimize(loop);
+    ir::Fuse(loop, chip8.memory);
+
+    ASSERT_EQ(loop.nodes.size(), 3u);
+    EXPECT_EQ(loop.nodes[0].instruction.op, Op::OP_AnnnDxyn);
+    EXPECT_EQ(loop.nodes[0].ticks, 2);
+    EXPECT_EQ(loop.nodes[1].instruction.op, Op::OP_7xkk);
+    EXPECT_EQ(loop.nodes[2].instruction.op, Op::OP_7xkk3xkk1nnn);
+    EXPECT_EQ(loop.nodes[2].instruction.nnn, 0x204);
+    EXPECT_EQ(loop.nodes[2].ticks, 3);
+    EXPECT_EQ(loop.end, 0x210);
+    EXPECT_EQ(loop.Instructions(), 6u);
+
+    ir::Block wait = ir::Build(chip8.memory, 0x214, 64);
+    ir::Optimize(wait);
+    ir::Fuse(wait, chip8.memory);
+
+    ASSERT_EQ(wait.nodes.size(), 1u);
+    EXPECT_EQ(wait.nodes[0].instruction.op, Op::OP_Fx073xkk1nnn);
+    EXPECT_EQ(wait.end, 0x21A);
+}
+
+TEST(BlockCacheTest, RunsProgramsLikeTheInterpreter)
+{
+    for (bool superinstructions : {false, true})
+    {
+        for (const program_t& program : {SELF_MODIFYING, TIMERS, MIXED, IDIOMS, SUPER_CHIP, XO_CHIP})
+        {
+            chip8::Chip8 reference;
+            LoadProgram(reference, program);
+
+            chip8::Chip8 emulator = reference;
+            BlockCache cache(emulator);
+            cache.superinstructions = superinstructions;
+
+            u64 executed = cache.Run(2000);
+
+            for (u64 i = 0; i < executed; ++i)
+            {
+                reference.Cycle();
+            }
+
+            ExpectSameState(reference, emulator, program.front());
+        }
+    }
+}
+
+TEST(BlockCacheTest, SuperinstructionsReduceDispatches)
+{
+    chip8::Chip8 plain;
+    LoadProgram(plain, IDIOMS);
+    chip8::Chip8 fused = plain;
+
+    BlockCache plainCache(plain);
+    plainCache.superinstructions = false;
+    BlockCache fusedCache(fused);
+    fusedCache.superinstructions = true;
+
+    // Both stop at the same block boundary, because fusion never changes where blocks start
+    ASSERT_EQ(plainCache.Run(1000), fusedCache.Run(1000));
+
+    ExpectSameState(plain, fused, IDIOMS.front());
+    EXPECT_LT(fusedCache.dispatches, plainCache.dispatches);
+}
+
+TEST(BlockCacheTest, RunsOptimisedBlocksLikeTheInterpreter)
+{
+    std::mt19937 random(6);
+
+    for (u32 i = 0; i < 2000; ++i)
+    {
+        const program_t program = RandomBlock(random, 24);
+
+        chip8::Chip8 reference;
+        LoadProgram(reference, program);
+
+        for (auto& reg : reference.registers)
+        {
+            reg = random() & 0xFFu;
+        }
+
+        reference.delayTimer = random() & 0x1Fu;
+
+        chip8::Chip8 emulator = reference;
+        BlockCache cache(emulator);
+
+        u32 executed = cache.Step();
+        ASSERT_EQ(executed, program.size());
+
+        for (u32 j = 0; j < executed; ++j)
+        {
+            reference.Cycle();
+        }
+
+        ExpectSameState(reference, emulator, program.front());
+
+        if (HasFailure())
+        {
+            return;
+        }
+    }
+}
+
+TEST(BlockCacheTest, InvalidatesBlocksOnMemoryWrites)
+{
+    chip8::Chip8 emulator;
+    LoadProgram(emulator, SELF_MODIFYING);
+    BlockCache cache(emulator);
+
+    cache.Run(20);
+
+    ASSERT_EQ(emulator.pc, 0x20A);
+    ASSERT_EQ(emulator.registers[0x3], 0x00);
+    ASSERT_EQ(emulator.registers[0x5], 0x77);
+}
+
+TEST(BlockCacheTest, InvalidatesFusedJumps)
+{
+    // A full block whose counting loop absorbs the jump at 280, followed by code that retargets that jump
+    const program_t tail = {
+        0x7101,  // 27C: ADD V1, 1
+        0x3102,  // 27E: SE V1, 2
+        0x1200,  // 280: JP 200
+        0xA281,  // 282: LD I, 281
+        0x6090,  // 284: LD V0, 90
+        0xF055,  // 286: LD [I], V0
+        0x6100,  // 288: LD V1, 0
+        0x1200,  // 28A: JP 200
+        0x0000,  // 28C
+        0x0000,  // 28E
+        0x6577,  // 290: LD V5, 77
+        0x1292,  // 292: JP 292
+    };
+    program_t program(62, 0x7301);  // 200: ADD V3, 1
+    program.insert(program.end(), tail.begin(), tail.end());
+
+    chip8::Chip8 emulator;
+    LoadProgram(emulator, program);
+
+    ir::Block block = ir::Build(emulator.memory, Chip8::START_ADDRESS, BlockCache::MAX_BLOCK_INSTRUCTIONS);
+    ir::Optimize(block);
+    ir::Fuse(block, emulator.memory);
+    ASSERT_EQ(block.end, 0x282);
+
+    BlockCache cache(emulator);
+    cache.superinstructions = true;
+    cache.Run(1000);
+
+    ASSERT_EQ(emulator.pc, 0x292);
+    ASSERT_EQ(emulator.registers[0x5], 0x77);
+}
@@ -0,0 +1,225 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "emulator.h"
+#include "helpers.h"
+#include "jit.h"
+#include "state_hash.h"
+#include "types.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+TEST(JitTest, MatchesInterpreterForEveryInstruction)
+{
+    std::mt19937 random(4);
+
+    chip8::Chip8 initial;
+    initial.index = 0x300;
+    initial.sp = 1;
+    initial.stack[0] = 0x280;
+    initial.delayTimer = 10;
+    initial.soundTimer = 3;
+    initial.keypad[0x7] = 1;
+
+    for (u32 instruction = 0; instruction <= 0xFFFF; ++instruction)
+    {
+        for (auto& reg : initial.registers)
+        {
+            reg = random() & 0xFFu;
+        }
+
+        initial.memory[initial.pc] = instruction >> 8u;
+        initial.memory[initial.pc + 1] = instruction & 0xFFu;
+
+        chip8::Chip8 reference = initial;
+        reference.Cycle();
+
+        // The following 0x0000 is 00E0, which is interpreted, so every block holds a single instruction
+        chip8::Chip8 emulator = initial;
+        Jit jit(emulator);
+        ASSERT_EQ(jit.Step(), 1u);
+
+        ExpectSameState(reference, emulator, instruction);
+
+        if (HasFailure())
+        {
+            return;
+        }
+    }
+}
+
+TEST(JitTest, RunsProgramsLikeTheInterpreter)
+{
+    for (const program_t& program : {SELF_MODIFYING, TIMERS, MIXED, SUPER_CHIP, XO_CHIP})
+    {
+        chip8::Chip8 reference;
+        LoadProgram(reference, program);
+
+        chip8::Chip8 emulator = reference;
+        Jit jit(emulator);
+
+        u64 executed = jit.Run(2000);
+
+        for (u64 i = 0; i < executed; ++i)
+        {
+            reference.Cycle();
+        }
+
+        ExpectSameState(reference, emulator, program.front());
+    }
+}
+
+TEST(JitTest, KeepsStateHashUpToDate)
+{
+    for (const program_t& program : {SELF_MODIFYING, MIXED, SUPER_CHIP, XO_CHIP})
+    {
+        chip8::Chip8 emulator;
+        LoadProgram(emulator, program);
+        Jit jit(emulator);
+
+        for (u32 slice = 0; slice < 50; ++slice)
+        {
+            jit.Run(13);
+            ASSERT_EQ(emulator.StateHash(), HashState(emulator)) << "Slice " << slice;
+        }
+    }
+}
+
+TEST(JitTest, InvalidatesBlocksOnMemoryWrites)
+{
+    chip8::Chip8 emulator;
+    LoadProgram(emulator, SELF_MODIFYING);
+    Jit jit(emulator);
+
+    jit.Run(20);
+
+    ASSERT_EQ(emulator.pc, 0x20A);
+    ASSERT_EQ(emulator.registers[0x3], 0x00);
+    ASSERT_EQ(emulator.registers[0x5], 0x77);
+}
+
+TEST(JitTest, InvalidatesBlocksOn5xy2)
+{
+    // The block at 0x208 runs once, then 5232 overwrites its first instruction with LD V1, 0x22
+    const program_t program = {
+        0xA208,  // 200: LD I, 0x208
+        0x6261,  // 202: LD V2, 0x61
+        0x6322,  // 204: LD V3, 0x22
+        0x1208,  // 206: JP 0x208
+        0x6111,  // 208: LD V1, 0x11  -> becomes LD V1, 0x22
+        0x4401,  // 20A: SNE V4, 0x01
+        0x120C,  // 20C: JP 0x20C
+        0x7401,  // 20E: ADD V4, 0x01
+        0x5232,  // 210: LD [I], V2 - V3
+        0x1208,  // 212: JP 0x208
+    };
+
+    chip8::Chip8 reference;
+    LoadProgram(reference, program);
+
+    chip8::Chip8 emulator = reference;
+    Jit jit(emulator);
+    const u64 executed = jit.Run(30);
+
+    for (u64 i = 0; i < executed; ++i)
+    {
+        reference.Cycle();
+    }
+
+    ASSERT_EQ(emulator.pc, 0x20C);
+    ASSERT_EQ(emulator.registers[0x1], 0x22);
+    ExpectSameState(reference, emulator, 0x5232);
+}
+
+TEST(JitTest, RemembersInstructionsWithoutTranslation)
+{
+    const program_t program = {
+        0xD121,  // 200: DRW V1, V2, 1
+        0x1200,  // 202: JP 0x200
+    };
+
+    chip8::Chip8 emulator;
+    LoadProgram(emulator, program);
+    Jit jit(emulator);
+
+    jit.Run(100);
+    EXPECT_EQ(jit.compilations, 2u);
+
+    // Overwriting the instruction gives it another chance
+    emulator.memory[0x200] = 0x65;
+    emulator.memory[0x201] = 0x77;
+    jit.Invalidate(0x201, 1);
+    jit.Run(10);
+
+    EXPECT_EQ(jit.compilations, 3u);
+    EXPECT_EQ(emulator.registers[0x5], 0x77);
+}
+
+TEST(JitTest, RunsOptimisedBlocksLikeTheInterpreter)
+{
+    std::mt19937 random(7);
+
+    for (u32 i = 0; i < 2000; ++i)
+    {
+        const program_t program = RandomBlock(random, 24);
+
+        chip8::Chip8 reference;
+        LoadProgram(reference, program);
+
+        for (auto& reg : reference.registers)
+        {
+            reg = random() & 0xFFu;
+        }
+
+        reference.delayTimer = random() & 0x1Fu;
+
+        chip8::Chip8 emulator = reference;
+        Jit jit(emulator);
+
+        // Dxyn has no translation, so run blocks until the jump back to the start
+        u64 executed = 0;
+
+        while (executed < program.size())
+        {
+            executed += jit.Step();
+        }
+
+        ASSERT_EQ(executed, program.size());
+
+        for (u64 j = 0; j < executed; ++j)
+        {
+            reference.Cycle();
+        }
+
+        ExpectSameState(reference, emulator, program.front());
+
+        if (HasFailure())
+        {
+            return;
+        }
+    }
+}
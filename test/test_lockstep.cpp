@@ -0,0 +1,138 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "emulator.h"
+#include "helpers.h"
+#include "lockstep.h"
+#include "quirks.h"
+#include "scheduler.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+constexpr u32 FRAMES = 50;
+constexpr u32 INSTRUCTIONS_PER_FRAME = 20;
+
+/// Different programs and seeds in every lane, some of them sharing a program
+Chip8 Machine(u32 lane, Variant variant)
+{
+    const program_t* programs[] = {&MIXED, &TIMERS, &IDIOMS, &SUPER_CHIP, &XO_CHIP, &SELF_MODIFYING};
+
+    Chip8 chip8;
+    chip8.Reset(lane);
+    chip8.variant = variant;
+    chip8.delayTimer = static_cast<u8>(lane * 3);
+
+    if (lane < std::size(programs))
+    {
+        LoadProgram(chip8, *programs[lane]);
+    }
+    else
+    {
+        std::mt19937 random(lane % 3);
+        LoadProgram(chip8, RandomBlock(random, 40));
+    }
+
+    return chip8;
+}
+
+template <typename Quirks>
+void ExpectSameAsScheduler()
+{
+    Lockstep<Quirks> lockstep;
+
+    for (u32 lane = 0; lane < Lockstep<Quirks>::LANES; ++lane)
+    {
+        lockstep.Load(lane, Machine(lane, Quirks::VARIANT));
+    }
+
+    lockstep.RunFrames(FRAMES, INSTRUCTIONS_PER_FRAME);
+
+    for (u32 lane = 0; lane < Lockstep<Quirks>::LANES; ++lane)
+    {
+        Chip8 expected = Machine(lane, Quirks::VARIANT);
+        Scheduler scheduler(expected, INSTRUCTIONS_PER_FRAME);
+        scheduler.RunFrames(FRAMES);
+
+        ExpectSameState(expected, lockstep.Lane(lane), static_cast<u16>(lane));
+    }
+
+    EXPECT_EQ(lockstep.stats.laneInstructions, FRAMES * INSTRUCTIONS_PER_FRAME * Lockstep<Quirks>::LANES);
+}
+}  // namespace
+
+TEST(LockstepTest, LanesMatchScheduler)
+{
+    ExpectSameAsScheduler<quirks::Legacy>();
+    ExpectSameAsScheduler<quirks::Chip8>();
+    ExpectSameAsScheduler<quirks::SuperChip>();
+    ExpectSameAsScheduler<quirks::XoChip>();
+}
+
+TEST(LockstepTest, IdenticalLanesStayTogether)
+{
+    Lockstep<> lockstep;
+
+    for (u32 lane = 0; lane < Lockstep<>::LANES; ++lane)
+    {
+        Chip8 chip8;
+        LoadProgram(chip8, IDIOMS);
+        lockstep.Load(lane, chip8);
+    }
+
+    lockstep.RunFrames(10, 100);
+
+    EXPECT_EQ(lockstep.stats.steps * Lockstep<>::LANES, lockstep.stats.laneInstructions);
+}
+
+TEST(LockstepTest, DivergedLanesReconverge)
+{
+    // 3000: SE V0, 0x00    <- only lane 0 skips
+    // 7101: ADD V1, 0x01
+    // 7201: ADD V2, 0x01   <- all lanes meet again here
+    // 1204: JP 0x204
+    Lockstep<> lockstep;
+
+    for (u32 lane = 0; lane < 4; ++lane)
+    {
+        Chip8 chip8;
+        chip8.registers[0x0] = static_cast<u8>(lane);
+        LoadProgram(chip8, {0x3000, 0x7101, 0x7201, 0x1204});
+        lockstep.Load(lane, chip8);
+    }
+
+    lockstep.RunFrame(21);
+
+    EXPECT_EQ(lockstep.Lane(0).registers[0x1], 0);
+    EXPECT_EQ(lockstep.Lane(0).registers[0x2], 10);
+    EXPECT_EQ(lockstep.Lane(1).registers[0x1], 1);
+    EXPECT_EQ(lockstep.Lane(1).registers[0x2], 10);
+
+    // Lanes 1-3 catch up in the second step, then all four run together until only lane 0 has budget left
+    EXPECT_EQ(lockstep.stats.steps, 22u);
+}
@@ -0,0 +1,198 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "emulator.h"
+#include "helpers.h"
+#include "paged_memory.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+// A300: LD I, 0x300
+// 6107: LD V1, 0x07
+// F155: LD [I], V1
+// 7101: ADD V1, 0x01
+// 1204: JP 0x204
+const program_t STORES = {0xA300, 0x6107, 0xF155, 0x7101, 0x1204};
+
+// A050: LD I, 0x050
+// D005: DRW V0, V0, 5
+// 1202: JP 0x202
+const program_t DRAWS = {0xA050, 0xD005, 0x1202};
+
+template <u32 PAGES>
+u32 SharedPages(const PagedBytes<PAGES>& a, const PagedBytes<PAGES>& b)
+{
+    u32 shared = 0;
+    for (u32 page = 0; page < PAGES; ++page)
+    {
+        shared += a.Shares(b, page) ? 1 : 0;
+    }
+    return shared;
+}
+}  // namespace
+
+TEST(PagedMemoryTest, ForkSharesEveryPage)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, MIXED);
+
+    const PagedMachine base(chip8);
+    const PagedMachine fork = base;
+    EXPECT_EQ(SharedPages(base.Memory(), fork.Memory()), MEMORY_PAGES);
+    EXPECT_EQ(SharedPages(base.Video(), fork.Video()), PagedMachine::VIDEO_PAGES);
+}
+
+TEST(PagedMemoryTest, CopiesWrittenPagesOnly)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, STORES);
+    const PagedMachine base(chip8);
+
+    PagedMachine fork = base;
+    Chip8 worker;
+    fork.LoadInto(worker);
+    worker.Run(20);
+    fork.SaveFrom(worker);
+
+    EXPECT_EQ(SharedPages(base.Memory(), fork.Memory()), MEMORY_PAGES - 1);
+    EXPECT_FALSE(base.Memory().Shares(fork.Memory(), 0x300 / MEMORY_PAGE_SIZE));
+    EXPECT_EQ(base.Memory().Read(0x301), 0);
+    EXPECT_EQ(fork.Memory().Read(0x301), worker.memory[0x301]);
+    EXPECT_NE(worker.memory[0x301], 0);
+
+    // The page is private now and written in place
+    fork.LoadInto(worker);
+    worker.Run(20);
+    fork.SaveFrom(worker);
+    EXPECT_EQ(fork.Memory().Read(0x301), worker.memory[0x301]);
+    EXPECT_EQ(base.Memory().Read(0x301), 0);
+    EXPECT_EQ(SharedPages(base.Video(), fork.Video()), PagedMachine::VIDEO_PAGES);
+}
+
+TEST(PagedMemoryTest, CopiesDrawnFramebufferPagesOnly)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, DRAWS);
+    const PagedMachine base(chip8);
+
+    PagedMachine fork = base;
+    Chip8 worker;
+    fork.LoadInto(worker);
+    worker.Run(3);
+    fork.SaveFrom(worker);
+
+    // Only the first bitplane of the low resolution framebuffer was drawn to
+    const u32 page = (offsetof(MachineState, video) - PagedMachine::VIDEO_OFFSET) / MEMORY_PAGE_SIZE;
+    EXPECT_EQ(SharedPages(base.Video(), fork.Video()), PagedMachine::VIDEO_PAGES - 1);
+    EXPECT_FALSE(base.Video().Shares(fork.Video(), page));
+    EXPECT_EQ(SharedPages(base.Memory(), fork.Memory()), MEMORY_PAGES);
+
+    Chip8 loaded;
+    fork.LoadInto(loaded);
+    ExpectSameState(worker, loaded, DRAWS.front());
+    EXPECT_NE(loaded.video, chip8.video);
+
+    // Drawing the sprite again erases it, the page is private now and written in place
+    fork.LoadInto(worker);
+    worker.Run(2);
+    fork.SaveFrom(worker);
+    fork.LoadInto(loaded);
+    EXPECT_EQ(loaded.video, chip8.video);
+    EXPECT_FALSE(base.Video().Shares(fork.Video(), page));
+}
+
+TEST(PagedMemoryTest, RunsLikeChip8)
+{
+    for (const program_t& program : {MIXED, IDIOMS, SELF_MODIFYING, STORES})
+    {
+        Chip8 expected;
+        expected.Reset(5);
+        LoadProgram(expected, program);
+        PagedMachine paged(expected);
+        expected.Run(170);
+
+        Chip8 other;
+        LoadProgram(other, STORES);
+        PagedMachine interleaved(other);
+
+        // One worker takes turns running both machines, the pages have to carry the memory of each. STORES doesn't
+        // draw random numbers, so the sequence of the other machine isn't disturbed.
+        Chip8 worker;
+        worker.Reset(5);
+        worker.dispatch = Dispatch::Cached;
+        for (u32 slice = 0; slice < 10; ++slice)
+        {
+            paged.LoadInto(worker);
+            worker.Run(17);
+            paged.SaveFrom(worker);
+
+            interleaved.LoadInto(worker);
+            worker.Run(5);
+            interleaved.SaveFrom(worker);
+        }
+
+        Chip8 actual;
+        paged.LoadInto(actual);
+        ExpectSameState(expected, actual, program.front());
+    }
+}
+
+TEST(PagedMemoryTest, SharesPagesOfSameRom)
+{
+    Chip8 first;
+    Chip8 second;
+    LoadProgram(first, MIXED);
+    LoadProgram(second, MIXED);
+    second.registers[0x3] = 0x42;
+    second.memory[0x500] = 0x42;
+
+    const PagedMachine a(first);
+    const PagedMachine b(second, a);
+    EXPECT_EQ(SharedPages(a.Memory(), b.Memory()), MEMORY_PAGES - 1);
+    EXPECT_EQ(SharedPages(a.Video(), b.Video()), PagedMachine::VIDEO_PAGES);
+
+    Chip8 loaded;
+    b.LoadInto(loaded);
+    ExpectSameState(second, loaded, 0);
+}
+
+TEST(PagedMemoryTest, WritesCopyOnWrite)
+{
+    memory_t memory{};
+    const PagedMemory original(memory);
+    PagedMemory copy = original;
+
+    copy.Write(0x123, 0x55);
+    EXPECT_EQ(copy.Read(0x123), 0x55);
+    EXPECT_EQ(original.Read(0x123), 0);
+    EXPECT_EQ(SharedPages(original, copy), MEMORY_PAGES - 1);
+
+    // Writing the value a page already has keeps it shared
+    PagedMemory same = original;
+    same.Write(0x456, 0);
+    EXPECT_EQ(SharedPages(original, same), MEMORY_PAGES);
+}
@@ -0,0 +1,190 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "core.h"
+#include "emulator.h"
+#include "helpers.h"
+#include "quirks.h"
+#include "types.h"
+#include "video.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+template <typename Quirks>
+Chip8 Execute(Chip8 chip8, u16 opcode)
+{
+    Core<Quirks>::Execute(chip8, DECODE_TABLE[opcode]);
+    return chip8;
+}
+}  // namespace
+
+TEST(QuirksTest, LogicResetsVF)
+{
+    Chip8 initial;
+    initial.registers[0x1] = 0x0F;
+    initial.registers[0x2] = 0xF0;
+    initial.registers[0xF] = 0x5;
+
+    for (u16 opcode : {0x8121, 0x8122, 0x8123})
+    {
+        EXPECT_EQ(Execute<quirks::Legacy>(initial, opcode).registers[0xF], 0x5);
+        EXPECT_EQ(Execute<quirks::Chip8>(initial, opcode).registers[0xF], 0x0);
+    }
+}
+
+TEST(QuirksTest, ShiftSource)
+{
+    Chip8 initial;
+    initial.registers[0x1] = 0x10;
+    initial.registers[0x2] = 0x81;
+
+    Chip8 legacy = Execute<quirks::Legacy>(initial, 0x8126);
+    EXPECT_EQ(legacy.registers[0x1], 0x08);
+    EXPECT_EQ(legacy.registers[0xF], 0x0);
+
+    Chip8 vip = Execute<quirks::Chip8>(initial, 0x8126);
+    EXPECT_EQ(vip.registers[0x1], 0x40);
+    EXPECT_EQ(vip.registers[0xF], 0x1);
+
+    Chip8 left = Execute<quirks::XoChip>(initial, 0x812E);
+    EXPECT_EQ(left.registers[0x1], 0x02);
+    EXPECT_EQ(left.registers[0xF], 0x1);
+}
+
+TEST(QuirksTest, LoadStoreIncrementsIndex)
+{
+    Chip8 initial;
+    initial.index = 0x300;
+
+    EXPECT_EQ(Execute<quirks::Legacy>(initial, 0xF255).index, 0x300);
+    EXPECT_EQ(Execute<quirks::SuperChip>(initial, 0xF265).index, 0x300);
+    EXPECT_EQ(Execute<quirks::Chip8>(initial, 0xF255).index, 0x303);
+    EXPECT_EQ(Execute<quirks::XoChip>(initial, 0xF265).index, 0x303);
+}
+
+TEST(QuirksTest, JumpRegister)
+{
+    Chip8 initial;
+    initial.registers[0x0] = 0x10;
+    initial.registers[0x2] = 0x20;
+
+    EXPECT_EQ(Execute<quirks::Legacy>(initial, 0xB200).pc, 0x210);
+    EXPECT_EQ(Execute<quirks::SuperChip>(initial, 0xB200).pc, 0x220);
+}
+
+TEST(QuirksTest, SpriteEdges)
+{
+    // Two full rows in the bottom right corner, so the sprite crosses both edges
+    Chip8 initial;
+    initial.index = 0x300;
+    initial.memory[0x300] = 0xFF;
+    initial.memory[0x301] = 0xFF;
+    initial.registers[0x1] = 60;
+    initial.registers[0x2] = 31;
+
+    const u64 right = PixelMask(60) | PixelMask(61) | PixelMask(62) | PixelMask(63);
+    const u64 left = PixelMask(0) | PixelMask(1) | PixelMask(2) | PixelMask(3);
+
+    Chip8 linear = Execute<quirks::Legacy>(initial, 0xD122);
+    EXPECT_EQ(linear.video[31], right);
+    EXPECT_EQ(linear.video[0], left | right);
+    EXPECT_EQ(linear.video[1], left);
+
+    Chip8 clip = Execute<quirks::Chip8>(initial, 0xD122);
+    EXPECT_EQ(clip.video[31], right);
+    EXPECT_EQ(clip.video[0], 0u);
+
+    Chip8 wrap = Execute<quirks::XoChip>(initial, 0xD122);
+    EXPECT_EQ(wrap.video[31], left | right);
+    EXPECT_EQ(wrap.video[0], left | right);
+    EXPECT_EQ(wrap.video[1], 0u);
+}
+
+TEST(QuirksTest, LargeSprites)
+{
+    Chip8 initial;
+    initial.index = 0x300;
+    std::fill_n(initial.memory.begin() + 0x300, 32, 0xFF);
+    initial.video[4] = PixelMask(10);
+    initial.registers[0x1] = 8;
+    initial.registers[0x2] = 4;
+    initial.registers[0xF] = 0x5;
+
+    for (const Chip8& unchanged : {Execute<quirks::Legacy>(initial, 0xD120), Execute<quirks::Chip8>(initial, 0xD120)})
+    {
+        EXPECT_EQ(unchanged.video, initial.video);
+        EXPECT_EQ(unchanged.registers[0xF], 0x0);
+    }
+
+    for (const Chip8& drawn : {Execute<quirks::SuperChip>(initial, 0xD120), Execute<quirks::XoChip>(initial, 0xD120)})
+    {
+        EXPECT_EQ(drawn.video[4], (0xFFFFull << 40) & ~PixelMask(10));
+        EXPECT_EQ(drawn.video[19], 0xFFFFull << 40);
+        EXPECT_EQ(drawn.video[20], 0u);
+        EXPECT_EQ(drawn.registers[0xF], 0x1);
+    }
+}
+
+TEST(QuirksTest, VariantSelectsCore)
+{
+    for (Variant variant : {Variant::Legacy, Variant::Chip8, Variant::SuperChip, Variant::XoChip})
+    {
+        Chip8 stepped;
+        stepped.variant = variant;
+        LoadProgram(stepped, MIXED);
+        Chip8 run = stepped;
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            stepped.Cycle();
+        }
+
+        ASSERT_EQ(run.Run(2000), 2000u);
+        ExpectSameState(stepped, run, MIXED.front());
+    }
+
+    // MIXED shifts VA, so the variants have to end up in different places
+    Chip8 legacy;
+    LoadProgram(legacy, MIXED);
+    Chip8 vip = legacy;
+    vip.variant = Variant::Chip8;
+
+    legacy.Run(2000);
+    vip.Run(2000);
+    EXPECT_NE(legacy.registers, vip.registers);
+}
+
+TEST(QuirksTest, LoadRomSelectsVariant)
+{
+    Chip8 emulator;
+    emulator.LoadRom("test.rom", Variant::SuperChip);
+
+    EXPECT_EQ(emulator.variant, Variant::SuperChip);
+    EXPECT_EQ(emulator.memory[Chip8::START_ADDRESS], 0x01);
+}
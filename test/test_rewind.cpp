@@ -0,0 +1,142 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "emulator.h"
+#include "helpers.h"
+#include "rewind.h"
+#include "scheduler.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+/// States at the end of every frame of a program
+std::vector<Chip8> Frames(const program_t& program, u32 count)
+{
+    Chip8 chip8;
+    chip8.Reset(3);
+    LoadProgram(chip8, program);
+    Scheduler scheduler(chip8);
+
+    std::vector<Chip8> frames;
+    for (u32 i = 0; i < count; ++i)
+    {
+        scheduler.RunFrame();
+        frames.push_back(chip8);
+    }
+    return frames;
+}
+}  // namespace
+
+TEST(RewindTest, StepsBackThroughEveryFrame)
+{
+    for (const program_t& program : {MIXED, TIMERS, SUPER_CHIP, XO_CHIP})
+    {
+        const std::vector<Chip8> frames = Frames(program, 300);
+        Rewind rewind;
+        for (const Chip8& frame : frames)
+        {
+            rewind.Record(frame);
+        }
+        EXPECT_EQ(rewind.Frames(), frames.size() - 1);
+
+        Chip8 chip8;
+        for (std::size_t i = frames.size() - 1; i-- > 0;)
+        {
+            ASSERT_TRUE(rewind.StepBack(chip8));
+            ExpectSameState(frames[i], chip8, program.front());
+        }
+
+        const Chip8 untouched = chip8;
+        EXPECT_FALSE(rewind.StepBack(chip8));
+        ExpectSameState(untouched, chip8, program.front());
+        EXPECT_EQ(rewind.Used(), 0u);
+    }
+}
+
+TEST(RewindTest, DropsOldestFramesWhenFull)
+{
+    const std::vector<Chip8> frames = Frames(MIXED, 500);
+    Rewind rewind(2048);
+    for (const Chip8& frame : frames)
+    {
+        rewind.Record(frame);
+        EXPECT_LE(rewind.Used(), 2048u);
+    }
+
+    const u64 kept = rewind.Frames();
+    EXPECT_GT(kept, 0u);
+    EXPECT_LT(kept, frames.size() - 1);
+
+    Chip8 chip8;
+    for (u64 i = 1; i <= kept; ++i)
+    {
+        ASSERT_TRUE(rewind.StepBack(chip8));
+        ExpectSameState(frames[frames.size() - 1 - i], chip8, 0);
+    }
+    EXPECT_FALSE(rewind.StepBack(chip8));
+}
+
+TEST(RewindTest, RecordingAfterStepBackReplacesFuture)
+{
+    const std::vector<Chip8> frames = Frames(TIMERS, 20);
+    const std::vector<Chip8> other = Frames(MIXED, 20);
+    Rewind rewind;
+    for (const Chip8& frame : frames)
+    {
+        rewind.Record(frame);
+    }
+
+    Chip8 chip8;
+    for (u32 i = 0; i < 10; ++i)
+    {
+        rewind.StepBack(chip8);
+    }
+    ExpectSameState(frames[9], chip8, 0);
+
+    rewind.Record(other[0]);
+    rewind.Record(other[1]);
+    EXPECT_EQ(rewind.Frames(), 11u);
+
+    rewind.StepBack(chip8);
+    ExpectSameState(other[0], chip8, 0);
+    rewind.StepBack(chip8);
+    ExpectSameState(frames[9], chip8, 0);
+}
+
+TEST(RewindTest, HoldsAMinuteInOneMegabyte)
+{
+    const std::vector<Chip8> frames = Frames(MIXED, 60 * 60 + 1);
+    Rewind rewind;
+    for (const Chip8& frame : frames)
+    {
+        rewind.Record(frame);
+    }
+
+    EXPECT_EQ(rewind.Frames(), 60u * 60);
+    EXPECT_LE(rewind.Used(), Rewind::DEFAULT_CAPACITY);
+}
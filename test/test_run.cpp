@@ -0,0 +1,148 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "emulator.h"
+#include "helpers.h"
+#include "quirks.h"
+#include "scheduler.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+// 7001: ADD V0, 0x01
+// 1200: JP 0x200
+const program_t COUNTER = {0x7001, 0x1200};
+
+constexpr stop_mask_t ALL = StopOn(StopReason::Draw) | StopOn(StopReason::Sound) | StopOn(StopReason::KeyWait) |
+                            StopOn(StopReason::Breakpoint);
+}  // namespace
+
+TEST(RunTest, RunForMatchesCycle)
+{
+    for (Variant variant : {Variant::Legacy, Variant::Chip8, Variant::SuperChip, Variant::XoChip})
+    {
+        for (const program_t* program : {&MIXED, &TIMERS, &SUPER_CHIP, &XO_CHIP})
+        {
+            Chip8 expected;
+            expected.variant = variant;
+            LoadProgram(expected, *program);
+            Chip8 actual = expected;
+
+            for (u32 i = 0; i < 500; ++i)
+            {
+                expected.Cycle();
+            }
+
+            const RunResult result = actual.RunFor(500);
+            EXPECT_EQ(result.reason, StopReason::Budget);
+            EXPECT_EQ(result.executed, 500u);
+            ExpectSameState(expected, actual, static_cast<u16>(variant));
+        }
+    }
+}
+
+TEST(RunTest, StopsAtEvents)
+{
+    // 6005: LD V0, 0x05
+    // F018: LD ST, V0
+    // A000: LD I, 0x000
+    // D001: DRW V0, V0, 1
+    // F10A: LD V1, K
+    const program_t program = {0x6005, 0xF018, 0xA000, 0xD001, 0xF10A};
+
+    Chip8 chip8;
+    chip8.timing = Timing::Frame;
+    LoadProgram(chip8, program);
+
+    EXPECT_EQ(chip8.RunUntil(ALL, 100).reason, StopReason::Sound);
+    EXPECT_EQ(chip8.pc, 0x204);
+
+    const RunResult draw = chip8.RunUntil(ALL, 100);
+    EXPECT_EQ(draw.reason, StopReason::Draw);
+    EXPECT_EQ(draw.executed, 2u);
+
+    const RunResult wait = chip8.RunUntil(ALL, 100);
+    EXPECT_EQ(wait.reason, StopReason::KeyWait);
+    EXPECT_EQ(chip8.pc, 0x208);
+
+    chip8.keypad[0x4] = 1;
+    EXPECT_EQ(chip8.RunUntil(StopOn(StopReason::KeyWait), 1).reason, StopReason::Budget);
+    EXPECT_EQ(chip8.registers[0x1], 0x4);
+
+    // The timer running out is a sound change as well
+    LoadProgram(chip8, COUNTER);
+    chip8.pc = Chip8::START_ADDRESS;
+    chip8.timing = Timing::PerInstruction;
+    const RunResult silence = chip8.RunUntil(StopOn(StopReason::Sound), 100);
+    EXPECT_EQ(silence.reason, StopReason::Sound);
+    EXPECT_EQ(silence.executed, 5u);
+}
+
+TEST(RunTest, StopsBeforeBreakpoint)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, COUNTER);
+    chip8.breakpoints.set(Chip8::START_ADDRESS);
+
+    const RunResult first = chip8.RunFor(100);
+    EXPECT_EQ(first.reason, StopReason::Breakpoint);
+    EXPECT_EQ(first.executed, 2u);
+    EXPECT_EQ(chip8.registers[0x0], 1);
+
+    // Continues from the breakpoint
+    EXPECT_EQ(chip8.RunFor(100).executed, 2u);
+    EXPECT_EQ(chip8.registers[0x0], 2);
+
+    // Only RunUntil calls that ask for breakpoints stop at them
+    EXPECT_EQ(chip8.RunUntil(StopOn(StopReason::Draw), 100).reason, StopReason::Budget);
+    EXPECT_EQ(chip8.registers[0x0], 52);
+}
+
+TEST(RunTest, SchedulerContinuesFrame)
+{
+    // 6002: LD V0, 0x02
+    // F018: LD ST, V0
+    // 1204: JP 0x204
+    Chip8 chip8;
+    LoadProgram(chip8, {0x6002, 0xF018, 0x1204});
+
+    Scheduler scheduler(chip8, 10);
+
+    const RunResult sound = scheduler.RunUntil(StopOn(StopReason::Sound));
+    EXPECT_EQ(sound.reason, StopReason::Sound);
+    EXPECT_EQ(sound.executed, 2u);
+    EXPECT_EQ(scheduler.frames, 0u);
+
+    const RunResult end = scheduler.RunUntil(StopOn(StopReason::Sound));
+    EXPECT_EQ(end.reason, StopReason::FrameEnd);
+    EXPECT_EQ(end.executed, 8u);
+    EXPECT_EQ(scheduler.frames, 1u);
+    EXPECT_EQ(chip8.soundTimer, 1);
+
+    scheduler.RunFrame();
+    EXPECT_EQ(chip8.soundTimer, 0);
+    EXPECT_EQ(scheduler.frames, 2u);
+}
@@ -0,0 +1,175 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <deque>
+
+#include "emulator.h"
+#include "helpers.h"
+#include "runtime.h"
+#include "scheduler.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+// 6105: LD V1, 0x05
+// F115: LD DT, V1
+// F307: LD V3, DT      <- polls until DT == 2
+// 3302: SE V3, 0x02
+// 1204: JP 0x204
+// 7401: ADD V4, 0x01
+// F00A: LD V0, K       <- waits for a key
+// 7501: ADD V5, 0x01
+// 1200: JP 0x200
+const program_t WAITS = {0x6105, 0xF115, 0xF307, 0x3302, 0x1204, 0x7401, 0xF00A, 0x7501, 0x1200};
+
+Task SleepFor(Runtime& runtime, u64 frames, u64& wokenAt)
+{
+    co_await runtime.Sleep(frames);
+    wokenAt = runtime.Frame();
+}
+}  // namespace
+
+TEST(RuntimeTest, MatchesScheduler)
+{
+    for (const program_t& program : {MIXED, TIMERS, IDIOMS, WAITS})
+    {
+        for (u32 instructionsPerFrame : {1u, 3u, 12u, 1000u})
+        {
+            Chip8 expected;
+            LoadProgram(expected, program);
+            expected.soundTimer = 30;
+
+            Runtime runtime;
+            Emulator emulator(runtime, expected, instructionsPerFrame);
+            runtime.Spawn(emulator.Run());
+
+            Scheduler scheduler(expected, instructionsPerFrame);
+            scheduler.fastForward = false;
+
+            for (u32 frame = 0; frame < 300; ++frame)
+            {
+                runtime.RunFrame();
+                scheduler.RunFrame();
+
+                if (frame == 150)
+                {
+                    keypad_t keys{};
+                    keys[0x7] = 1;
+                    emulator.SetKeys(keys);
+                    expected.keypad = keys;
+                }
+            }
+
+            emulator.CatchUp();
+            ExpectSameState(expected, emulator.chip8, static_cast<u16>(instructionsPerFrame));
+            EXPECT_EQ(scheduler.frames, emulator.scheduler.frames);
+        }
+    }
+}
+
+TEST(RuntimeTest, SleepsUntilInput)
+{
+    // F20A: LD V2, K
+    // 1202: JP 0x202
+    Chip8 chip8;
+    LoadProgram(chip8, {0xF20A, 0x1202});
+
+    Runtime runtime;
+    Emulator emulator(runtime, chip8);
+    runtime.Spawn(emulator.Run());
+
+    for (u32 frame = 0; frame < 100; ++frame)
+    {
+        runtime.RunFrame();
+    }
+    EXPECT_EQ(runtime.resumes, 1u);
+    EXPECT_EQ(emulator.chip8.pc, Chip8::START_ADDRESS);
+
+    keypad_t keys{};
+    keys[0xB] = 1;
+    emulator.SetKeys(keys);
+    runtime.RunFrame();
+    runtime.RunFrame();
+    emulator.CatchUp();
+    EXPECT_EQ(emulator.chip8.registers[0x2], 0xB);
+    EXPECT_EQ(emulator.chip8.pc, Chip8::START_ADDRESS + 2);
+    EXPECT_EQ(emulator.scheduler.frames, 102u);
+
+    // A jump to itself only wakes for input
+    const u64 resumes = runtime.resumes;
+    for (u32 frame = 0; frame < 100; ++frame)
+    {
+        runtime.RunFrame();
+    }
+    EXPECT_EQ(runtime.resumes, resumes);
+}
+
+TEST(RuntimeTest, SleepsLongerThanWheel)
+{
+    Runtime runtime;
+    u64 shortWake = 0;
+    u64 longWake = 0;
+    runtime.Spawn(SleepFor(runtime, 3, shortWake));
+    runtime.Spawn(SleepFor(runtime, Runtime::WHEEL_SIZE * 2 + 3, longWake));
+
+    for (u32 frame = 0; frame < Runtime::WHEEL_SIZE * 3; ++frame)
+    {
+        runtime.RunFrame();
+    }
+
+    EXPECT_EQ(shortWake, 3u);
+    EXPECT_EQ(longWake, Runtime::WHEEL_SIZE * 2 + 3);
+    EXPECT_EQ(runtime.resumes, 4u);
+}
+
+TEST(RuntimeTest, RunsManyEmulators)
+{
+    Runtime runtime;
+    std::deque<Emulator> emulators;
+
+    for (u32 i = 0; i < 1000; ++i)
+    {
+        Chip8 chip8;
+        LoadProgram(chip8, WAITS);
+        chip8.registers[0x4] = static_cast<u8>(i);
+        runtime.Spawn(emulators.emplace_back(runtime, chip8, 3 + i % 20).Run());
+    }
+
+    for (u32 frame = 0; frame < 60; ++frame)
+    {
+        runtime.RunFrame();
+    }
+
+    for (u32 i = 0; i < 1000; ++i)
+    {
+        emulators[i].CatchUp();
+        const Chip8& chip8 = emulators[i].chip8;
+        EXPECT_EQ(chip8.registers[0x4], static_cast<u8>(i + 1));
+        EXPECT_EQ(chip8.pc, Chip8::START_ADDRESS + 12);
+    }
+    // Every emulator waits for a key and only ran a few frames itself
+    EXPECT_LT(runtime.resumes, 1000u * 10);
+}
@@ -0,0 +1,142 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "emulator.h"
+#include "helpers.h"
+#include "save_state.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+/// Save state file in the temporary directory, removed again at the end of the test
+class SaveStateTest : public ::testing::Test
+{
+protected:
+    void TearDown() override { std::filesystem::remove(path); }
+
+    const std::string path =
+        (std::filesystem::temp_directory_path() /
+         ("chip8_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".sav"))
+            .string();
+};
+
+Chip8 Running(const program_t& program, u64 cycles)
+{
+    Chip8 chip8;
+    chip8.Reset(7);
+    LoadProgram(chip8, program);
+    chip8.Run(cycles);
+    return chip8;
+}
+}  // namespace
+
+TEST(SnapshotTest, RestoreReturnsToSnapshot)
+{
+    for (const program_t& program : {MIXED, TIMERS, SUPER_CHIP, XO_CHIP})
+    {
+        Chip8 chip8 = Running(program, 50);
+        const MachineState snapshot = chip8.Snapshot();
+        const Chip8 expected = chip8;
+
+        chip8.Run(200);
+        chip8.Restore(snapshot);
+
+        ExpectSameState(expected, chip8, program.front());
+        EXPECT_EQ(expected.keypad, chip8.keypad);
+    }
+}
+
+TEST(SnapshotTest, RestoreDropsDecodeCache)
+{
+    // The snapshot is taken before SELF_MODIFYING rewrote itself, the cached decoding of the rewritten instruction
+    // must not survive the restore
+    Chip8 expected;
+    LoadProgram(expected, SELF_MODIFYING);
+    expected.dispatch = Dispatch::Cached;
+    Chip8 chip8 = expected;
+    const MachineState snapshot = chip8.Snapshot();
+
+    chip8.Run(100);
+    chip8.Restore(snapshot);
+    chip8.Run(3);
+    expected.Run(3);
+
+    ExpectSameState(expected, chip8, 0);
+}
+
+TEST_F(SaveStateTest, SavesAndLoads)
+{
+    Chip8 saved = Running(XO_CHIP, 100);
+    saved.variant = Variant::XoChip;
+    ASSERT_TRUE(SaveState(saved, path));
+
+    Chip8 loaded;
+    ASSERT_TRUE(LoadState(loaded, path));
+    ExpectSameState(saved, loaded, 0);
+    EXPECT_EQ(loaded.variant, Variant::XoChip);
+    EXPECT_EQ(std::filesystem::file_size(path), sizeof(SaveStateHeader) + sizeof(MachineState));
+}
+
+TEST_F(SaveStateTest, MapsFile)
+{
+    Chip8 saved = Running(MIXED, 100);
+    saved.variant = Variant::SuperChip;
+    ASSERT_TRUE(SaveState(saved, path));
+
+    MappedSaveState mapped(path);
+    ASSERT_TRUE(mapped.Valid());
+    EXPECT_EQ(mapped.GetVariant(), Variant::SuperChip);
+    EXPECT_EQ(mapped.State().pc, saved.pc);
+
+    Chip8 restored;
+    restored.Restore(mapped.State());
+    ExpectSameState(saved, restored, 0);
+}
+
+TEST_F(SaveStateTest, RejectsOtherVersions)
+{
+    const Chip8 saved = Running(MIXED, 100);
+    ASSERT_TRUE(SaveState(saved, path));
+
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        const u32 version = SaveStateHeader::VERSION + 1;
+        file.seekp(offsetof(SaveStateHeader, version));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+
+    Chip8 chip8;
+    const Chip8 untouched = chip8;
+    EXPECT_FALSE(LoadState(chip8, path));
+    ExpectSameState(untouched, chip8, 0);
+    EXPECT_FALSE(MappedSaveState(path).Valid());
+
+    EXPECT_FALSE(LoadState(chip8, path + ".missing"));
+    EXPECT_FALSE(MappedSaveState(path + ".missing").Valid());
+}
@@ -0,0 +1,186 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "emulator.h"
+#include "helpers.h"
+#include "scheduler.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+// 1200: JP 0x200
+const program_t SPIN = {0x1200};
+}  // namespace
+
+TEST(SchedulerTest, TicksTimersOncePerFrame)
+{
+    for (u32 instructionsPerFrame : {1u, 12u, 1000u})
+    {
+        Chip8 chip8;
+        LoadProgram(chip8, SPIN);
+        chip8.delayTimer = 200;
+        chip8.soundTimer = 100;
+
+        Scheduler scheduler(chip8, instructionsPerFrame);
+        scheduler.RunFrames(60);
+
+        EXPECT_EQ(chip8.delayTimer, 140);
+        EXPECT_EQ(chip8.soundTimer, 40);
+        EXPECT_EQ(scheduler.frames, 60u);
+        EXPECT_EQ(scheduler.EmulatedTime(), std::chrono::seconds(1));
+    }
+}
+
+TEST(SchedulerTest, RunsInstructionBudget)
+{
+    // 7001: ADD V0, 0x01
+    // 1200: JP 0x200
+    Chip8 chip8;
+    LoadProgram(chip8, {0x7001, 0x1200});
+
+    Scheduler scheduler(chip8, 10);
+    scheduler.RunFrame();
+    EXPECT_EQ(chip8.registers[0x0], 5);
+
+    scheduler.instructionsPerFrame = 100;
+    scheduler.RunFrame();
+    EXPECT_EQ(chip8.registers[0x0], 55);
+}
+
+TEST(SchedulerTest, AdvanceCarriesRemainder)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, SPIN);
+    chip8.delayTimer = 10;
+
+    Scheduler scheduler(chip8);
+    EXPECT_EQ(scheduler.Advance(std::chrono::milliseconds(10)), 0u);
+    EXPECT_EQ(chip8.delayTimer, 10);
+    EXPECT_EQ(scheduler.Advance(std::chrono::milliseconds(10)), 1u);
+    EXPECT_EQ(scheduler.Advance(std::chrono::milliseconds(50)), 3u);
+    EXPECT_EQ(chip8.delayTimer, 6);
+}
+
+TEST(SchedulerTest, FastForwardKeepsState)
+{
+    // 6105: LD V1, 0x05
+    // F115: LD DT, V1
+    // F307: LD V3, DT      <- polls until DT == 2
+    // 3302: SE V3, 0x02
+    // 1204: JP 0x204
+    // 7401: ADD V4, 0x01
+    // F00A: LD V0, K       <- waits for a key
+    // 7501: ADD V5, 0x01
+    // 1210: JP 0x210
+    const program_t program = {0x6105, 0xF115, 0xF307, 0x3302, 0x1204, 0x7401, 0xF00A, 0x7501, 0x1210};
+
+    for (u32 instructionsPerFrame : {1u, 2u, 3u, 4u, 5u, 12u, 1000u})
+    {
+        Chip8 expected;
+        Chip8 actual;
+        LoadProgram(expected, program);
+        LoadProgram(actual, program);
+        expected.soundTimer = 50;
+        actual.soundTimer = 50;
+
+        Scheduler slow(expected, instructionsPerFrame);
+        Scheduler fast(actual, instructionsPerFrame);
+        slow.fastForward = false;
+
+        for (u64 frames : {1u, 2u, 7u, 100u})
+        {
+            slow.RunFrames(frames);
+            fast.RunFrames(frames);
+            ExpectSameState(expected, actual, static_cast<u16>(instructionsPerFrame));
+        }
+
+        expected.keypad[0x7] = 1;
+        actual.keypad[0x7] = 1;
+        slow.RunFrames(3);
+        fast.RunFrames(3);
+        ExpectSameState(expected, actual, static_cast<u16>(instructionsPerFrame));
+        EXPECT_EQ(slow.frames, fast.frames);
+    }
+}
+
+TEST(SchedulerTest, FindsIdleLoops)
+{
+    Chip8 chip8;
+    Scheduler scheduler(chip8);
+
+    // F307: LD V3, DT
+    // 3302: SE V3, 0x02
+    // 1200: JP 0x200
+    LoadProgram(chip8, {0xF307, 0x3302, 0x1200});
+    chip8.delayTimer = 10;
+    EXPECT_EQ(scheduler.IdleFrames(), 8u);
+
+    chip8.pc += 2;
+    chip8.registers[0x3] = 0x2;
+    EXPECT_EQ(scheduler.IdleFrames(), 0u);
+
+    chip8.delayTimer = 1;
+    chip8.registers[0x3] = 0x1;
+    EXPECT_EQ(scheduler.IdleFrames(), Scheduler::IDLE_FOREVER);
+
+    LoadProgram(chip8, {0xF20A});
+    chip8.pc = Chip8::START_ADDRESS;
+    EXPECT_EQ(scheduler.IdleFrames(), Scheduler::IDLE_FOREVER);
+    chip8.keypad[0xA] = 1;
+    EXPECT_EQ(scheduler.IdleFrames(), 0u);
+
+    LoadProgram(chip8, {0x7001, 0x1200});
+    EXPECT_EQ(scheduler.IdleFrames(), 0u);
+}
+
+TEST(SchedulerTest, SkipsIdleFramesInConstantTime)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, SPIN);
+    chip8.delayTimer = 100;
+
+    Scheduler scheduler(chip8, 1000);
+    scheduler.RunFrames(u64{1} << 40);
+
+    EXPECT_EQ(scheduler.frames, u64{1} << 40);
+    EXPECT_EQ(chip8.delayTimer, 0);
+    EXPECT_EQ(chip8.pc, Chip8::START_ADDRESS);
+}
+
+TEST(SchedulerTest, PerInstructionTimingStillTicksEveryCycle)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, SPIN);
+    chip8.delayTimer = 50;
+
+    chip8.Run(10);
+    EXPECT_EQ(chip8.delayTimer, 40);
+
+    chip8.timing = Timing::Frame;
+    chip8.Run(10);
+    chip8.Cycle();
+    EXPECT_EQ(chip8.delayTimer, 40);
+}
@@ -0,0 +1,117 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "block_cache.h"
+#include "emulator.h"
+#include "helpers.h"
+#include "scheduler.h"
+#include "state_hash.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+TEST(StateHashTest, FollowsEveryEngine)
+{
+    for (Dispatch dispatch : {Dispatch::Table, Dispatch::Switch, Dispatch::Cached, Dispatch::Specialized})
+    {
+        for (const program_t& program : {SELF_MODIFYING, TIMERS, MIXED, IDIOMS, SUPER_CHIP, XO_CHIP})
+        {
+            Chip8 chip8;
+            chip8.Reset(9);
+            LoadProgram(chip8, program);
+            chip8.dispatch = dispatch;
+            Scheduler scheduler(chip8, 7);
+
+            for (u32 frame = 0; frame < 50; ++frame)
+            {
+                scheduler.RunFrame();
+                ASSERT_EQ(chip8.StateHash(), HashState(chip8)) << "Frame " << frame;
+            }
+        }
+    }
+}
+
+TEST(StateHashTest, FollowsBlockCache)
+{
+    for (const program_t& program : {SELF_MODIFYING, MIXED, SUPER_CHIP, XO_CHIP})
+    {
+        Chip8 chip8;
+        LoadProgram(chip8, program);
+        BlockCache cache(chip8);
+
+        for (u32 slice = 0; slice < 50; ++slice)
+        {
+            cache.Run(13);
+            ASSERT_EQ(chip8.StateHash(), HashState(chip8)) << "Slice " << slice;
+        }
+    }
+}
+
+TEST(StateHashTest, DistinguishesStates)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, MIXED);
+    const u64 start = chip8.StateHash();
+
+    Chip8 same;
+    LoadProgram(same, MIXED);
+    EXPECT_EQ(same.StateHash(), start);
+
+    chip8.registers[0x5] = 1;
+    const u64 registerChanged = chip8.StateHash();
+    EXPECT_NE(registerChanged, start);
+
+    chip8.memory[0x400] = 1;
+    chip8.InvalidateDecodeCache(0x400, 1);
+    const u64 memoryChanged = chip8.StateHash();
+    EXPECT_NE(memoryChanged, registerChanged);
+
+    chip8.video[3] = 1;
+    chip8.InvalidateVideo();
+    const u64 videoChanged = chip8.StateHash();
+    EXPECT_NE(videoChanged, memoryChanged);
+    EXPECT_EQ(videoChanged, HashState(chip8));
+
+    // Moving a byte to another page changes the hash as well
+    chip8.memory[0x400] = 0;
+    chip8.memory[0x500] = 1;
+    chip8.InvalidateDecodeCache(0x400, 0x101);
+    EXPECT_NE(chip8.StateHash(), videoChanged);
+    EXPECT_EQ(chip8.StateHash(), HashState(chip8));
+}
+
+TEST(StateHashTest, FollowsRestore)
+{
+    Chip8 chip8;
+    LoadProgram(chip8, XO_CHIP);
+    chip8.Run(100);
+    const MachineState snapshot = chip8.Snapshot();
+    const u64 hash = chip8.StateHash();
+
+    chip8.Run(100);
+    EXPECT_NE(chip8.StateHash(), hash);
+
+    chip8.Restore(snapshot);
+    EXPECT_EQ(chip8.StateHash(), hash);
+}
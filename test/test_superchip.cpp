@@ -0,0 +1,212 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "core.h"
+#include "emulator.h"
+#include "helpers.h"
+#include "quirks.h"
+#include "types.h"
+#include "video.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+/// Run a program with the table engine until it reaches the last instruction
+void RunProgram(Chip8& chip8, const program_t& program)
+{
+    LoadProgram(chip8, program);
+
+    for (size_t i = 0; i < program.size(); ++i)
+    {
+        chip8.Cycle();
+    }
+}
+
+/// Store a 16x16 sprite with a single row set to the given pixels
+void StoreLargeSprite(Chip8& chip8, u32 row, u16 pixels)
+{
+    std::fill_n(chip8.memory.begin() + chip8.index, 32, 0);
+    chip8.memory[chip8.index + 2 * row] = pixels >> 8u;
+    chip8.memory[chip8.index + 2 * row + 1] = pixels & 0xFFu;
+}
+}  // namespace
+
+TEST(SuperChipTest, DecodesExtendedInstructions)
+{
+    EXPECT_EQ(DECODE_TABLE[0x00C7].op, Op::OP_00Cn);
+    EXPECT_EQ(DECODE_TABLE[0x00C7].n, 0x7);
+    EXPECT_EQ(DECODE_TABLE[0x00FB].op, Op::OP_00FB);
+    EXPECT_EQ(DECODE_TABLE[0x00FC].op, Op::OP_00FC);
+    EXPECT_EQ(DECODE_TABLE[0x00FD].op, Op::OP_00FD);
+    EXPECT_EQ(DECODE_TABLE[0x00FE].op, Op::OP_00FE);
+    EXPECT_EQ(DECODE_TABLE[0x00FF].op, Op::OP_00FF);
+    EXPECT_EQ(DECODE_TABLE[0xF330].op, Op::OP_Fx30);
+    EXPECT_EQ(DECODE_TABLE[0xF375].op, Op::OP_Fx75);
+    EXPECT_EQ(DECODE_TABLE[0xF385].op, Op::OP_Fx85);
+
+    // The loose decoding of the other instructions in the 0 family is unchanged
+    EXPECT_EQ(DECODE_TABLE[0x00E0].op, Op::OP_00E0);
+    EXPECT_EQ(DECODE_TABLE[0x00EE].op, Op::OP_00EE);
+    EXPECT_EQ(DECODE_TABLE[0x0120].op, Op::OP_00E0);
+    EXPECT_EQ(DECODE_TABLE[0x00FA].op, Op::OP_NOP);
+}
+
+TEST(SuperChipTest, SwitchesResolution)
+{
+    Chip8 chip8;
+    chip8.video[3] = 1;
+
+    RunProgram(chip8,
+               {
+                   0x00FF,  // 200: HIGH
+                   0x607C,  // 202: LD V0, 7C
+                   0x613E,  // 204: LD V1, 3E
+                   0xA050,  // 206: LD I, 050
+                   0xD011,  // 208: DRW V0, V1, 1
+               });
+
+    EXPECT_TRUE(chip8.hires);
+    EXPECT_EQ(chip8.video[3], 1u);
+    EXPECT_TRUE(Pixel(chip8.hiresVideo, 124, 62));
+    EXPECT_TRUE(Pixel(chip8.hiresVideo, 127, 62));
+    EXPECT_FALSE(Pixel(chip8.hiresVideo, 0, 63));
+
+    chip8.opcode = 0x00FE;
+    chip8.OP_00FE();
+
+    EXPECT_FALSE(chip8.hires);
+    EXPECT_EQ(chip8.video, video_mem_t{});
+}
+
+TEST(SuperChipTest, DrawsLargeSpritesAcrossWords)
+{
+    Chip8 chip8;
+    chip8.hires = true;
+    chip8.index = 0x300;
+    chip8.registers[0x1] = 56;
+    chip8.registers[0x2] = 10;
+
+    for (u32 i = 0; i < 32; ++i)
+    {
+        chip8.memory[chip8.index + i] = static_cast<u8>(0x11 * i + 3);
+    }
+
+    ops::OP_Dxyn<quirks::SuperChip>(chip8, 0x1, 0x2, 0);
+    EXPECT_EQ(chip8.registers[0xF], 0);
+
+    for (u32 row = 0; row < 16; ++row)
+    {
+        const u16 bits = (chip8.memory[chip8.index + 2 * row] << 8u) | chip8.memory[chip8.index + 2 * row + 1];
+
+        for (u32 col = 0; col < 16; ++col)
+        {
+            EXPECT_EQ(Pixel(chip8.hiresVideo, 56 + col, 10 + row), (bits & (0x8000u >> col)) != 0) << col << ", " << row;
+        }
+    }
+
+    ops::OP_Dxyn<quirks::SuperChip>(chip8, 0x1, 0x2, 0);
+    EXPECT_EQ(chip8.registers[0xF], 1);
+    EXPECT_EQ(chip8.hiresVideo, hires_video_t{});
+}
+
+TEST(SuperChipTest, RightEdgeFollowsQuirks)
+{
+    Chip8 initial;
+    initial.hires = true;
+    initial.index = 0x300;
+    initial.registers[0x1] = 120;
+    StoreLargeSprite(initial, 0, 0xFFFF);
+
+    Chip8 clipped = initial;
+    Core<quirks::SuperChip>::Execute(clipped, DECODE_TABLE[0xD120]);
+    EXPECT_TRUE(Pixel(clipped.hiresVideo, 127, 0));
+    EXPECT_FALSE(Pixel(clipped.hiresVideo, 0, 0));
+    EXPECT_FALSE(Pixel(clipped.hiresVideo, 0, 1));
+
+    Chip8 wrapped = initial;
+    Core<quirks::XoChip>::Execute(wrapped, DECODE_TABLE[0xD120]);
+    EXPECT_TRUE(Pixel(wrapped.hiresVideo, 7, 0));
+    EXPECT_FALSE(Pixel(wrapped.hiresVideo, 8, 0));
+}
+
+TEST(SuperChipTest, ScrollsInBothResolutions)
+{
+    Chip8 chip8;
+    chip8.video[0] = PixelMask(10);
+    chip8.hiresVideo[0] = PixelMask(60);
+
+    RunProgram(chip8,
+               {
+                   0x00C2,  // 200: SCD 2
+                   0x00FB,  // 202: SCR
+               });
+    EXPECT_EQ(chip8.video[2], PixelMask(14));
+    EXPECT_EQ(chip8.hiresVideo[0], PixelMask(60));
+
+    chip8.pc = Chip8::START_ADDRESS;
+    chip8.hires = true;
+    RunProgram(chip8,
+               {
+                   0x00C3,  // 200: SCD 3
+                   0x00FB,  // 202: SCR
+                   0x00FB,  // 204: SCR
+                   0x00FC,  // 206: SCL
+               });
+    EXPECT_TRUE(Pixel(chip8.hiresVideo, 64, 3));
+    EXPECT_EQ(chip8.video[2], PixelMask(14));
+}
+
+TEST(SuperChipTest, BigFontAndFlagRegisters)
+{
+    Chip8 chip8;
+    chip8.registers = {0x7, 0x1, 0x2, 0x3};
+
+    RunProgram(chip8,
+               {
+                   0xF030,  // 200: LD HF, V0
+                   0xF375,  // 202: LD R, V3
+                   0x6000,  // 204: LD V0, 0
+                   0x6300,  // 206: LD V3, 0
+                   0xF285,  // 208: LD V2, R
+               });
+
+    EXPECT_EQ(chip8.index, Chip8::BIG_FONTSET_START_ADDRESS + 70);
+    EXPECT_TRUE(std::equal(bigFontset.begin(), bigFontset.end(),
+                           chip8.memory.begin() + Chip8::BIG_FONTSET_START_ADDRESS));
+    EXPECT_EQ(chip8.registers[0x0], 0x7);
+    EXPECT_EQ(chip8.registers[0x2], 0x2);
+    EXPECT_EQ(chip8.registers[0x3], 0x0);
+    EXPECT_EQ(chip8.flagRegisters[0x3], 0x3);
+}
+
+TEST(SuperChipTest, ExitStopsOnTheInstruction)
+{
+    Chip8 chip8;
+    RunProgram(chip8, {0x00FD});
+    chip8.Cycle();
+
+    EXPECT_EQ(chip8.pc, Chip8::START_ADDRESS);
+}
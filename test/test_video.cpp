@@ -0,0 +1,185 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "emulator.h"
+#include "instructions.h"
+#include "types.h"
+#include "video.h"
+
+using namespace chip8;
+
+namespace
+{
+/// The pixel per u32 drawing the packed framebuffer replaced, including its wrap into the next row
+bool DrawLinear(const Chip8& c, u8 x, u8 y, u8 n, rgba_buffer_t& video)
+{
+    u8 xPos = c.registers[x] % VIDEO_WIDTH;
+    u8 yPos = c.registers[y] % VIDEO_HEIGHT;
+
+    bool collision = false;
+
+    for (u32 row = 0; row < n; row++)
+    {
+        u8 spriteByte = c.memory[c.index + row];
+
+        for (u32 col = 0; col < 8; col++)
+        {
+            u32 pixel = ((yPos + row) * VIDEO_WIDTH + (xPos + col)) % (VIDEO_WIDTH * VIDEO_HEIGHT);
+
+            if (spriteByte & (0x80 >> col))
+            {
+                collision |= video[pixel] == PIXEL_ON;
+                video[pixel] ^= PIXEL_ON;
+            }
+        }
+    }
+
+    return collision;
+}
+}  // namespace
+
+TEST(VideoTest, DrawingMatchesLinearFramebuffer)
+{
+    std::mt19937 random(10);
+
+    Chip8 emulator;
+    emulator.index = 0x300;
+    rgba_buffer_t reference{};
+
+    for (u32 i = 0; i < 5000; ++i)
+    {
+        emulator.registers[0x1] = random() & 0xFFu;
+        emulator.registers[0x2] = random() & 0xFFu;
+        // Dxy0 draws a 16x16 sprite
+        const u8 n = 1 + random() % 15;
+
+        for (u32 row = 0; row < n; ++row)
+        {
+            emulator.memory[emulator.index + row] = random() & 0xFFu;
+        }
+
+        const bool expected = DrawLinear(emulator, 0x1, 0x2, n, reference);
+        ops::OP_Dxyn(emulator, 0x1, 0x2, n);
+
+        rgba_buffer_t actual{};
+        ExpandToRgba(emulator.video, actual.data());
+
+        ASSERT_EQ(emulator.registers[0xF], expected ? 1 : 0) << "Draw " << i;
+        ASSERT_EQ(actual, reference) << "Draw " << i;
+    }
+}
+
+TEST(VideoTest, ExpandsEveryPixel)
+{
+    video_mem_t video{};
+    video[0] = PixelMask(0) | PixelMask(63);
+    video[31] = 0xA5A5A5A5A5A5A5A5;
+
+    rgba_buffer_t rgba{};
+    ExpandToRgba(video, rgba.data());
+
+    for (u32 y = 0; y < VIDEO_HEIGHT; ++y)
+    {
+        for (u32 x = 0; x < VIDEO_WIDTH; ++x)
+        {
+            ASSERT_EQ(rgba[y * VIDEO_WIDTH + x], Pixel(video, x, y) ? PIXEL_ON : PIXEL_OFF) << x << ", " << y;
+        }
+    }
+}
+
+TEST(VideoTest, RgbaFrameOnlyExpandsChanges)
+{
+    MachineState state{};
+    RgbaFrame frame;
+
+    ASSERT_TRUE(frame.Update(state));
+    ASSERT_FALSE(frame.Update(state));
+
+    // Low resolution pixels cover 2x2 pixels of the frame
+    state.video[5] = PixelMask(7);
+    ASSERT_TRUE(frame.Update(state));
+    ASSERT_EQ(frame.Data()[10 * RgbaFrame::WIDTH + 14], PIXEL_ON);
+    ASSERT_EQ(frame.Data()[11 * RgbaFrame::WIDTH + 15], PIXEL_ON);
+    ASSERT_EQ(frame.Data()[10 * RgbaFrame::WIDTH + 16], PIXEL_OFF);
+    ASSERT_FALSE(frame.Update(state));
+
+    state.hires = true;
+    ASSERT_TRUE(frame.Update(state));
+    ASSERT_EQ(frame.Data()[10 * RgbaFrame::WIDTH + 14], PIXEL_OFF);
+
+    state.hiresVideo[2 * 63 + 1] = PixelMask(63);
+    ASSERT_TRUE(frame.Update(state));
+    ASSERT_EQ(frame.Data()[63 * RgbaFrame::WIDTH + 127], PIXEL_ON);
+    ASSERT_FALSE(frame.Update(state));
+}
+
+TEST(VideoTest, ScrollsWholeRows)
+{
+    std::mt19937 random(12);
+
+    hires_video_t video{};
+    std::generate(video.begin(), video.end(), [&] { return (u64{random()} << 32u) | random(); });
+
+    hires_video_t right = video;
+    ScrollRight(right, 4);
+    hires_video_t left = video;
+    ScrollLeft(left, 4);
+    hires_video_t down = video;
+    ScrollDown(down, 5);
+
+    for (u32 y = 0; y < HIRES_HEIGHT; ++y)
+    {
+        for (u32 x = 0; x < HIRES_WIDTH; ++x)
+        {
+            ASSERT_EQ(Pixel(right, x, y), x >= 4 && Pixel(video, x - 4, y)) << x << ", " << y;
+            ASSERT_EQ(Pixel(left, x, y), x + 4 < HIRES_WIDTH && Pixel(video, x + 4, y)) << x << ", " << y;
+            ASSERT_EQ(Pixel(down, x, y), y >= 5 && Pixel(video, x, y - 5)) << x << ", " << y;
+        }
+    }
+}
+
+TEST(VideoTest, FrameHashOnlyCoversShownFramebuffer)
+{
+    Chip8 chip8;
+    const u64 empty = FrameHash(chip8);
+
+    chip8.hiresVideo[5] = 1;
+    EXPECT_EQ(FrameHash(chip8), empty);
+
+    chip8.video2[3] = PixelMask(7);
+    const u64 drawn = FrameHash(chip8);
+    EXPECT_NE(drawn, empty);
+
+    chip8.video[3] = PixelMask(7);
+    chip8.video2[3] = 0;
+    EXPECT_NE(FrameHash(chip8), drawn);
+
+    chip8.hires = true;
+    const u64 hires = FrameHash(chip8);
+    chip8.hiresVideo[5] = 0;
+    EXPECT_NE(FrameHash(chip8), hires);
+}
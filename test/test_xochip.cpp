@@ -0,0 +1,221 @@
+/// MIT License
+///
+/// Copyright(c) 2023 Simon Lauser
+///
+/// Permission is hereby granted,
+/// free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"),
+/// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+/// publish, distribute, sublicense, and / or sell copies of the Software,
+/// and to permit persons to whom the Software is furnished to do so,
+/// subject to the following conditions :
+///
+/// The above copyright notice and this permission notice shall be included in all copies
+/// or
+/// substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS",
+/// WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND
+/// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+/// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "core.h"
+#include "emulator.h"
+#include "helpers.h"
+#include "quirks.h"
+#include "types.h"
+#include "video.h"
+
+using namespace chip8;
+using namespace chip8::test;
+
+namespace
+{
+/// Run a program with the core of the given platform until it reaches the last instruction
+template <typename Quirks>
+void RunProgram(Chip8& chip8, const program_t& program, u32 cycles)
+{
+    LoadProgram(chip8, program);
+    Core<Quirks>::Run(chip8, cycles);
+}
+}  // namespace
+
+TEST(XoChipTest, DecodesExtendedInstructions)
+{
+    EXPECT_EQ(DECODE_TABLE[0x00D3].op, Op::OP_00Dn);
+    EXPECT_EQ(DECODE_TABLE[0x5122].op, Op::OP_5xy2);
+    EXPECT_EQ(DECODE_TABLE[0x5123].op, Op::OP_5xy3);
+    EXPECT_EQ(DECODE_TABLE[0x5120].op, Op::OP_5xy0);
+    EXPECT_EQ(DECODE_TABLE[0xF000].op, Op::OP_F000);
+    EXPECT_EQ(DECODE_TABLE[0xF201].op, Op::OP_Fn01);
+    EXPECT_EQ(DECODE_TABLE[0xF201].x, 0x2);
+    EXPECT_EQ(DECODE_TABLE[0xF002].op, Op::OP_F002);
+    EXPECT_EQ(DECODE_TABLE[0xF43A].op, Op::OP_Fx3A);
+}
+
+TEST(XoChipTest, MemoryMatchesBuildOption)
+{
+#ifdef CHIP8_XO_CHIP_MEMORY
+    EXPECT_EQ(Chip8{}.memory.size(), 0x10000u);
+#else
+    EXPECT_EQ(Chip8{}.memory.size(), 0x1000u);
+#endif
+}
+
+TEST(XoChipTest, LongLoadSkipsItsAddress)
+{
+    Chip8 chip8;
+    RunProgram<quirks::XoChip>(chip8,
+                               {
+                                   0xF000,  // 200: LD I, 0234
+                                   0x0234,  // 202:
+                                   0x6001,  // 204: LD V0, 1
+                               },
+                               2);
+
+    EXPECT_EQ(chip8.index, 0x234);
+    EXPECT_EQ(chip8.pc, 0x206);
+    EXPECT_EQ(chip8.registers[0x0], 1);
+
+    // Addresses beyond the memory wrap around
+    chip8.Reset();
+    RunProgram<quirks::XoChip>(chip8, {0xF000, 0xFFFE}, 1);
+    EXPECT_EQ(chip8.index, 0xFFFEu % MEMORY_SIZE);
+}
+
+TEST(XoChipTest, SkipsCoverLongLoads)
+{
+    const program_t program = {
+        0x3000,  // 200: SE V0, 0
+        0xF000,  // 202: LD I, 0456
+        0x0456,  // 204:
+        0x6001,  // 206: LD V0, 1
+    };
+
+    Chip8 xo;
+    RunProgram<quirks::XoChip>(xo, program, 1);
+    EXPECT_EQ(xo.pc, 0x206);
+
+    Chip8 legacy;
+    RunProgram<quirks::Legacy>(legacy, program, 1);
+    EXPECT_EQ(legacy.pc, 0x204);
+}
+
+TEST(XoChipTest, DrawsSelectedPlanesInOnePass)
+{
+    Chip8 chip8;
+    chip8.index = 0x300;
+    chip8.registers[0x1] = 4;
+    chip8.memory[0x300] = 0xF0;  // First plane
+    chip8.memory[0x301] = 0x0F;  // Second plane
+
+    chip8.planes = 0x3;
+    ops::OP_Dxyn(chip8, 0x1, 0x1, 1);
+    EXPECT_EQ(chip8.video[4], 0xF0ull << 52u);
+    EXPECT_EQ(chip8.video2[4], 0x0Full << 52u);
+    EXPECT_EQ(chip8.registers[0xF], 0);
+
+    // Only the second plane collides, and it reads the first sprite
+    chip8.planes = 0x2;
+    ops::OP_Dxyn(chip8, 0x1, 0x1, 1);
+    EXPECT_EQ(chip8.video[4], 0xF0ull << 52u);
+    EXPECT_EQ(chip8.video2[4], 0xFFull << 52u);
+    EXPECT_EQ(chip8.registers[0xF], 0);
+
+    ops::OP_Dxyn(chip8, 0x1, 0x1, 1);
+    EXPECT_EQ(chip8.registers[0xF], 1);
+
+    chip8.planes = 0x0;
+    ops::OP_Dxyn(chip8, 0x1, 0x1, 1);
+    EXPECT_EQ(chip8.registers[0xF], 0);
+
+    chip8.planes = 0x1;
+    ops::OP_00E0(chip8);
+    EXPECT_EQ(chip8.video, video_mem_t{});
+    EXPECT_EQ(chip8.video2[4], 0x0Full << 52u);
+}
+
+TEST(XoChipTest, ScrollsSelectedPlanes)
+{
+    Chip8 chip8;
+    chip8.hires = true;
+    chip8.hiresVideo[2 * 10] = 1;
+    chip8.hiresVideo2[2 * 10] = 1;
+    chip8.planes = 0x2;
+
+    ops::OP_00Dn(chip8, 3);
+
+    EXPECT_EQ(chip8.hiresVideo[2 * 10], 1u);
+    EXPECT_EQ(chip8.hiresVideo2[2 * 7], 1u);
+    EXPECT_EQ(chip8.hiresVideo2[2 * 10], 0u);
+}
+
+TEST(XoChipTest, CopiesRegisterRanges)
+{
+    Chip8 chip8;
+    chip8.index = 0x300;
+    chip8.registers = {0x0, 0x1, 0x2, 0x3, 0x4, 0x5};
+
+    ops::OP_5xy2(chip8, 0x1, 0x3);
+    EXPECT_EQ(chip8.memory[0x300], 0x1);
+    EXPECT_EQ(chip8.memory[0x302], 0x3);
+    EXPECT_EQ(chip8.memory[0x303], 0x0);
+
+    ops::OP_5xy2(chip8, 0x5, 0x4);
+    EXPECT_EQ(chip8.memory[0x300], 0x5);
+    EXPECT_EQ(chip8.memory[0x301], 0x4);
+    EXPECT_EQ(chip8.index, 0x300);
+
+    ops::OP_5xy3(chip8, 0x8, 0xA);
+    EXPECT_EQ(chip8.registers[0x8], 0x5);
+    EXPECT_EQ(chip8.registers[0x9], 0x4);
+    EXPECT_EQ(chip8.registers[0xA], 0x3);
+
+    ops::OP_5xy3(chip8, 0xD, 0xC);
+    EXPECT_EQ(chip8.registers[0xD], 0x5);
+    EXPECT_EQ(chip8.registers[0xC], 0x4);
+}
+
+TEST(XoChipTest, LoadsAudioPatternAndPitch)
+{
+    Chip8 chip8;
+    chip8.registers[0x4] = 112;
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        chip8.memory[0x300 + i] = static_cast<u8>(i * 17);
+    }
+
+    RunProgram<quirks::XoChip>(chip8,
+                               {
+                                   0xA300,  // 200: LD I, 300
+                                   0xF002,  // 202: AUDIO
+                                   0xF43A,  // 204: PITCH V4
+                               },
+                               3);
+
+    EXPECT_EQ(chip8.audioPattern[0], 0);
+    EXPECT_EQ(chip8.audioPattern[15], 255);
+    EXPECT_EQ(chip8.pitch, 112);
+}
+
+TEST(XoChipTest, RgbaFrameShowsBothPlanes)
+{
+    MachineState state{};
+    state.video[0] = PixelMask(0) | PixelMask(1);
+    state.video2[0] = PixelMask(1) | PixelMask(2);
+
+    RgbaFrame frame;
+    ASSERT_TRUE(frame.Update(state));
+    EXPECT_EQ(frame.Data()[0], PIXEL_ON);
+    EXPECT_EQ(frame.Data()[2], PIXEL_BOTH_PLANES);
+    EXPECT_EQ(frame.Data()[RgbaFrame::WIDTH + 5], PIXEL_SECOND_PLANE);
+    EXPECT_EQ(frame.Data()[6], PIXEL_OFF);
+
+    state.video2[0] = 0;
+    ASSERT_TRUE(frame.Update(state));
+    EXPECT_EQ(frame.Data()[2], PIXEL_ON);
+}